@@ -0,0 +1,218 @@
+/**
+ * @file aes.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in aes.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "aes.h"
+
+/* Words are big endian: the first byte of the column is the most significant */
+#define LOAD32(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define STORE32(p, v) ((p)[0] = (uint8_t)((v) >> 24), (p)[1] = (uint8_t)((v) >> 16), \
+                       (p)[2] = (uint8_t)((v) >> 8), (p)[3] = (uint8_t)(v))
+
+static uint8_t sbox[256];
+static uint8_t inv_sbox[256];
+static uint32_t te[4][256];
+static uint32_t td[4][256];
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+/* Product in GF(2^8) modulo x^8 + x^4 + x^3 + x + 1 */
+static uint8_t gf_mul(uint8_t a, uint8_t b) {
+    uint8_t p = 0;
+
+    while (b != 0) {
+        if (b & 1) {
+            p ^= a;
+        }
+        a = (uint8_t)((a << 1) ^ ((a & 0x80) ? 0x1B : 0));
+        b >>= 1;
+    }
+
+    return p;
+}
+
+/* Column of a mix column matrix applied to a byte: the T-table entry of the first byte of the column */
+static uint32_t mix_column(const char matrix[BYTES_PER_WORD][BYTES_PER_WORD][HEX_STRING_SIZE], uint8_t x) {
+    uint32_t w = 0;
+
+    for (int i = 0; i < BYTES_PER_WORD; i++) {
+        w = (w << 8) | gf_mul((uint8_t)strtol(matrix[i][0], NULL, 16), x);
+    }
+
+    return w;
+}
+
+static void aes_build_tables() {
+    uint32_t w;
+
+    for (int i = 0; i < 256; i++) {
+        sbox[i] = (uint8_t)strtol(DIRECT_SBOX[i >> 4][i & 0xF], NULL, 16);
+        inv_sbox[i] = (uint8_t)strtol(INVERSE_SBOX[i >> 4][i & 0xF], NULL, 16);
+    }
+
+    /* te[k] and td[k] are te[0] and td[0] for the byte k of the column: rotations of 8k bits */
+    for (int i = 0; i < 256; i++) {
+        w = mix_column(MIX_COLUMN_MATRIX, sbox[i]);
+        for (int k = 0; k < 4; k++) {
+            te[k][i] = k == 0 ? w : (w >> (8 * k)) | (w << (32 - 8 * k));
+        }
+        w = mix_column(INV_MIX_COLUMN_MATRIX, inv_sbox[i]);
+        for (int k = 0; k < 4; k++) {
+            td[k][i] = k == 0 ? w : (w >> (8 * k)) | (w << (32 - 8 * k));
+        }
+    }
+}
+
+void aes_init() {
+    pthread_once(&tables_once, aes_build_tables);
+}
+
+static uint32_t sub_word(uint32_t w) {
+    return ((uint32_t)sbox[w >> 24] << 24) | ((uint32_t)sbox[(w >> 16) & 0xFF] << 16)
+         | ((uint32_t)sbox[(w >> 8) & 0xFF] << 8) | sbox[w & 0xFF];
+}
+
+/* InvMixColumns of a word: td applies InvSubBytes first, so the bytes go through sbox before */
+static uint32_t inv_mix_word(uint32_t w) {
+    return td[0][sbox[w >> 24]] ^ td[1][sbox[(w >> 16) & 0xFF]]
+         ^ td[2][sbox[(w >> 8) & 0xFF]] ^ td[3][sbox[w & 0xFF]];
+}
+
+int aes_set_key(aes_key *ks, const uint8_t *key, int key_bits) {
+    int nk, total, i;
+    uint32_t temp, rcon = 0x01;
+
+    if (key_bits != 128 && key_bits != 192 && key_bits != 256) {
+        return -1;
+    }
+
+    aes_init();
+
+    nk = key_bits / 32;
+    ks->rounds = nk + 6;
+    total = 4 * (ks->rounds + 1);
+
+    for (i = 0; i < nk; i++) {
+        ks->enc[i] = LOAD32(key + 4 * i);
+    }
+
+    for (; i < total; i++) {
+        temp = ks->enc[i - 1];
+        if (i % nk == 0) {
+            temp = sub_word((temp << 8) | (temp >> 24)) ^ (rcon << 24);
+            rcon = gf_mul((uint8_t)rcon, 0x02);
+        } else if (nk > 6 && i % nk == 4) {
+            temp = sub_word(temp);
+        }
+        ks->enc[i] = ks->enc[i - nk] ^ temp;
+    }
+
+    /* Equivalent inverse cipher: round keys in reverse order, the inner ones through InvMixColumns */
+    for (int r = 0; r <= ks->rounds; r++) {
+        for (int j = 0; j < 4; j++) {
+            temp = ks->enc[4 * (ks->rounds - r) + j];
+            ks->dec[4 * r + j] = (r == 0 || r == ks->rounds) ? temp : inv_mix_word(temp);
+        }
+    }
+
+    return 0;
+}
+
+void aes_encrypt_block(const aes_key *ks, uint8_t out[AES_BLOCK_SIZE], const uint8_t in[AES_BLOCK_SIZE]) {
+    const uint32_t *rk = ks->enc;
+    uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+
+    s0 = LOAD32(in) ^ rk[0];
+    s1 = LOAD32(in + 4) ^ rk[1];
+    s2 = LOAD32(in + 8) ^ rk[2];
+    s3 = LOAD32(in + 12) ^ rk[3];
+
+    for (int r = 1; r < ks->rounds; r++) {
+        rk += 4;
+        t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xFF] ^ te[2][(s2 >> 8) & 0xFF] ^ te[3][s3 & 0xFF] ^ rk[0];
+        t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xFF] ^ te[2][(s3 >> 8) & 0xFF] ^ te[3][s0 & 0xFF] ^ rk[1];
+        t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xFF] ^ te[2][(s0 >> 8) & 0xFF] ^ te[3][s1 & 0xFF] ^ rk[2];
+        t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xFF] ^ te[2][(s1 >> 8) & 0xFF] ^ te[3][s2 & 0xFF] ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    /* Last round without MixColumns */
+    rk += 4;
+    t0 = ((uint32_t)sbox[s0 >> 24] << 24) ^ ((uint32_t)sbox[(s1 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)sbox[(s2 >> 8) & 0xFF] << 8) ^ sbox[s3 & 0xFF] ^ rk[0];
+    t1 = ((uint32_t)sbox[s1 >> 24] << 24) ^ ((uint32_t)sbox[(s2 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)sbox[(s3 >> 8) & 0xFF] << 8) ^ sbox[s0 & 0xFF] ^ rk[1];
+    t2 = ((uint32_t)sbox[s2 >> 24] << 24) ^ ((uint32_t)sbox[(s3 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)sbox[(s0 >> 8) & 0xFF] << 8) ^ sbox[s1 & 0xFF] ^ rk[2];
+    t3 = ((uint32_t)sbox[s3 >> 24] << 24) ^ ((uint32_t)sbox[(s0 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)sbox[(s1 >> 8) & 0xFF] << 8) ^ sbox[s2 & 0xFF] ^ rk[3];
+
+    STORE32(out, t0);
+    STORE32(out + 4, t1);
+    STORE32(out + 8, t2);
+    STORE32(out + 12, t3);
+}
+
+void aes_decrypt_block(const aes_key *ks, uint8_t out[AES_BLOCK_SIZE], const uint8_t in[AES_BLOCK_SIZE]) {
+    const uint32_t *rk = ks->dec;
+    uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+
+    s0 = LOAD32(in) ^ rk[0];
+    s1 = LOAD32(in + 4) ^ rk[1];
+    s2 = LOAD32(in + 8) ^ rk[2];
+    s3 = LOAD32(in + 12) ^ rk[3];
+
+    for (int r = 1; r < ks->rounds; r++) {
+        rk += 4;
+        t0 = td[0][s0 >> 24] ^ td[1][(s3 >> 16) & 0xFF] ^ td[2][(s2 >> 8) & 0xFF] ^ td[3][s1 & 0xFF] ^ rk[0];
+        t1 = td[0][s1 >> 24] ^ td[1][(s0 >> 16) & 0xFF] ^ td[2][(s3 >> 8) & 0xFF] ^ td[3][s2 & 0xFF] ^ rk[1];
+        t2 = td[0][s2 >> 24] ^ td[1][(s1 >> 16) & 0xFF] ^ td[2][(s0 >> 8) & 0xFF] ^ td[3][s3 & 0xFF] ^ rk[2];
+        t3 = td[0][s3 >> 24] ^ td[1][(s2 >> 16) & 0xFF] ^ td[2][(s1 >> 8) & 0xFF] ^ td[3][s0 & 0xFF] ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+
+    /* Last round without InvMixColumns */
+    rk += 4;
+    t0 = ((uint32_t)inv_sbox[s0 >> 24] << 24) ^ ((uint32_t)inv_sbox[(s3 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)inv_sbox[(s2 >> 8) & 0xFF] << 8) ^ inv_sbox[s1 & 0xFF] ^ rk[0];
+    t1 = ((uint32_t)inv_sbox[s1 >> 24] << 24) ^ ((uint32_t)inv_sbox[(s0 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)inv_sbox[(s3 >> 8) & 0xFF] << 8) ^ inv_sbox[s2 & 0xFF] ^ rk[1];
+    t2 = ((uint32_t)inv_sbox[s2 >> 24] << 24) ^ ((uint32_t)inv_sbox[(s1 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)inv_sbox[(s0 >> 8) & 0xFF] << 8) ^ inv_sbox[s3 & 0xFF] ^ rk[2];
+    t3 = ((uint32_t)inv_sbox[s3 >> 24] << 24) ^ ((uint32_t)inv_sbox[(s2 >> 16) & 0xFF] << 16)
+       ^ ((uint32_t)inv_sbox[(s1 >> 8) & 0xFF] << 8) ^ inv_sbox[s0 & 0xFF] ^ rk[3];
+
+    STORE32(out, t0);
+    STORE32(out + 4, t1);
+    STORE32(out + 8, t2);
+    STORE32(out + 12, t3);
+}
+
+int aes_ecb(const aes_key *ks, uint8_t *out, const uint8_t *in, size_t len, int mode) {
+    if (len % AES_BLOCK_SIZE != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < len; i += AES_BLOCK_SIZE) {
+        if (mode == CYPHER) {
+            aes_encrypt_block(ks, out + i, in + i);
+        } else {
+            aes_decrypt_block(ks, out + i, in + i);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file aes.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief AES-128/192/256 on 32 bit words with T-tables. The byte S boxes and the tables Te0-Te3 (SubBytes and
+ *        MixColumns) and Td0-Td3 (InvSubBytes and InvMixColumns) are derived once from DIRECT_SBOX,
+ *        INVERSE_SBOX, MIX_COLUMN_MATRIX and INV_MIX_COLUMN_MATRIX of utils.h, so a round is 16 lookups and
+ *        xors. Decryption uses the equivalent inverse cipher (round keys through InvMixColumns)
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef AES_H
+#define AES_H
+
+#include "../utiles/utils.h"
+
+/* Bytes of an AES block */
+#define AES_BLOCK_SIZE 16
+/* Rounds of AES-256, the largest key */
+#define AES_MAX_ROUNDS 14
+
+/**
+ * @brief Round keys of a key, for encryption and for the equivalent inverse cipher
+ */
+typedef struct {
+    uint32_t enc[4 * (AES_MAX_ROUNDS + 1)];
+    uint32_t dec[4 * (AES_MAX_ROUNDS + 1)];
+    int rounds;
+} aes_key;
+
+/**
+ * @brief Builds the S boxes and T-tables (only the first call does something). aes_set_key calls it
+ */
+void aes_init();
+
+/**
+ * @brief Expands a key
+ *
+ * @param ks (return) round keys
+ * @param key key of key_bits bits
+ * @param key_bits 128, 192 or 256
+ *
+ * @return int 0 if the key was expanded, -1 if key_bits is not valid
+ */
+int aes_set_key(aes_key *ks, const uint8_t *key, int key_bits);
+
+/**
+ * @brief Encrypts one block
+ *
+ * @param ks round keys
+ * @param out (return) encrypted block (may be the same as in)
+ * @param in block to encrypt
+ */
+void aes_encrypt_block(const aes_key *ks, uint8_t out[AES_BLOCK_SIZE], const uint8_t in[AES_BLOCK_SIZE]);
+
+/**
+ * @brief Decrypts one block
+ *
+ * @param ks round keys
+ * @param out (return) decrypted block (may be the same as in)
+ * @param in block to decrypt
+ */
+void aes_decrypt_block(const aes_key *ks, uint8_t out[AES_BLOCK_SIZE], const uint8_t in[AES_BLOCK_SIZE]);
+
+/**
+ * @brief Encrypts or decrypts a buffer in ECB mode
+ *
+ * @param ks round keys
+ * @param out (return) output buffer of len bytes (may be the same as in)
+ * @param in input buffer
+ * @param len length of the buffer, multiple of AES_BLOCK_SIZE
+ * @param mode CYPHER or DECYPHER
+ *
+ * @return int 0 if the buffer was processed, -1 if len is not a multiple of AES_BLOCK_SIZE
+ */
+int aes_ecb(const aes_key *ks, uint8_t *out, const uint8_t *in, size_t len, int mode);
+
+#endif
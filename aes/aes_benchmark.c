@@ -0,0 +1,191 @@
+/**
+ * @file aes_benchmark.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Checks the AES engine with the test vectors of FIPS-197 (appendix C) for the three key sizes and
+ *        measures its throughput in MB/s encrypting and decrypting a buffer in ECB mode
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "aes.h"
+#include "../utiles/prng.h"
+
+#define DEFAULT_MEGABYTES 16
+#define CHECK_BLOCKS 1000
+#define BENCHMARK_SEED 12345
+#define NUM_KEY_SIZES 3
+
+static const int KEY_SIZES[NUM_KEY_SIZES] = {128, 192, 256};
+
+/* FIPS-197 appendix C: key 000102..., plaintext 00112233445566778899aabbccddeeff */
+static const uint8_t TEST_PLAINTEXT[AES_BLOCK_SIZE] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+static const uint8_t TEST_CIPHERTEXT[NUM_KEY_SIZES][AES_BLOCK_SIZE] = {
+    {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a},
+    {0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91},
+    {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89}};
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param megabytes size of the buffer of the benchmark
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], int *megabytes, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+/**
+ * @brief Checks the engine with the test vectors and decrypts random blocks encrypted with random keys
+ *
+ * @return int number of errors
+ */
+int check_engine();
+
+int main(int argc, char *argv[]) {
+
+    int megabytes = DEFAULT_MEGABYTES, errors;
+    char *file_out = NULL;
+    uint8_t *in, *out, key[32];
+    size_t len;
+    aes_key ks;
+    double start, t_encrypt, t_decrypt;
+
+    if (check_args(argc, argv, &megabytes, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if (file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    errors = check_engine();
+    if (errors > 0) {
+        printf("Error: %d wrong results\n", errors);
+        return -1;
+    }
+    printf("Test vectors and %d random blocks: OK\n", CHECK_BLOCKS);
+
+    len = (size_t)megabytes * 1024 * 1024;
+    in = (uint8_t *)malloc(len);
+    out = (uint8_t *)malloc(len);
+    if (in == NULL || out == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    prng_seed(BENCHMARK_SEED);
+    prng_fill(in, len);
+    for (int i = 0; i < 32; i++) {
+        key[i] = (uint8_t)i;
+    }
+
+    printf("Key Bytes Encrypt(s) Encrypt(MB/s) Decrypt(s) Decrypt(MB/s)\n");
+    for (int k = 0; k < NUM_KEY_SIZES; k++) {
+        aes_set_key(&ks, key, KEY_SIZES[k]);
+
+        start = get_wall_time();
+        aes_ecb(&ks, out, in, len, CYPHER);
+        t_encrypt = get_wall_time() - start;
+
+        start = get_wall_time();
+        aes_ecb(&ks, out, out, len, DECYPHER);
+        t_decrypt = get_wall_time() - start;
+
+        if (memcmp(in, out, len) != 0) {
+            printf("Error: AES-%d does not decrypt the buffer\n", KEY_SIZES[k]);
+            errors++;
+        }
+
+        printf("AES-%d %zu %lf %lf %lf %lf\n", KEY_SIZES[k], len, t_encrypt, len / t_encrypt / (1024 * 1024),
+               t_decrypt, len / t_decrypt / (1024 * 1024));
+    }
+
+    free(in);
+    free(out);
+
+    return errors > 0 ? -1 : 0;
+}
+
+int check_engine() {
+    uint8_t key[32], block[AES_BLOCK_SIZE], plain[AES_BLOCK_SIZE];
+    aes_key ks;
+    int errors = 0;
+
+    for (int i = 0; i < 32; i++) {
+        key[i] = (uint8_t)i;
+    }
+
+    for (int k = 0; k < NUM_KEY_SIZES; k++) {
+        aes_set_key(&ks, key, KEY_SIZES[k]);
+
+        aes_encrypt_block(&ks, block, TEST_PLAINTEXT);
+        if (memcmp(block, TEST_CIPHERTEXT[k], AES_BLOCK_SIZE) != 0) {
+            printf("AES-%d: wrong test vector (encryption)\n", KEY_SIZES[k]);
+            errors++;
+        }
+
+        aes_decrypt_block(&ks, block, TEST_CIPHERTEXT[k]);
+        if (memcmp(block, TEST_PLAINTEXT, AES_BLOCK_SIZE) != 0) {
+            printf("AES-%d: wrong test vector (decryption)\n", KEY_SIZES[k]);
+            errors++;
+        }
+    }
+
+    /* Random keys and blocks, both ways */
+    prng_seed(BENCHMARK_SEED);
+    for (int n = 0; n < CHECK_BLOCKS; n++) {
+        prng_fill(key, 32);
+        prng_fill(plain, AES_BLOCK_SIZE);
+
+        aes_set_key(&ks, key, KEY_SIZES[n % NUM_KEY_SIZES]);
+        aes_encrypt_block(&ks, block, plain);
+        aes_decrypt_block(&ks, block, block);
+        if (memcmp(block, plain, AES_BLOCK_SIZE) != 0) {
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+int check_args(int argc, char *argv[], int *megabytes, char **file_out) {
+    if (argc % 2 != 1 || argc > 5) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-m") == 0) {
+            *megabytes = atoi(argv[i+1]);
+            if (*megabytes <= 0) {
+                printf("Megabytes must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./aes_benchmark [-m <megabytes>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -m <megabytes>     Size of the buffer (default %d)\n", DEFAULT_MEGABYTES);
+    printf("  -o <output_file>   Output file\n");
+}
@@ -0,0 +1,315 @@
+/**
+ * @file avalanche.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in avalanche.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "avalanche.h"
+#include "../utiles/prng.h"
+
+#define BLOCK_WORDS (AVALANCHE_MAX_BLOCK_BITS / 64)
+
+/* Expanded key of any of the ciphers */
+typedef union {
+    aes_key aes;
+    des_table_key des;
+} avalanche_key;
+
+/* Cipher under analysis */
+typedef struct {
+    const char *name;
+    int block_bytes;
+    int key_bytes;
+} avalanche_cipher;
+
+static const avalanche_cipher CIPHERS[] = {
+    {"aes128", AES_BLOCK_SIZE, 16},
+    {"aes192", AES_BLOCK_SIZE, 24},
+    {"aes256", AES_BLOCK_SIZE, 32},
+    {"des", DES_BLOCK_SIZE, DES_BLOCK_SIZE},
+};
+
+/* Work and counters of one thread */
+typedef struct {
+    const avalanche_cipher *cipher;
+    int mode;
+    int index;              /* Index of the worker, and of its stream of prng */
+    long long samples;
+    long long *distance;
+    long long *sac;
+} avalanche_worker;
+
+static void cipher_set_key(const avalanche_cipher *cipher, avalanche_key *ks, const uint8_t *key) {
+    if (cipher->block_bytes == AES_BLOCK_SIZE) {
+        aes_set_key(&ks->aes, key, 8 * cipher->key_bytes);
+    } else {
+        des_table_set_key(&ks->des, des_load_block(key));
+    }
+}
+
+static void cipher_ecb(const avalanche_cipher *cipher, const avalanche_key *ks, uint8_t *out, const uint8_t *in,
+                       size_t len) {
+    if (cipher->block_bytes == AES_BLOCK_SIZE) {
+        aes_ecb(&ks->aes, out, in, len, CYPHER);
+    } else {
+        des_table_ecb(&ks->des, out, in, len, CYPHER);
+    }
+}
+
+/* Compares the outputs of a batch before and after flipping the bit i and adds the result to the counters */
+static void worker_compare(avalanche_worker *w, const uint64_t *base, const uint64_t *flipped, int n, int i,
+                           int *counts, int *equal) {
+    int bits = 8 * w->cipher->block_bytes;
+
+    bit_comparator_counter_batch(base, flipped, (size_t)n, bits, counts);
+    for (int s = 0; s < n; s++) {
+        w->distance[bits - counts[s]]++;
+    }
+
+    memset(equal, 0, bits * sizeof(int));
+    bit_comparator_position_batch(base, flipped, (size_t)n, bits, equal);
+    for (int j = 0; j < bits; j++) {
+        w->sac[(size_t)i * bits + j] += n - equal[j];
+    }
+}
+
+static void *avalanche_thread(void *arg) {
+    avalanche_worker *w = (avalanche_worker *)arg;
+    const avalanche_cipher *cipher = w->cipher;
+    uint64_t plain[AVALANCHE_BATCH * BLOCK_WORDS], input[AVALANCHE_BATCH * BLOCK_WORDS];
+    uint64_t base[AVALANCHE_BATCH * BLOCK_WORDS], output[AVALANCHE_BATCH * BLOCK_WORDS];
+    uint8_t key[AVALANCHE_MAX_KEY_BITS / 8];
+    int counts[AVALANCHE_BATCH], equal[AVALANCHE_MAX_BLOCK_BITS], n, bytes = cipher->block_bytes, flipped_bits;
+    avalanche_key ks, flipped_ks;
+    size_t len;
+
+    flipped_bits = w->mode == AVALANCHE_INPUT ? 8 * cipher->block_bytes : 8 * cipher->key_bytes;
+
+    /* The stream depends on the worker and not on which thread starts first, so a seeded run is reproducible */
+    prng_seed_stream((uint64_t)w->index);
+
+    for (long long done = 0; done < w->samples; done += n) {
+        n = w->samples - done < AVALANCHE_BATCH ? (int)(w->samples - done) : AVALANCHE_BATCH;
+        len = (size_t)n * bytes;
+
+        prng_fill(key, cipher->key_bytes);
+        cipher_set_key(cipher, &ks, key);
+        prng_fill(plain, len);
+        cipher_ecb(cipher, &ks, (uint8_t *)base, (const uint8_t *)plain, len);
+
+        for (int i = 0; i < flipped_bits; i++) {
+            if (w->mode == AVALANCHE_INPUT) {
+                memcpy(input, plain, len);
+                for (int s = 0; s < n; s++) {
+                    ((uint8_t *)input)[s * bytes + i / 8] ^= (uint8_t)(1 << (i % 8));
+                }
+                cipher_ecb(cipher, &ks, (uint8_t *)output, (const uint8_t *)input, len);
+            } else {
+                key[i / 8] ^= (uint8_t)(1 << (i % 8));
+                cipher_set_key(cipher, &flipped_ks, key);
+                key[i / 8] ^= (uint8_t)(1 << (i % 8));
+                cipher_ecb(cipher, &flipped_ks, (uint8_t *)output, (const uint8_t *)plain, len);
+            }
+
+            worker_compare(w, base, output, n, i, counts, equal);
+        }
+    }
+
+    return NULL;
+}
+
+int avalanche_run(const char *cipher, int mode, long long samples, int threads, avalanche_result *result) {
+    const avalanche_cipher *c = NULL;
+    avalanche_worker *workers;
+    pthread_t *ids;
+    size_t sac_size;
+    double start;
+    int created = 0, error = 0;
+
+    result->distance = NULL;
+    result->sac = NULL;
+
+    for (size_t i = 0; i < sizeof(CIPHERS) / sizeof(CIPHERS[0]); i++) {
+        if (strcmp(CIPHERS[i].name, cipher) == 0) {
+            c = &CIPHERS[i];
+        }
+    }
+    if (c == NULL || samples <= 0 || (mode != AVALANCHE_INPUT && mode != AVALANCHE_KEY)) {
+        return -1;
+    }
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > samples) {
+        threads = (int)samples;
+    }
+
+    result->block_bits = 8 * c->block_bytes;
+    result->flipped_bits = mode == AVALANCHE_INPUT ? 8 * c->block_bytes : 8 * c->key_bytes;
+    result->samples = samples;
+    sac_size = (size_t)result->flipped_bits * result->block_bits;
+
+    /* Each thread has its own counters, they are added at the end */
+    result->distance = (long long *)calloc((size_t)(threads + 1) * (result->block_bits + 1), sizeof(long long));
+    result->sac = (long long *)calloc((threads + 1) * sac_size, sizeof(long long));
+    workers = (avalanche_worker *)malloc(threads * sizeof(avalanche_worker));
+    ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    if (result->distance == NULL || result->sac == NULL || workers == NULL || ids == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        avalanche_result_free(result);
+        free(workers);
+        free(ids);
+        return -1;
+    }
+
+    start = get_wall_time();
+
+    for (int t = 0; t < threads; t++) {
+        workers[t].cipher = c;
+        workers[t].mode = mode;
+        workers[t].index = t;
+        workers[t].samples = samples / threads + (t < samples % threads ? 1 : 0);
+        workers[t].distance = result->distance + (size_t)(t + 1) * (result->block_bits + 1);
+        workers[t].sac = result->sac + (t + 1) * sac_size;
+    }
+
+    /* The calling thread does the work of the first worker */
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&ids[t], NULL, avalanche_thread, &workers[t]) != 0) {
+            printf("Error creating the threads\n");
+            error = 1;
+            break;
+        }
+        created++;
+    }
+    if (!error) {
+        avalanche_thread(&workers[0]);
+    }
+    for (int t = 1; t <= created; t++) {
+        pthread_join(ids[t], NULL);
+    }
+
+    for (int t = 0; t < threads; t++) {
+        for (int d = 0; d <= result->block_bits; d++) {
+            result->distance[d] += workers[t].distance[d];
+        }
+        for (size_t k = 0; k < sac_size; k++) {
+            result->sac[k] += workers[t].sac[k];
+        }
+    }
+
+    result->time = get_wall_time() - start;
+
+    free(workers);
+    free(ids);
+
+    if (error) {
+        avalanche_result_free(result);
+        return -1;
+    }
+
+    return 0;
+}
+
+void avalanche_result_free(avalanche_result *result) {
+    free(result->distance);
+    free(result->sac);
+    result->distance = NULL;
+    result->sac = NULL;
+}
+
+void avalanche_summary(const avalanche_result *result, double *mean, double *sac_mean, double *sac_max) {
+    long long flips = result->samples * result->flipped_bits;
+    double changed = 0, deviation;
+
+    for (int d = 0; d <= result->block_bits; d++) {
+        changed += (double)d * result->distance[d];
+    }
+    *mean = changed / flips;
+
+    *sac_mean = 0;
+    *sac_max = 0;
+    for (int k = 0; k < result->flipped_bits * result->block_bits; k++) {
+        deviation = fabs((double)result->sac[k] / result->samples - 0.5);
+        *sac_mean += deviation;
+        if (deviation > *sac_max) {
+            *sac_max = deviation;
+        }
+    }
+    *sac_mean /= result->flipped_bits * result->block_bits;
+}
+
+int avalanche_write_gnuplot(const avalanche_result *result, const char *prefix) {
+    char name[1024];
+    long long flips = result->samples * result->flipped_bits, changes;
+    FILE *f;
+
+    snprintf(name, sizeof(name), "%s_distance.txt", prefix);
+    if ((f = fopen(name, "w")) == NULL) {
+        printf("Error opening %s\n", name);
+        return -1;
+    }
+    for (int d = 0; d <= result->block_bits; d++) {
+        fprintf(f, "%d %lf\n", d, (double)result->distance[d] / flips);
+    }
+    fclose(f);
+
+    snprintf(name, sizeof(name), "%s_positions.txt", prefix);
+    if ((f = fopen(name, "w")) == NULL) {
+        printf("Error opening %s\n", name);
+        return -1;
+    }
+    for (int j = 0; j < result->block_bits; j++) {
+        changes = 0;
+        for (int i = 0; i < result->flipped_bits; i++) {
+            changes += result->sac[(size_t)i * result->block_bits + j];
+        }
+        fprintf(f, "%d %lf\n", j, (double)changes / flips);
+    }
+    fclose(f);
+
+    snprintf(name, sizeof(name), "%s_sac.txt", prefix);
+    if ((f = fopen(name, "w")) == NULL) {
+        printf("Error opening %s\n", name);
+        return -1;
+    }
+    for (int i = 0; i < result->flipped_bits; i++) {
+        for (int j = 0; j < result->block_bits; j++) {
+            fprintf(f, "%lf%c", (double)result->sac[(size_t)i * result->block_bits + j] / result->samples,
+                    j == result->block_bits - 1 ? '\n' : ' ');
+        }
+    }
+    fclose(f);
+
+    snprintf(name, sizeof(name), "%s.gp", prefix);
+    if ((f = fopen(name, "w")) == NULL) {
+        printf("Error opening %s\n", name);
+        return -1;
+    }
+    fprintf(f, "set terminal png size 1200,900\n");
+    fprintf(f, "set output '%s.png'\n", prefix);
+    fprintf(f, "set multiplot layout 2,2\n");
+    fprintf(f, "set title 'Output bits changed by one flip'\n");
+    fprintf(f, "set style fill solid\n");
+    fprintf(f, "plot '%s_distance.txt' using 1:2 with boxes notitle\n", prefix);
+    fprintf(f, "set title 'Probability of change of each output bit'\n");
+    fprintf(f, "set yrange [0:1]\n");
+    fprintf(f, "plot '%s_positions.txt' using 1:2 with boxes notitle, 0.5 notitle\n", prefix);
+    fprintf(f, "set title 'SAC matrix (flipped bit, output bit)'\n");
+    fprintf(f, "set autoscale\n");
+    fprintf(f, "set cbrange [0:1]\n");
+    fprintf(f, "plot '%s_sac.txt' matrix with image notitle\n", prefix);
+    fprintf(f, "unset multiplot\n");
+    fclose(f);
+
+    return 0;
+}
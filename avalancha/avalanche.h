@@ -0,0 +1,86 @@
+/**
+ * @file avalanche.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Avalanche and strict avalanche criterion (SAC) analysis of the block ciphers of the project. For
+ *        random keys and blocks every bit of the block (or of the key) is flipped, and the outputs before and
+ *        after the flip are compared with the batch comparators of utils.h. The samples are split between
+ *        threads, each one with its own random stream (prng.h, chosen by the index of the thread, so a seeded
+ *        run gives the same results with the same number of threads) and its own counters
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef AVALANCHE_H
+#define AVALANCHE_H
+
+#include "../utiles/utils.h"
+#include "../aes/aes.h"
+#include "../des/des_table.h"
+
+#define AVALANCHE_MAX_BLOCK_BITS 128
+#define AVALANCHE_MAX_KEY_BITS 256
+/* Samples that share a random key and go through the cipher in one call */
+#define AVALANCHE_BATCH 256
+
+/* Bits that are flipped */
+#define AVALANCHE_INPUT 0
+#define AVALANCHE_KEY 1
+
+/**
+ * @brief Result of an analysis. Bit i of a block or key is the bit i % 8 of its byte i / 8
+ */
+typedef struct {
+    int block_bits;         /* Bits of the block of the cipher */
+    int flipped_bits;       /* Bits that are flipped: block_bits or the bits of the key */
+    long long samples;      /* Random (key, block) samples, each one flips every bit once */
+    long long *distance;    /* distance[d]: flips that changed d bits of the output, block_bits + 1 entries */
+    long long *sac;         /* sac[i * block_bits + j]: flips of the bit i that changed the output bit j */
+    double time;            /* Wall time of the analysis */
+} avalanche_result;
+
+/**
+ * @brief Runs the analysis. Every sample costs flipped_bits + 1 encryptions
+ *
+ * @param cipher aes128, aes192, aes256 or des
+ * @param mode AVALANCHE_INPUT to flip the bits of the block, AVALANCHE_KEY to flip the bits of the key
+ * @param samples number of samples, greater than 0
+ * @param threads number of threads (0 for one per online core)
+ * @param result (return) result, freed with avalanche_result_free
+ * @return int 0 if the analysis was done, -1 if the cipher is unknown or there was an error
+ */
+int avalanche_run(const char *cipher, int mode, long long samples, int threads, avalanche_result *result);
+
+/**
+ * @brief Frees the counters of a result
+ *
+ * @param result result
+ */
+void avalanche_result_free(avalanche_result *result);
+
+/**
+ * @brief Summary of a result: mean Hamming distance of the outputs, and the mean and largest distance from
+ *        1/2 of the probabilities of the SAC matrix
+ *
+ * @param result result
+ * @param mean (return) mean number of output bits changed by a flip
+ * @param sac_mean (return) mean of |P(bit j changes | bit i flipped) - 1/2|
+ * @param sac_max (return) largest |P(bit j changes | bit i flipped) - 1/2|
+ */
+void avalanche_summary(const avalanche_result *result, double *mean, double *sac_mean, double *sac_max);
+
+/**
+ * @brief Writes the result as data for gnuplot: <prefix>_distance.txt (distance and frequency),
+ *        <prefix>_positions.txt (output bit and probability of change), <prefix>_sac.txt (matrix of
+ *        probabilities, one row per flipped bit) and the script <prefix>.gp, which draws <prefix>.png and can
+ *        be run with generate_histogram_with_gnuplot
+ *
+ * @param result result
+ * @param prefix prefix of the files
+ * @return int 0 if the files were written, -1 otherwise
+ */
+int avalanche_write_gnuplot(const avalanche_result *result, const char *prefix);
+
+#endif
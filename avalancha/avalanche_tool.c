@@ -0,0 +1,165 @@
+/**
+ * @file avalanche_tool.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Measures the avalanche effect and the strict avalanche criterion of AES or DES, flipping every bit of
+ *        the block or of the key over random samples in several threads. The histograms can be written as
+ *        data for gnuplot and drawn with generate_histogram_with_gnuplot
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "avalanche.h"
+#include "../utiles/prng.h"
+
+#define DEFAULT_SAMPLES 100000
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param cipher_name name of the cipher
+ * @param mode AVALANCHE_INPUT or AVALANCHE_KEY
+ * @param samples number of samples
+ * @param threads number of threads
+ * @param seed seed of the samples (0 to take it from the system)
+ * @param prefix prefix of the gnuplot files
+ * @param draw 1 if gnuplot has to be run
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], char **cipher_name, int *mode, long long *samples, int *threads,
+               uint64_t *seed, char **prefix, int *draw, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+int main(int argc, char *argv[]) {
+
+    char *cipher_name = NULL, *prefix = NULL, *file_out = NULL, script[1024];
+    int mode = AVALANCHE_INPUT, threads = 0, draw = 0;
+    long long samples = DEFAULT_SAMPLES, encryptions;
+    uint64_t seed = 0;
+    avalanche_result result;
+    double mean, sac_mean, sac_max;
+
+    if (check_args(argc, argv, &cipher_name, &mode, &samples, &threads, &seed, &prefix, &draw, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if (file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    if (seed != 0) {
+        prng_seed(seed);
+    }
+
+    if (avalanche_run(cipher_name, mode, samples, threads, &result) == -1) {
+        printf("Error in the analysis of %s\n", cipher_name);
+        print_help();
+        return -1;
+    }
+
+    avalanche_summary(&result, &mean, &sac_mean, &sac_max);
+    encryptions = result.samples * (result.flipped_bits + 1);
+
+    printf("Cipher: %s, flipped bits of the %s\n", cipher_name, mode == AVALANCHE_INPUT ? "block" : "key");
+    printf("Samples: %lld, encryptions: %lld, time: %lf s (%lf encryptions/s)\n", result.samples, encryptions,
+           result.time, encryptions / result.time);
+    printf("Mean output bits changed: %lf of %d (%lf)\n", mean, result.block_bits, mean / result.block_bits);
+    printf("SAC |P - 1/2|: mean %lf, max %lf\n", sac_mean, sac_max);
+
+    printf("Distance Frequency\n");
+    for (int d = 0; d <= result.block_bits; d++) {
+        if (result.distance[d] > 0) {
+            printf("%d %lf\n", d, (double)result.distance[d] / (result.samples * result.flipped_bits));
+        }
+    }
+
+    if (prefix != NULL) {
+        if (avalanche_write_gnuplot(&result, prefix) == -1) {
+            avalanche_result_free(&result);
+            return -1;
+        }
+        if (draw) {
+            snprintf(script, sizeof(script), "%s.gp", prefix);
+            generate_histogram_with_gnuplot(script);
+        }
+    }
+
+    avalanche_result_free(&result);
+
+    return 0;
+}
+
+int check_args(int argc, char *argv[], char **cipher_name, int *mode, long long *samples, int *threads,
+               uint64_t *seed, char **prefix, int *draw, char **file_out) {
+    if (argc % 2 != 1) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-c") == 0) {
+            *cipher_name = argv[i+1];
+        } else if (strcmp(argv[i], "-m") == 0) {
+            if (strcmp(argv[i+1], "input") == 0) {
+                *mode = AVALANCHE_INPUT;
+            } else if (strcmp(argv[i+1], "key") == 0) {
+                *mode = AVALANCHE_KEY;
+            } else {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-n") == 0) {
+            *samples = atoll(argv[i+1]);
+            if (*samples <= 0) {
+                printf("Samples must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-t") == 0) {
+            *threads = atoi(argv[i+1]);
+            if (*threads < 0) {
+                printf("Threads must be 0 or greater\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-s") == 0) {
+            *seed = strtoull(argv[i+1], NULL, 10);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            *prefix = argv[i+1];
+        } else if (strcmp(argv[i], "-g") == 0) {
+            *prefix = argv[i+1];
+            *draw = 1;
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    if (*cipher_name == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./avalanche -c <cipher> [-m input|key] [-n <samples>] [-t <threads>] [-s <seed>] [-d|-g <prefix>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -c <cipher>        aes128, aes192, aes256 or des\n");
+    printf("  -m input|key       Flip the bits of the block or of the key (default input)\n");
+    printf("  -n <samples>       Random samples, each one costs one encryption per bit flipped plus one (default %d)\n", DEFAULT_SAMPLES);
+    printf("  -t <threads>       Number of threads (default 0, one per online core)\n");
+    printf("  -s <seed>          Seed of the samples, the same seed and threads give the same results (default taken from the system)\n");
+    printf("  -d <prefix>        Write the data and the gnuplot script to <prefix>_*.txt and <prefix>.gp\n");
+    printf("  -g <prefix>        Like -d, and draw <prefix>.png with gnuplot\n");
+    printf("  -o <output_file>   Output file\n");
+}
@@ -0,0 +1,356 @@
+/**
+ * @file benchmark.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Benchmark suite that runs the exponentiation, primality, prime generation, gcd/inverse and Vegas
+ *        kernels in process, with warm up and repetitions, and prints median/p90/p99 and ops/s per size
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "../utiles/utils.h"
+#include "../utiles/bench.h"
+#include "../utiles/montgomery.h"
+#include "../utiles/prng.h"
+#include "../primos/primo.h"
+#include "../rsa/rsa.h"
+
+#define DEFAULT_REPETITIONS 30
+#define DEFAULT_WARMUP 3
+#define BENCHMARK_SEED 12345
+#define MR_ROUNDS 20
+
+/* Sizes of the benchmark when -b is not given */
+static const int benchmark_bits[] = {256, 512, 1024, 2048};
+#define NUM_BENCHMARK_BITS 4
+
+/**
+ * @brief Operands shared by all the kernels of one size
+ */
+typedef struct {
+    int bits;
+    mpz_t base, exp, mod, result;   /* Random operands, mod is odd */
+    mpz_t prime;                    /* Prime of bits bits */
+    mpz_t a, b;                     /* Operands of the gcd, a < b */
+    mpz_t unit;                     /* Number with inverse modulo prime */
+    mpz_t n, d, euler_f, p, q;      /* RSA key for the Vegas attack */
+    gmp_randstate_t state;
+} bench_data;
+
+/**
+ * @brief Kernel of the benchmark
+ */
+typedef struct {
+    const char *name;
+    bench_kernel kernel;
+    int slow;                       /* 1 if the kernel is not calibrated (one call per sample) */
+} bench_entry;
+
+static void kernel_potencia_modular(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    potencia_modular(data->result, data->base, data->exp, data->mod);
+}
+
+static void kernel_montgomery(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    potencia_modular_montgomery(data->result, data->base, data->exp, data->mod);
+}
+
+static void kernel_mpz_powm(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    mpz_powm(data->result, data->base, data->exp, data->mod);
+}
+
+static void kernel_miller_rabin(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    test_miller_rabin_state(data->prime, MR_ROUNDS, data->state);
+}
+
+static void kernel_prime_generation(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    generate_prime_number_state(data->bits, MR_ROUNDS, data->result, data->state);
+}
+
+static void kernel_gcd(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    euclides_mcd(data->a, data->b, data->result);
+}
+
+static void kernel_inverse(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    extended_euclides_inverse(data->unit, data->prime, data->result);
+}
+
+static void kernel_vegas(void *arg) {
+    bench_data *data = (bench_data *)arg;
+    vegas_attack(data->d, data->n, data->euler_f, data->p, data->q);
+}
+
+static const bench_entry benchmark_kernels[] = {
+    {"potencia_modular", kernel_potencia_modular, 0},
+    {"potencia_modular_montgomery", kernel_montgomery, 0},
+    {"mpz_powm", kernel_mpz_powm, 0},
+    {"test_miller_rabin", kernel_miller_rabin, 0},
+    {"generate_prime_number", kernel_prime_generation, 1},
+    {"euclides_mcd", kernel_gcd, 0},
+    {"extended_euclides_inverse", kernel_inverse, 0},
+    {"vegas_attack", kernel_vegas, 0},
+};
+#define NUM_BENCHMARK_KERNELS (int)(sizeof(benchmark_kernels) / sizeof(benchmark_kernels[0]))
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param kernel name of the only kernel to run (NULL for all)
+ * @param bits size of the operands (0 for all the sizes of the benchmark)
+ * @param repetitions samples per kernel
+ * @param warmup calls before measuring
+ * @param format output format
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], char **kernel, int *bits, int *repetitions, int *warmup, int *format, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+/**
+ * @brief Generates the operands of one size from a fixed seed, so every run measures the same numbers
+ *
+ * @param data operands to initialize
+ * @param bits size of the operands
+ * @return int 0 if the operands were generated, -1 otherwise
+ */
+int bench_data_init(bench_data *data, int bits);
+
+/**
+ * @brief Frees the operands of one size
+ *
+ * @param data operands to free
+ */
+void bench_data_clear(bench_data *data);
+
+int main(int argc, char *argv[]) {
+
+    char *kernel = NULL, *file_out = NULL;
+    int bits = 0, repetitions = DEFAULT_REPETITIONS, warmup = DEFAULT_WARMUP, format = BENCH_FORMAT_TEXT;
+    int first = 1, found = 0, num_bits = NUM_BENCHMARK_BITS;
+    const int *sizes = benchmark_bits;
+    double *samples;
+    long inner;
+    bench_data data;
+    bench_stats stats;
+
+    if(check_args(argc, argv, &kernel, &bits, &repetitions, &warmup, &format, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    for(int k = 0; k < NUM_BENCHMARK_KERNELS; k++) {
+        if(kernel == NULL || strcmp(kernel, benchmark_kernels[k].name) == 0) {
+            found = 1;
+        }
+    }
+    if(found == 0) {
+        printf("Kernel %s not found\n", kernel);
+        print_help();
+        return -1;
+    }
+
+    if(file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    if(bits != 0) {
+        sizes = &bits;
+        num_bits = 1;
+    }
+
+    samples = (double *)malloc(repetitions * sizeof(double));
+    if(samples == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    bench_print_header(stdout, format);
+
+    for(int i = 0; i < num_bits; i++) {
+        /* The kernels that draw random testigues (Vegas) also see the same sequence in every run */
+        prng_seed(BENCHMARK_SEED);
+        if(bench_data_init(&data, sizes[i]) == -1) {
+            printf("Error generating the operands of %d bits\n", sizes[i]);
+            free(samples);
+            return -1;
+        }
+
+        for(int k = 0; k < NUM_BENCHMARK_KERNELS; k++) {
+            if(kernel != NULL && strcmp(kernel, benchmark_kernels[k].name) != 0) {
+                continue;
+            }
+
+            inner = benchmark_kernels[k].slow ? 1 : bench_calibrate(benchmark_kernels[k].kernel, &data);
+            bench_run(benchmark_kernels[k].kernel, &data, warmup, repetitions, inner, samples);
+            bench_compute_stats(samples, repetitions, inner, &stats);
+            bench_print_row(stdout, format, benchmark_kernels[k].name, sizes[i], &stats, first);
+            fflush(stdout);
+            first = 0;
+        }
+
+        bench_data_clear(&data);
+    }
+
+    bench_print_footer(stdout, format);
+
+    free(samples);
+
+    return 0;
+}
+
+int bench_data_init(bench_data *data, int bits) {
+
+    mpz_t e;
+
+    data->bits = bits;
+    gmp_randinit_default(data->state);
+    gmp_randseed_ui(data->state, BENCHMARK_SEED + bits);
+
+    mpz_init(data->base);
+    mpz_init(data->exp);
+    mpz_init(data->mod);
+    mpz_init(data->result);
+    mpz_init(data->prime);
+    mpz_init(data->a);
+    mpz_init(data->b);
+    mpz_init(data->unit);
+    mpz_init(data->n);
+    mpz_init(data->d);
+    mpz_init(data->euler_f);
+    mpz_init(data->p);
+    mpz_init(data->q);
+    mpz_init(e);
+
+    /* Exponentiation operands */
+    mpz_urandomb(data->mod, data->state, bits);
+    mpz_setbit(data->mod, bits - 1);
+    mpz_setbit(data->mod, 0);
+    mpz_urandomm(data->base, data->state, data->mod);
+    mpz_urandomb(data->exp, data->state, bits);
+    mpz_setbit(data->exp, bits - 1);
+
+    /* Primality and inverse operands */
+    generate_prime_number_state(bits, MR_ROUNDS, data->prime, data->state);
+    mpz_urandomm(data->unit, data->state, data->prime);
+    if(mpz_cmp_ui(data->unit, 0) == 0) {
+        mpz_set_ui(data->unit, 2);
+    }
+
+    /* Gcd operands */
+    mpz_urandomb(data->a, data->state, bits);
+    mpz_urandomb(data->b, data->state, bits);
+    mpz_setbit(data->b, bits);
+
+    /* RSA key of bits bits for the Vegas attack */
+    generate_prime_number_state(bits / 2, MR_ROUNDS, data->p, data->state);
+    do {
+        generate_prime_number_state(bits - bits / 2, MR_ROUNDS, data->q, data->state);
+    } while(mpz_cmp(data->p, data->q) == 0);
+    mpz_mul(data->n, data->p, data->q);
+    generate_euler_f(data->p, data->q, data->euler_f);
+    mpz_set_ui(e, 65537);
+    if(generate_d(e, data->euler_f, data->d) == -1) {
+        mpz_clear(e);
+        bench_data_clear(data);
+        return -1;
+    }
+
+    mpz_clear(e);
+
+    return 0;
+}
+
+void bench_data_clear(bench_data *data) {
+    mpz_clear(data->base);
+    mpz_clear(data->exp);
+    mpz_clear(data->mod);
+    mpz_clear(data->result);
+    mpz_clear(data->prime);
+    mpz_clear(data->a);
+    mpz_clear(data->b);
+    mpz_clear(data->unit);
+    mpz_clear(data->n);
+    mpz_clear(data->d);
+    mpz_clear(data->euler_f);
+    mpz_clear(data->p);
+    mpz_clear(data->q);
+    gmp_randclear(data->state);
+}
+
+int check_args(int argc, char *argv[], char **kernel, int *bits, int *repetitions, int *warmup, int *format, char **file_out) {
+    if (argc % 2 != 1 || argc > 13) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-k") == 0) {
+            *kernel = argv[i+1];
+        } else if (strcmp(argv[i], "-b") == 0) {
+            *bits = atoi(argv[i+1]);
+            if (*bits < 32) {
+                printf("Size must be at least 32 bits\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-r") == 0) {
+            *repetitions = atoi(argv[i+1]);
+            if (*repetitions <= 0) {
+                printf("Repetitions must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-w") == 0) {
+            *warmup = atoi(argv[i+1]);
+            if (*warmup < 0) {
+                printf("Warm up must be 0 or greater\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-f") == 0) {
+            if (strcmp(argv[i+1], "text") == 0) {
+                *format = BENCH_FORMAT_TEXT;
+            } else if (strcmp(argv[i+1], "csv") == 0) {
+                *format = BENCH_FORMAT_CSV;
+            } else if (strcmp(argv[i+1], "json") == 0) {
+                *format = BENCH_FORMAT_JSON;
+            } else {
+                printf("Format must be text, csv or json\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./benchmark [-k <kernel>] [-b <bits>] [-r <repetitions>] [-w <warmup>] [-f text|csv|json] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -k <kernel>        Only run this kernel (default: all)\n");
+    printf("  -b <bits>          Size of the operands (default: 256, 512, 1024 and 2048)\n");
+    printf("  -r <repetitions>   Samples per kernel (default %d)\n", DEFAULT_REPETITIONS);
+    printf("  -w <warmup>        Calls before measuring (default %d)\n", DEFAULT_WARMUP);
+    printf("  -f <format>        Output format (default text)\n");
+    printf("  -o <output_file>   Output file\n");
+    printf("Kernels:\n");
+    for (int k = 0; k < NUM_BENCHMARK_KERNELS; k++) {
+        printf("  %s\n", benchmark_kernels[k].name);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file des.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in des.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "des.h"
+
+uint64_t des_permute(uint64_t in, int in_bits, const unsigned short *table, int out_bits) {
+    uint64_t out = 0;
+
+    for (int i = 0; i < out_bits; i++) {
+        out = (out << 1) | ((in >> (in_bits - table[i])) & 1);
+    }
+
+    return out;
+}
+
+/* Rotates a half key of 28 bits to the left */
+static uint32_t rotate28(uint32_t half, int shift) {
+    return ((half << shift) | (half >> (28 - shift))) & 0x0FFFFFFF;
+}
+
+void des_key_schedule(uint64_t key, uint64_t subkeys[ROUNDS]) {
+    uint64_t cd = des_permute(key, 64, PC1, BITS_IN_PC1);
+    uint32_t c = (uint32_t)(cd >> 28) & 0x0FFFFFFF;
+    uint32_t d = (uint32_t)cd & 0x0FFFFFFF;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        c = rotate28(c, ROUND_SHIFTS[r]);
+        d = rotate28(d, ROUND_SHIFTS[r]);
+        subkeys[r] = des_permute(((uint64_t)c << 28) | d, BITS_IN_PC1, PC2, BITS_IN_PC2);
+    }
+}
+
+/* Round function f(R, K): expansion, key, S boxes and permutation P */
+static uint32_t des_f_reference(uint32_t r, uint64_t subkey) {
+    uint64_t x = des_permute(r, BITS_IN_P, E, BITS_IN_E) ^ subkey;
+    uint32_t s = 0;
+    int six, row, column;
+
+    for (int i = 0; i < NUM_S_BOXES; i++) {
+        six = (x >> (42 - 6 * i)) & 0x3F;
+        row = ((six >> 4) & 2) | (six & 1);
+        column = (six >> 1) & 0xF;
+        s = (s << 4) | S_BOXES[i][row][column];
+    }
+
+    return (uint32_t)des_permute(s, BITS_IN_P, P, BITS_IN_P);
+}
+
+uint64_t des_block_reference(uint64_t block, const uint64_t subkeys[ROUNDS], int mode) {
+    uint64_t x = des_permute(block, 64, IP, BITS_IN_IP);
+    uint32_t l = (uint32_t)(x >> 32), r = (uint32_t)x, aux;
+
+    for (int i = 0; i < ROUNDS; i++) {
+        aux = r;
+        r = l ^ des_f_reference(r, subkeys[mode == CYPHER ? i : ROUNDS - 1 - i]);
+        l = aux;
+    }
+
+    /* The halves are exchanged before IP^-1 */
+    return des_permute(((uint64_t)r << 32) | l, 64, IP_INV, BITS_IN_IP);
+}
+
+uint64_t des_load_block(const uint8_t *bytes) {
+    uint64_t block = 0;
+
+    for (int i = 0; i < DES_BLOCK_SIZE; i++) {
+        block = (block << 8) | bytes[i];
+    }
+
+    return block;
+}
+
+void des_store_block(uint8_t *bytes, uint64_t block) {
+    for (int i = DES_BLOCK_SIZE - 1; i >= 0; i--) {
+        bytes[i] = (uint8_t)block;
+        block >>= 8;
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file des.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief DES key schedule and reference implementation built directly on the tables of utils.h (PC1, PC2,
+ *        ROUND_SHIFTS, IP, IP_INV, E, P and S_BOXES), bit by bit. The fast engines are checked against it
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DES_H
+#define DES_H
+
+#include "../utiles/utils.h"
+
+/* Bytes of a DES block */
+#define DES_BLOCK_SIZE 8
+
+/**
+ * @brief Applies a permutation table of the DES standard. Bits are numbered from 1 (the most significant
+ *        bit of the input) as in the tables
+ *
+ * @param in input of in_bits bits, aligned to the least significant bit
+ * @param in_bits size of the input
+ * @param table table with the input bit of each output bit
+ * @param out_bits size of the output (size of the table)
+ *
+ * @return uint64_t output of out_bits bits, aligned to the least significant bit
+ */
+uint64_t des_permute(uint64_t in, int in_bits, const unsigned short *table, int out_bits);
+
+/**
+ * @brief Computes the 16 round keys of 48 bits (PC1, rotations of ROUND_SHIFTS and PC2)
+ *
+ * @param key key of 64 bits (the parity bits are ignored)
+ * @param subkeys (return) round keys, aligned to the least significant bit
+ */
+void des_key_schedule(uint64_t key, uint64_t subkeys[ROUNDS]);
+
+/**
+ * @brief Encrypts or decrypts one block with the round keys, evaluating the tables bit by bit
+ *
+ * @param block block of 64 bits
+ * @param subkeys round keys of des_key_schedule
+ * @param mode CYPHER or DECYPHER
+ *
+ * @return uint64_t encrypted or decrypted block
+ */
+uint64_t des_block_reference(uint64_t block, const uint64_t subkeys[ROUNDS], int mode);
+
+/**
+ * @brief Reads a block stored in big endian order (the first byte holds the bits 1 to 8)
+ *
+ * @param bytes DES_BLOCK_SIZE bytes
+ *
+ * @return uint64_t block
+ */
+uint64_t des_load_block(const uint8_t *bytes);
+
+/**
+ * @brief Writes a block in big endian order
+ *
+ * @param bytes (return) DES_BLOCK_SIZE bytes
+ * @param block block
+ */
+void des_store_block(uint8_t *bytes, uint64_t block);
+
+#endif
@@ -0,0 +1,230 @@
+/**
+ * @file des_benchmark.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Checks the DES engines against the standard test vector and the reference implementation, and
+ *        measures their throughput in MB/s encrypting a buffer in ECB mode
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "des.h"
+#include "des_bitslice.h"
+#include "des_table.h"
+#include "../utiles/prng.h"
+
+#define DEFAULT_MEGABYTES 8
+#define CHECK_BLOCKS 1000
+#define BENCHMARK_SEED 12345
+
+/* Test vector of the standard: key 133457799BBCDFF1, plaintext 0123456789ABCDEF */
+#define TEST_KEY 0x133457799BBCDFF1ULL
+#define TEST_PLAINTEXT 0x0123456789ABCDEFULL
+#define TEST_CIPHERTEXT 0x85E813540F0AB405ULL
+
+/* The reference engine is much slower, it only processes this fraction of the buffer */
+#define REFERENCE_FRACTION 64
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param megabytes size of the buffer of the benchmark
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], int *megabytes, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+/**
+ * @brief Checks every engine with the test vector and with random blocks against the reference
+ *
+ * @return int number of errors
+ */
+int check_engines();
+
+/**
+ * @brief Encrypts a buffer with the reference engine in ECB mode
+ *
+ * @param subkeys round keys
+ * @param out (return) output buffer
+ * @param in input buffer
+ * @param len length of the buffer, multiple of DES_BLOCK_SIZE
+ * @param mode CYPHER or DECYPHER
+ */
+void reference_ecb(const uint64_t subkeys[ROUNDS], uint8_t *out, const uint8_t *in, size_t len, int mode);
+
+int main(int argc, char *argv[]) {
+
+    int megabytes = DEFAULT_MEGABYTES, errors;
+    char *file_out = NULL;
+    uint8_t *in, *out;
+    size_t len, len_reference;
+    uint64_t subkeys[ROUNDS];
+    des_bitslice_key ks;
+    des_table_key tks;
+    double start, t_reference, t_table, t_bitslice;
+
+    if (check_args(argc, argv, &megabytes, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if (file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    errors = check_engines();
+    if (errors > 0) {
+        printf("Error: %d wrong results\n", errors);
+        return -1;
+    }
+    printf("Test vector and %d random blocks: OK\n", CHECK_BLOCKS);
+
+    len = (size_t)megabytes * 1024 * 1024;
+    len_reference = len / REFERENCE_FRACTION;
+    in = (uint8_t *)malloc(len);
+    out = (uint8_t *)malloc(len);
+    if (in == NULL || out == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    prng_seed(BENCHMARK_SEED);
+    prng_fill(in, len);
+
+    des_key_schedule(TEST_KEY, subkeys);
+    des_bitslice_set_key(&ks, TEST_KEY);
+    des_table_set_key(&tks, TEST_KEY);
+
+    start = get_wall_time();
+    reference_ecb(subkeys, out, in, len_reference, CYPHER);
+    t_reference = get_wall_time() - start;
+
+    start = get_wall_time();
+    des_table_ecb(&tks, out, in, len, CYPHER);
+    t_table = get_wall_time() - start;
+
+    start = get_wall_time();
+    des_bitslice_ecb(&ks, out, in, len, CYPHER);
+    t_bitslice = get_wall_time() - start;
+
+    printf("Engine Bytes Time(s) MB/s\n");
+    printf("reference %zu %lf %lf\n", len_reference, t_reference, len_reference / t_reference / (1024 * 1024));
+    printf("table %zu %lf %lf\n", len, t_table, len / t_table / (1024 * 1024));
+    printf("bitslice %zu %lf %lf\n", len, t_bitslice, len / t_bitslice / (1024 * 1024));
+
+    free(in);
+    free(out);
+
+    return 0;
+}
+
+int check_engines() {
+    uint64_t subkeys[ROUNDS], blocks[DES_BITSLICE_BLOCKS], plain[DES_BITSLICE_BLOCKS], key;
+    des_bitslice_key ks;
+    des_table_key tks;
+    int errors = 0;
+
+    des_key_schedule(TEST_KEY, subkeys);
+    if (des_block_reference(TEST_PLAINTEXT, subkeys, CYPHER) != TEST_CIPHERTEXT) {
+        printf("Reference engine: wrong test vector\n");
+        errors++;
+    }
+
+    des_table_set_key(&tks, TEST_KEY);
+    if (des_table_block(&tks, TEST_PLAINTEXT, CYPHER) != TEST_CIPHERTEXT) {
+        printf("Table engine: wrong test vector\n");
+        errors++;
+    }
+
+    des_bitslice_set_key(&ks, TEST_KEY);
+    for (int i = 0; i < DES_BITSLICE_BLOCKS; i++) {
+        blocks[i] = TEST_PLAINTEXT;
+    }
+    des_bitslice_crypt64(&ks, blocks, CYPHER);
+    if (blocks[0] != TEST_CIPHERTEXT || blocks[DES_BITSLICE_BLOCKS - 1] != TEST_CIPHERTEXT) {
+        printf("Bitslice engine: wrong test vector\n");
+        errors++;
+    }
+
+    /* Random keys and blocks against the reference, both ways */
+    prng_seed(BENCHMARK_SEED);
+    for (int n = 0; n < CHECK_BLOCKS; n += DES_BITSLICE_BLOCKS) {
+        key = rand64();
+        des_key_schedule(key, subkeys);
+        des_bitslice_set_key(&ks, key);
+        des_table_set_key(&tks, key);
+
+        for (int i = 0; i < DES_BITSLICE_BLOCKS; i++) {
+            plain[i] = blocks[i] = rand64();
+        }
+
+        for (int i = 0; i < DES_BITSLICE_BLOCKS; i++) {
+            if (des_table_block(&tks, plain[i], CYPHER) != des_block_reference(plain[i], subkeys, CYPHER)
+                || des_table_block(&tks, des_table_block(&tks, plain[i], CYPHER), DECYPHER) != plain[i]) {
+                errors++;
+            }
+        }
+
+        des_bitslice_crypt64(&ks, blocks, CYPHER);
+        for (int i = 0; i < DES_BITSLICE_BLOCKS; i++) {
+            if (blocks[i] != des_block_reference(plain[i], subkeys, CYPHER)) {
+                errors++;
+            }
+        }
+
+        des_bitslice_crypt64(&ks, blocks, DECYPHER);
+        for (int i = 0; i < DES_BITSLICE_BLOCKS; i++) {
+            if (blocks[i] != plain[i]) {
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+void reference_ecb(const uint64_t subkeys[ROUNDS], uint8_t *out, const uint8_t *in, size_t len, int mode) {
+    for (size_t i = 0; i < len; i += DES_BLOCK_SIZE) {
+        des_store_block(out + i, des_block_reference(des_load_block(in + i), subkeys, mode));
+    }
+}
+
+int check_args(int argc, char *argv[], int *megabytes, char **file_out) {
+    if (argc % 2 != 1 || argc > 5) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-m") == 0) {
+            *megabytes = atoi(argv[i+1]);
+            if (*megabytes <= 0) {
+                printf("Megabytes must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./des_benchmark [-m <megabytes>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -m <megabytes>     Size of the buffer (default %d)\n", DEFAULT_MEGABYTES);
+    printf("  -o <output_file>   Output file\n");
+}
@@ -0,0 +1,99 @@
+/**
+ * @file des_bitslice.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in des_bitslice.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "des_bitslice.h"
+
+/* Circuits of the S boxes with E, the key and P, written by des_sbox_gen at build time */
+#include "des_sboxes.h"
+
+void des_bitslice_set_key(des_bitslice_key *ks, uint64_t key) {
+    uint64_t subkeys[ROUNDS];
+
+    des_key_schedule(key, subkeys);
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < BITS_IN_PC2; i++) {
+            ks->keys[r][i] = -((subkeys[r] >> (BITS_IN_PC2 - 1 - i)) & 1);
+        }
+    }
+}
+
+void des_bitslice_transpose(uint64_t a[DES_BITSLICE_BLOCKS]) {
+    uint64_t m = 0x00000000FFFFFFFFULL, t;
+
+    /* Exchanges blocks of j x j bits between the two halves of each 2j x 2j submatrix */
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < DES_BITSLICE_BLOCKS; k = ((k | j) + 1) & ~j) {
+            t = (a[k] ^ (a[k | j] >> j)) & m;
+            a[k] ^= t;
+            a[k | j] ^= t << j;
+        }
+    }
+}
+
+void des_bitslice_crypt_slices(const des_bitslice_key *ks, uint64_t slices[DES_BITSLICE_BLOCKS], int mode) {
+    uint64_t state[BITS_IN_IP];
+    uint64_t *l = state, *r = state + BITS_IN_P, *aux;
+    const uint64_t *key;
+
+    /* IP is a renaming of the words */
+    for (int i = 0; i < BITS_IN_IP; i++) {
+        state[i] = slices[IP[i] - 1];
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        key = ks->keys[mode == CYPHER ? round : ROUNDS - 1 - round];
+
+        /* L(i) = R(i-1), R(i) = L(i-1) xor P(f): each box adds its outputs to the old L, which is the new R */
+        for (int s = 0; s < NUM_S_BOXES; s++) {
+            des_bitslice_sboxes[s](r, key, l);
+        }
+        aux = l;
+        l = r;
+        r = aux;
+    }
+
+    /* Output R16 L16 through IP^-1 */
+    for (int i = 0; i < BITS_IN_IP; i++) {
+        slices[i] = IP_INV[i] <= BITS_IN_P ? r[IP_INV[i] - 1] : l[IP_INV[i] - 1 - BITS_IN_P];
+    }
+}
+
+void des_bitslice_crypt64(const des_bitslice_key *ks, uint64_t blocks[DES_BITSLICE_BLOCKS], int mode) {
+    des_bitslice_transpose(blocks);
+    des_bitslice_crypt_slices(ks, blocks, mode);
+    des_bitslice_transpose(blocks);
+}
+
+int des_bitslice_ecb(const des_bitslice_key *ks, uint8_t *out, const uint8_t *in, size_t len, int mode) {
+    uint64_t blocks[DES_BITSLICE_BLOCKS];
+    size_t total, n;
+
+    if (len % DES_BLOCK_SIZE != 0) {
+        return -1;
+    }
+
+    total = len / DES_BLOCK_SIZE;
+    for (size_t first = 0; first < total; first += DES_BITSLICE_BLOCKS) {
+        n = total - first < DES_BITSLICE_BLOCKS ? total - first : DES_BITSLICE_BLOCKS;
+
+        for (size_t i = 0; i < DES_BITSLICE_BLOCKS; i++) {
+            blocks[i] = i < n ? des_load_block(in + (first + i) * DES_BLOCK_SIZE) : 0;
+        }
+
+        des_bitslice_crypt64(ks, blocks, mode);
+
+        for (size_t i = 0; i < n; i++) {
+            des_store_block(out + (first + i) * DES_BLOCK_SIZE, blocks[i]);
+        }
+    }
+
+    return 0;
+}
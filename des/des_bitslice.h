@@ -0,0 +1,79 @@
+/**
+ * @file des_bitslice.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Bitsliced DES: 64 blocks are encrypted at the same time, the word i holds the bit i of every
+ *        block. The permutations IP, E, P and IP^-1 become a renaming of words and the S boxes are boolean
+ *        circuits of about 70 gates generated from S_BOXES at build time (des_sbox_gen.c), with E, the round
+ *        key and P written in as constant indices, so a round is a fixed sequence of logic operations on 64 bit
+ *        words with no table lookups
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DES_BITSLICE_H
+#define DES_BITSLICE_H
+
+#include "des.h"
+
+/* Blocks processed in parallel (bits of a word) */
+#define DES_BITSLICE_BLOCKS 64
+
+/**
+ * @brief Round keys expanded for the bitsliced engine: every key bit is a word of zeros or ones
+ */
+typedef struct {
+    uint64_t keys[ROUNDS][BITS_IN_PC2];
+} des_bitslice_key;
+
+/**
+ * @brief Expands a key for the bitsliced engine
+ *
+ * @param ks (return) expanded key
+ * @param key key of 64 bits
+ */
+void des_bitslice_set_key(des_bitslice_key *ks, uint64_t key);
+
+/**
+ * @brief Transposes a 64x64 bit matrix in place: the bit 63-j of word i goes to the bit 63-i of word j.
+ *        It converts 64 blocks to bitsliced form and back
+ *
+ * @param a matrix of 64 words
+ */
+void des_bitslice_transpose(uint64_t a[DES_BITSLICE_BLOCKS]);
+
+/**
+ * @brief Encrypts or decrypts 64 blocks in bitsliced form (output of des_bitslice_transpose)
+ *
+ * @param ks expanded key
+ * @param slices 64 words, the word i holds the bit i+1 of every block. Replaced by the result
+ * @param mode CYPHER or DECYPHER
+ */
+void des_bitslice_crypt_slices(const des_bitslice_key *ks, uint64_t slices[DES_BITSLICE_BLOCKS], int mode);
+
+/**
+ * @brief Encrypts or decrypts 64 blocks
+ *
+ * @param ks expanded key
+ * @param blocks 64 blocks, replaced by the result
+ * @param mode CYPHER or DECYPHER
+ */
+void des_bitslice_crypt64(const des_bitslice_key *ks, uint64_t blocks[DES_BITSLICE_BLOCKS], int mode);
+
+/**
+ * @brief Encrypts or decrypts a buffer in ECB mode, 64 blocks at a time (the last group is completed
+ *        with zero blocks that are discarded)
+ *
+ * @param ks expanded key
+ * @param out (return) output buffer of len bytes (may be the same as in)
+ * @param in input buffer
+ * @param len length of the buffer, multiple of DES_BLOCK_SIZE
+ * @param mode CYPHER or DECYPHER
+ *
+ * @return int 0 if the buffer was processed, -1 if len is not a multiple of DES_BLOCK_SIZE
+ */
+int des_bitslice_ecb(const des_bitslice_key *ks, uint8_t *out, const uint8_t *in, size_t len, int mode);
+
+#endif
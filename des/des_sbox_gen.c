@@ -0,0 +1,418 @@
+/**
+ * @file des_sbox_gen.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Build time generator of the S boxes of the bitsliced DES. Every S box output is a function of 6
+ *        bits, stored as its truth table in a 64 bit word, and the four outputs of a box are built as one
+ *        circuit of AND, OR, XOR, ANDNOT and NOT gates: a function already built or one gate away from two
+ *        built functions is reused, a function that depends on fewer inputs after a XOR with a built one
+ *        is reduced that way, and the rest are split on an input bit (Shannon expansion) choosing the
+ *        cheapest of the multiplexer forms. Many random orders of the inputs and outputs are tried and the
+ *        smallest circuit is written as C code, together with the expansion E, the key addition and the
+ *        permutation P of the box, so a round has no index tables
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "../utiles/utils.h"
+
+/* Random orders tried per S box (the generator is deterministic) */
+#define GEN_TRIALS 1000
+#define GEN_SEED 0x9E3779B97F4A7C15ULL
+#define GEN_MAX_NODES 512
+/* Size of the hash tables (power of 2) */
+#define GEN_HASH (1 << 18)
+
+#define ALL_ONES 0xFFFFFFFFFFFFFFFFULL
+
+enum { OP_INPUT, OP_NOT, OP_AND, OP_OR, OP_XOR, OP_ANDNOT };
+
+/* Gate of a circuit: tt is its truth table, ANDNOT is a & ~b */
+typedef struct {
+    uint64_t tt;
+    int op, a, b;
+} gen_node;
+
+/* Circuit being built and the functions reachable from it with one more gate */
+typedef struct {
+    gen_node nodes[GEN_MAX_NODES];
+    int count;
+    uint64_t built_tt[GEN_HASH];
+    int built_node[GEN_HASH];
+    uint64_t reach_tt[GEN_HASH];
+    gen_node reach[GEN_HASH];
+    unsigned stamp_built[GEN_HASH], stamp_reach[GEN_HASH], stamp;
+    int order[6];
+    int xor_margin;
+    uint64_t rng;
+} gen_circuit;
+
+/* Truth tables of the inputs: bit i of the table is the value for the input i (bit k of i is in[k]) */
+static const uint64_t INPUT_TT[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+static uint64_t gen_random(gen_circuit *c) {
+    c->rng ^= c->rng << 13;
+    c->rng ^= c->rng >> 7;
+    c->rng ^= c->rng << 17;
+    return c->rng;
+}
+
+static unsigned gen_hash(uint64_t tt) {
+    return (unsigned)((tt * 0x9E3779B97F4A7C15ULL) >> 40) & (GEN_HASH - 1);
+}
+
+static int gen_find(const gen_circuit *c, uint64_t tt) {
+    unsigned h = gen_hash(tt);
+
+    while (c->stamp_built[h] == c->stamp) {
+        if (c->built_tt[h] == tt) {
+            return c->built_node[h];
+        }
+        h = (h + 1) & (GEN_HASH - 1);
+    }
+
+    return -1;
+}
+
+static const gen_node *gen_find_reach(const gen_circuit *c, uint64_t tt) {
+    unsigned h = gen_hash(tt);
+
+    while (c->stamp_reach[h] == c->stamp) {
+        if (c->reach_tt[h] == tt) {
+            return &c->reach[h];
+        }
+        h = (h + 1) & (GEN_HASH - 1);
+    }
+
+    return NULL;
+}
+
+static void gen_add_reach(gen_circuit *c, uint64_t tt, int op, int a, int b) {
+    unsigned h = gen_hash(tt);
+
+    while (c->stamp_reach[h] == c->stamp) {
+        if (c->reach_tt[h] == tt) {
+            return;
+        }
+        h = (h + 1) & (GEN_HASH - 1);
+    }
+    c->stamp_reach[h] = c->stamp;
+    c->reach_tt[h] = tt;
+    c->reach[h].tt = tt;
+    c->reach[h].op = op;
+    c->reach[h].a = a;
+    c->reach[h].b = b;
+}
+
+static int gen_add(gen_circuit *c, uint64_t tt, int op, int a, int b) {
+    int n = c->count++;
+    unsigned h = gen_hash(tt);
+    uint64_t u;
+
+    if (n >= GEN_MAX_NODES) {
+        printf("Too many gates\n");
+        exit(1);
+    }
+    c->nodes[n].tt = tt;
+    c->nodes[n].op = op;
+    c->nodes[n].a = a;
+    c->nodes[n].b = b;
+
+    while (c->stamp_built[h] == c->stamp) {
+        h = (h + 1) & (GEN_HASH - 1);
+    }
+    c->stamp_built[h] = c->stamp;
+    c->built_tt[h] = tt;
+    c->built_node[h] = n;
+
+    for (int i = 0; i < n; i++) {
+        u = c->nodes[i].tt;
+        gen_add_reach(c, tt & u, OP_AND, n, i);
+        gen_add_reach(c, tt | u, OP_OR, n, i);
+        gen_add_reach(c, tt ^ u, OP_XOR, n, i);
+        gen_add_reach(c, tt & ~u, OP_ANDNOT, n, i);
+        gen_add_reach(c, u & ~tt, OP_ANDNOT, i, n);
+    }
+
+    return n;
+}
+
+/* Gate with the given operands, reusing it if the function is already built */
+static int gen_gate(gen_circuit *c, int op, int a, int b) {
+    uint64_t x = c->nodes[a].tt, y = b >= 0 ? c->nodes[b].tt : 0, tt;
+    int found;
+
+    switch (op) {
+        case OP_NOT: tt = ~x; break;
+        case OP_AND: tt = x & y; break;
+        case OP_OR: tt = x | y; break;
+        case OP_XOR: tt = x ^ y; break;
+        default: tt = x & ~y; break;
+    }
+    if ((found = gen_find(c, tt)) >= 0) {
+        return found;
+    }
+
+    return gen_add(c, tt, op, a, b);
+}
+
+/* Copies the bit of every entry where the input k is 0 to the entry where it is 1 (and back) */
+static uint64_t gen_cofactor(uint64_t f, int k, int value) {
+    int shift = 1 << k;
+
+    f = value ? f & INPUT_TT[k] : f & ~INPUT_TT[k];
+    return value ? f | (f >> shift) : f | (f << shift);
+}
+
+static int gen_depends(uint64_t f, int k) {
+    return gen_cofactor(f, k, 0) != gen_cofactor(f, k, 1);
+}
+
+static int gen_support(uint64_t f) {
+    int n = 0;
+
+    for (int k = 0; k < 6; k++) {
+        n += gen_depends(f, k);
+    }
+
+    return n;
+}
+
+/* Number of the functions that are already built */
+static int gen_known(const gen_circuit *c, uint64_t tt) {
+    return gen_find(c, tt) >= 0 || gen_find(c, ~tt) >= 0 || gen_find_reach(c, tt) != NULL;
+}
+
+static int gen_synth(gen_circuit *c, uint64_t f) {
+    const gen_node *r;
+    uint64_t f0, f1, d;
+    int n, x = -1, a, b, form;
+
+    if ((n = gen_find(c, f)) >= 0) {
+        return n;
+    }
+    if ((n = gen_find(c, ~f)) >= 0) {
+        return gen_gate(c, OP_NOT, n, -1);
+    }
+    if ((r = gen_find_reach(c, f)) != NULL) {
+        return gen_gate(c, r->op, r->a, r->b);
+    }
+    if ((r = gen_find_reach(c, ~f)) != NULL) {
+        return gen_gate(c, OP_NOT, gen_gate(c, r->op, r->a, r->b), -1);
+    }
+
+    /* f = g ^ h with g built, if h depends on fewer inputs than f */
+    {
+        int support = gen_support(f), best = support - c->xor_margin, g = -1, sh;
+
+        for (int i = 6; i < c->count; i++) {
+            sh = gen_support(f ^ c->nodes[i].tt);
+            if (sh < best) {
+                best = sh;
+                g = i;
+            }
+        }
+        if (g >= 0) {
+            return gen_gate(c, OP_XOR, gen_synth(c, f ^ c->nodes[g].tt), g);
+        }
+    }
+
+    /* Input to split on: the one whose cofactors are best known, the first in the order on ties */
+    {
+        int best = -1, score, k;
+
+        for (int i = 0; i < 6; i++) {
+            k = c->order[i];
+            if (!gen_depends(f, k)) {
+                continue;
+            }
+            f0 = gen_cofactor(f, k, 0);
+            f1 = gen_cofactor(f, k, 1);
+            score = gen_known(c, f0) + gen_known(c, f1) + gen_known(c, f0 ^ f1);
+            if (score > best) {
+                best = score;
+                x = k;
+            }
+        }
+    }
+
+    f0 = gen_cofactor(f, x, 0);
+    f1 = gen_cofactor(f, x, 1);
+    d = f0 ^ f1;
+
+    if (f1 == ~f0) {
+        return gen_gate(c, OP_XOR, gen_synth(c, f0), x);
+    }
+    if (f0 == 0) {
+        return gen_gate(c, OP_AND, gen_synth(c, f1), x);
+    }
+    if (f1 == 0) {
+        return gen_gate(c, OP_ANDNOT, gen_synth(c, f0), x);
+    }
+    if (f1 == ALL_ONES) {
+        return gen_gate(c, OP_OR, gen_synth(c, f0), x);
+    }
+    if (f0 == ALL_ONES) {
+        return gen_gate(c, OP_OR, gen_synth(c, f1), gen_gate(c, OP_NOT, x, -1));
+    }
+
+    /* f0 ^ (x & d), f1 ^ (d & ~x) or (f0 & ~x) | (f1 & x): the one whose parts are known */
+    {
+        int score[3];
+
+        score[0] = gen_known(c, f0) + gen_known(c, d);
+        score[1] = gen_known(c, f1) + gen_known(c, d);
+        score[2] = gen_known(c, f0) + gen_known(c, f1);
+        form = (int)(gen_random(c) % 3);
+        for (int i = 0; i < 3; i++) {
+            if (score[i] > score[form]) {
+                form = i;
+            }
+        }
+    }
+
+    if (form == 0) {
+        a = gen_synth(c, f0);
+        b = gen_synth(c, d);
+        return gen_gate(c, OP_XOR, a, gen_gate(c, OP_AND, b, x));
+    }
+    if (form == 1) {
+        a = gen_synth(c, f1);
+        b = gen_synth(c, d);
+        return gen_gate(c, OP_XOR, a, gen_gate(c, OP_ANDNOT, b, x));
+    }
+    a = gen_synth(c, f0);
+    b = gen_synth(c, f1);
+    return gen_gate(c, OP_OR, gen_gate(c, OP_ANDNOT, a, x), gen_gate(c, OP_AND, b, x));
+}
+
+/* Builds the circuit of the outputs in a random order, returns the number of gates */
+static int gen_trial(gen_circuit *c, const uint64_t outputs[4], int result[4]) {
+    int perm[4] = {0, 1, 2, 3}, j, t;
+
+    c->stamp++;
+    c->count = 0;
+    c->xor_margin = (int)(gen_random(c) % 3);
+    for (int i = 0; i < 6; i++) {
+        gen_add(c, INPUT_TT[i], OP_INPUT, i, -1);
+        c->order[i] = i;
+    }
+    for (int i = 5; i > 0; i--) {
+        j = (int)(gen_random(c) % (uint64_t)(i + 1));
+        t = c->order[i];
+        c->order[i] = c->order[j];
+        c->order[j] = t;
+    }
+    for (int i = 3; i > 0; i--) {
+        j = (int)(gen_random(c) % (uint64_t)(i + 1));
+        t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        result[perm[i]] = gen_synth(c, outputs[perm[i]]);
+    }
+
+    return c->count - 6;
+}
+
+static void gen_operand(const gen_node *nodes, int i) {
+    if (nodes[i].op == OP_INPUT) {
+        printf("x%d", nodes[i].a);
+    } else {
+        printf("t%d", i);
+    }
+}
+
+/* Writes the function of the box s: the expansion E and the key addition of its six inputs, the circuit
+   and the permutation P of its four outputs, added to the left half */
+static void gen_print(int s, const gen_node *nodes, int count, const int result[4]) {
+    static const char *ops[] = {"", "~", " & ", " | ", " ^ ", " & ~"};
+
+    printf("/* S%d: %d gates */\n", s + 1, count - 6);
+    printf("static void des_bitslice_sbox%d(const uint64_t *r, const uint64_t *k, uint64_t *l) {\n", s + 1);
+    for (int b = 0; b < 6; b++) {
+        printf("    uint64_t x%d = r[%d] ^ k[%d];\n", b, E[6 * s + b] - 1, 6 * s + b);
+    }
+    for (int i = 6; i < count; i++) {
+        printf("    uint64_t t%d = ", i);
+        if (nodes[i].op == OP_NOT) {
+            printf("~");
+            gen_operand(nodes, nodes[i].a);
+        } else {
+            gen_operand(nodes, nodes[i].a);
+            printf("%s", ops[nodes[i].op]);
+            gen_operand(nodes, nodes[i].b);
+        }
+        printf(";\n");
+    }
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < BITS_IN_P; i++) {
+            if (P[i] - 1 == 4 * s + j) {
+                printf("    l[%d] ^= ", i);
+                gen_operand(nodes, result[j]);
+                printf(";\n");
+            }
+        }
+    }
+    printf("}\n\n");
+}
+
+int main() {
+    static gen_circuit c, best;
+    uint64_t outputs[4];
+    int result[4], best_result[4], gates, best_gates, total = 0, row, column, v;
+
+    memset(&c, 0, sizeof(gen_circuit));
+    c.rng = GEN_SEED;
+
+    printf("/* Generated by des_sbox_gen from S_BOXES, E and P, do not edit. The box s takes the right half r\n");
+    printf("   and the round key k (48 words) and adds its part of P(f) to the left half l */\n\n");
+
+    for (int s = 0; s < NUM_S_BOXES; s++) {
+        for (int j = 0; j < 4; j++) {
+            outputs[j] = 0;
+            for (int i = 0; i < 64; i++) {
+                row = ((i & 1) << 1) | ((i >> 5) & 1);
+                column = (((i >> 1) & 1) << 3) | (((i >> 2) & 1) << 2) | (((i >> 3) & 1) << 1) | ((i >> 4) & 1);
+                v = (S_BOXES[s][row][column] >> (3 - j)) & 1;
+                outputs[j] |= (uint64_t)v << i;
+            }
+        }
+
+        best_gates = GEN_MAX_NODES;
+        for (int t = 0; t < GEN_TRIALS; t++) {
+            gates = gen_trial(&c, outputs, result);
+            if (gates < best_gates) {
+                best_gates = gates;
+                memcpy(best.nodes, c.nodes, c.count * sizeof(gen_node));
+                best.count = c.count;
+                memcpy(best_result, result, sizeof(result));
+            }
+        }
+
+        for (int j = 0; j < 4; j++) {
+            if (best.nodes[best_result[j]].tt != outputs[j]) {
+                printf("#error \"Wrong circuit of S%d\"\n", s + 1);
+                return 1;
+            }
+        }
+
+        gen_print(s, best.nodes, best.count, best_result);
+        total += best_gates;
+    }
+
+    printf("/* %d gates in total */\n", total);
+    printf("static void (*const des_bitslice_sboxes[NUM_S_BOXES])(const uint64_t *r, const uint64_t *k, uint64_t *l) = {\n");
+    printf("    des_bitslice_sbox1, des_bitslice_sbox2, des_bitslice_sbox3, des_bitslice_sbox4,\n");
+    printf("    des_bitslice_sbox5, des_bitslice_sbox6, des_bitslice_sbox7, des_bitslice_sbox8\n");
+    printf("};\n");
+
+    return 0;
+}
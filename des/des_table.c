@@ -0,0 +1,134 @@
+/**
+ * @file des_table.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in des_table.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "des_table.h"
+
+/* SP[s][x] = P(S_s(x)) with the output of the box in its position of the 32 bit word */
+static uint32_t sp_tables[NUM_S_BOXES][64];
+
+/* Byte tables of the permutations: table[i][v] is the permutation of the input with the byte i
+   (0 is the most significant) equal to v and the rest of the bits to 0 */
+static uint64_t ip_tables[8][256];
+static uint64_t ip_inv_tables[8][256];
+static uint64_t pc1_tables[8][256];
+static uint64_t pc2_tables[7][256];
+
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+/* Fills the byte tables of a permutation */
+static void build_byte_tables(uint64_t tables[][256], int in_bits, const unsigned short *table, int out_bits) {
+    for (int i = 0; i < in_bits / 8; i++) {
+        for (int v = 0; v < 256; v++) {
+            tables[i][v] = des_permute((uint64_t)v << (in_bits - 8 * (i + 1)), in_bits, table, out_bits);
+        }
+    }
+}
+
+static void des_table_build() {
+    int row, column;
+
+    for (int s = 0; s < NUM_S_BOXES; s++) {
+        for (int x = 0; x < 64; x++) {
+            row = ((x >> 4) & 2) | (x & 1);
+            column = (x >> 1) & 0xF;
+            sp_tables[s][x] = (uint32_t)des_permute((uint64_t)S_BOXES[s][row][column] << (28 - 4 * s),
+                                                    BITS_IN_P, P, BITS_IN_P);
+        }
+    }
+
+    build_byte_tables(ip_tables, 64, IP, BITS_IN_IP);
+    build_byte_tables(ip_inv_tables, 64, IP_INV, BITS_IN_IP);
+    build_byte_tables(pc1_tables, 64, PC1, BITS_IN_PC1);
+    build_byte_tables(pc2_tables, BITS_IN_PC1, PC2, BITS_IN_PC2);
+}
+
+void des_table_init() {
+    pthread_once(&tables_once, des_table_build);
+}
+
+/* Permutation of a word of in_bits bits with its byte tables */
+static uint64_t permute_bytes(uint64_t tables[][256], uint64_t in, int in_bits) {
+    uint64_t out = 0;
+
+    for (int i = 0; i < in_bits / 8; i++) {
+        out |= tables[i][(in >> (in_bits - 8 * (i + 1))) & 0xFF];
+    }
+
+    return out;
+}
+
+void des_table_set_key(des_table_key *ks, uint64_t key) {
+    uint64_t cd, subkey;
+    uint32_t c, d;
+
+    des_table_init();
+
+    cd = permute_bytes(pc1_tables, key, 64);
+    c = (uint32_t)(cd >> 28) & 0x0FFFFFFF;
+    d = (uint32_t)cd & 0x0FFFFFFF;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        c = ((c << ROUND_SHIFTS[r]) | (c >> (28 - ROUND_SHIFTS[r]))) & 0x0FFFFFFF;
+        d = ((d << ROUND_SHIFTS[r]) | (d >> (28 - ROUND_SHIFTS[r]))) & 0x0FFFFFFF;
+        subkey = permute_bytes(pc2_tables, ((uint64_t)c << 28) | d, BITS_IN_PC1);
+
+        for (int s = 0; s < NUM_S_BOXES; s++) {
+            ks->keys[r][s] = (uint8_t)((subkey >> (42 - 6 * s)) & 0x3F);
+        }
+    }
+}
+
+/* f(R, K): the input of the box s is the bits 4s..4s+5 of R (bit 0 is bit 32), taken from R rotated */
+static uint32_t des_table_f(uint32_t r, const uint8_t *key) {
+    uint32_t t = (r >> 1) | (r << 31);
+
+    return sp_tables[0][(t >> 26) ^ key[0]]
+         | sp_tables[1][((t >> 22) & 0x3F) ^ key[1]]
+         | sp_tables[2][((t >> 18) & 0x3F) ^ key[2]]
+         | sp_tables[3][((t >> 14) & 0x3F) ^ key[3]]
+         | sp_tables[4][((t >> 10) & 0x3F) ^ key[4]]
+         | sp_tables[5][((t >> 6) & 0x3F) ^ key[5]]
+         | sp_tables[6][((t >> 2) & 0x3F) ^ key[6]]
+         | sp_tables[7][(((t << 2) & 0x3C) | (t >> 30)) ^ key[7]];
+}
+
+uint64_t des_table_block(const des_table_key *ks, uint64_t block, int mode) {
+    uint64_t x = permute_bytes(ip_tables, block, 64);
+    uint32_t l = (uint32_t)(x >> 32), r = (uint32_t)x, aux;
+
+    if (mode == CYPHER) {
+        for (int i = 0; i < ROUNDS; i++) {
+            aux = r;
+            r = l ^ des_table_f(r, ks->keys[i]);
+            l = aux;
+        }
+    } else {
+        for (int i = ROUNDS - 1; i >= 0; i--) {
+            aux = r;
+            r = l ^ des_table_f(r, ks->keys[i]);
+            l = aux;
+        }
+    }
+
+    return permute_bytes(ip_inv_tables, ((uint64_t)r << 32) | l, 64);
+}
+
+int des_table_ecb(const des_table_key *ks, uint8_t *out, const uint8_t *in, size_t len, int mode) {
+    if (len % DES_BLOCK_SIZE != 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < len; i += DES_BLOCK_SIZE) {
+        des_store_block(out + i, des_table_block(ks, des_load_block(in + i), mode));
+    }
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file des_table.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Table driven DES on 64 bit words: the S boxes and the permutation P are fused in eight SP tables
+ *        of 64 entries, the expansion E is done with rotations, and IP, IP^-1, PC1 and PC2 are evaluated
+ *        with one lookup per input byte. All the tables are derived from the tables of utils.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DES_TABLE_H
+#define DES_TABLE_H
+
+#include "des.h"
+
+/**
+ * @brief Round keys for the table engine: the 48 bits of each round split in the 6 bit input of each S box
+ */
+typedef struct {
+    uint8_t keys[ROUNDS][NUM_S_BOXES];
+} des_table_key;
+
+/**
+ * @brief Builds the tables of the engine (only the first call does something). des_table_set_key calls it
+ */
+void des_table_init();
+
+/**
+ * @brief Computes the round keys of a key with the byte tables of PC1 and PC2
+ *
+ * @param ks (return) round keys
+ * @param key key of 64 bits
+ */
+void des_table_set_key(des_table_key *ks, uint64_t key);
+
+/**
+ * @brief Encrypts or decrypts one block
+ *
+ * @param ks round keys
+ * @param block block of 64 bits
+ * @param mode CYPHER or DECYPHER
+ *
+ * @return uint64_t encrypted or decrypted block
+ */
+uint64_t des_table_block(const des_table_key *ks, uint64_t block, int mode);
+
+/**
+ * @brief Encrypts or decrypts a buffer in ECB mode
+ *
+ * @param ks round keys
+ * @param out (return) output buffer of len bytes (may be the same as in)
+ * @param in input buffer
+ * @param len length of the buffer, multiple of DES_BLOCK_SIZE
+ * @param mode CYPHER or DECYPHER
+ *
+ * @return int 0 if the buffer was processed, -1 if len is not a multiple of DES_BLOCK_SIZE
+ */
+int des_table_ecb(const des_table_key *ks, uint8_t *out, const uint8_t *in, size_t len, int mode);
+
+#endif
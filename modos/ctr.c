@@ -0,0 +1,357 @@
+/**
+ * @file ctr.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in ctr.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "ctr.h"
+
+struct ctr_pool {
+    pthread_t *ids;
+    int threads;                /* Threads of the pool plus the caller */
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;   /* A new buffer is ready or the pool stops */
+    pthread_cond_t done_cond;   /* The last thread finished its chunks */
+    unsigned long generation;   /* Number of the current buffer */
+    int stop;
+    int active;                 /* Threads still working on the current buffer */
+
+    /* Current buffer */
+    const ctr_cipher *cipher;
+    const uint8_t *iv;
+    uint64_t first_block;
+    uint8_t *out;
+    const uint8_t *in;
+    size_t len;
+    size_t next_chunk;
+    size_t chunks;
+    int error;                  /* 1 if a chunk of the current buffer failed */
+};
+
+static int ctr_aes_ecb(const void *ks, uint8_t *out, const uint8_t *in, size_t len) {
+    return aes_ecb((const aes_key *)ks, out, in, len, CYPHER);
+}
+
+static int ctr_des_ecb(const void *ks, uint8_t *out, const uint8_t *in, size_t len) {
+    return des_table_ecb((const des_table_key *)ks, out, in, len, CYPHER);
+}
+
+static int ctr_des_bitslice_ecb(const void *ks, uint8_t *out, const uint8_t *in, size_t len) {
+    return des_bitslice_ecb((const des_bitslice_key *)ks, out, in, len, CYPHER);
+}
+
+void ctr_cipher_aes(ctr_cipher *cipher, const aes_key *ks) {
+    cipher->ecb = ctr_aes_ecb;
+    cipher->ks = ks;
+    cipher->block_size = AES_BLOCK_SIZE;
+}
+
+void ctr_cipher_des(ctr_cipher *cipher, const des_table_key *ks) {
+    cipher->ecb = ctr_des_ecb;
+    cipher->ks = ks;
+    cipher->block_size = DES_BLOCK_SIZE;
+}
+
+void ctr_cipher_des_bitslice(ctr_cipher *cipher, const des_bitslice_key *ks) {
+    cipher->ecb = ctr_des_bitslice_ecb;
+    cipher->ks = ks;
+    cipher->block_size = DES_BLOCK_SIZE;
+}
+
+/* counter = iv + n, big endian over the whole block */
+static void ctr_set(uint8_t *counter, const uint8_t *iv, int size, uint64_t n) {
+    unsigned int carry = 0, sum;
+
+    for (int i = size - 1; i >= 0; i--) {
+        sum = iv[i] + (unsigned int)(n & 0xFF) + carry;
+        counter[i] = (uint8_t)sum;
+        carry = sum >> 8;
+        n >>= 8;
+    }
+}
+
+static void ctr_increment(uint8_t *counter, int size) {
+    for (int i = size - 1; i >= 0 && ++counter[i] == 0; i--);
+}
+
+/* Processes len bytes starting at the counter block iv + block, CTR_BATCH_BLOCKS blocks per call to the engine */
+static int ctr_process(const ctr_cipher *cipher, const uint8_t *iv, uint64_t block,
+                       uint8_t *out, const uint8_t *in, size_t len) {
+    uint8_t counter[CTR_MAX_BLOCK], batch[CTR_BATCH_BLOCKS * CTR_MAX_BLOCK];
+    size_t bs = (size_t)cipher->block_size, n, bytes;
+
+    ctr_set(counter, iv, cipher->block_size, block);
+
+    while (len > 0) {
+        n = (len + bs - 1) / bs;
+        if (n > CTR_BATCH_BLOCKS) {
+            n = CTR_BATCH_BLOCKS;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            memcpy(batch + i * bs, counter, bs);
+            ctr_increment(counter, cipher->block_size);
+        }
+        if (cipher->ecb(cipher->ks, batch, batch, n * bs) != 0) {
+            return -1;
+        }
+
+        bytes = n * bs < len ? n * bs : len;
+        for (size_t i = 0; i < bytes; i++) {
+            out[i] = in[i] ^ batch[i];
+        }
+
+        out += bytes;
+        in += bytes;
+        len -= bytes;
+    }
+
+    return 0;
+}
+
+/* Takes chunks of the current buffer until there are no more */
+static void ctr_pool_work(ctr_pool *pool) {
+    size_t chunk, start, bytes;
+
+    while (1) {
+        pthread_mutex_lock(&pool->mutex);
+        chunk = pool->next_chunk++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        if (chunk >= pool->chunks) {
+            return;
+        }
+
+        start = chunk * CTR_CHUNK_SIZE;
+        bytes = pool->len - start < CTR_CHUNK_SIZE ? pool->len - start : CTR_CHUNK_SIZE;
+        if (ctr_process(pool->cipher, pool->iv, pool->first_block + start / pool->cipher->block_size,
+                        pool->out + start, pool->in + start, bytes) != 0) {
+            pthread_mutex_lock(&pool->mutex);
+            pool->error = 1;
+            pthread_mutex_unlock(&pool->mutex);
+        }
+    }
+}
+
+static void *ctr_pool_thread(void *arg) {
+    ctr_pool *pool = (ctr_pool *)arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        ctr_pool_work(pool);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+ctr_pool *ctr_pool_create(int threads) {
+    ctr_pool *pool;
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    pool = (ctr_pool *)calloc(1, sizeof(ctr_pool));
+    if (pool == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        return NULL;
+    }
+    pool->ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    if (pool->ids == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    /* The caller of ctr_crypt is the thread 0 */
+    pool->threads = 1;
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&pool->ids[t], NULL, ctr_pool_thread, pool) != 0) {
+            ctr_pool_destroy(pool);
+            return NULL;
+        }
+        pool->threads++;
+    }
+
+    return pool;
+}
+
+void ctr_pool_destroy(ctr_pool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int t = 1; t < pool->threads; t++) {
+        pthread_join(pool->ids[t], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool->ids);
+    free(pool);
+}
+
+int ctr_crypt(ctr_pool *pool, const ctr_cipher *cipher, const uint8_t *iv, uint64_t first_block,
+              uint8_t *out, const uint8_t *in, size_t len) {
+    int error;
+
+    if (cipher->block_size <= 0 || cipher->block_size > CTR_MAX_BLOCK || CTR_CHUNK_SIZE % cipher->block_size != 0) {
+        return -1;
+    }
+
+    if (pool == NULL || pool->threads == 1 || len <= CTR_CHUNK_SIZE) {
+        return ctr_process(cipher, iv, first_block, out, in, len);
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->cipher = cipher;
+    pool->iv = iv;
+    pool->first_block = first_block;
+    pool->out = out;
+    pool->in = in;
+    pool->len = len;
+    pool->next_chunk = 0;
+    pool->chunks = (len + CTR_CHUNK_SIZE - 1) / CTR_CHUNK_SIZE;
+    pool->active = pool->threads - 1;
+    pool->error = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    ctr_pool_work(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    error = pool->error;
+    pthread_mutex_unlock(&pool->mutex);
+
+    return error ? -1 : 0;
+}
+
+void ctr_stream_init(ctr_stream *stream, const ctr_cipher *cipher, const uint8_t *iv, ctr_pool *pool) {
+    stream->cipher = *cipher;
+    stream->pool = pool;
+    memcpy(stream->iv, iv, cipher->block_size);
+    stream->block = 0;
+    stream->used = cipher->block_size;
+}
+
+int ctr_stream_update(ctr_stream *stream, uint8_t *out, const uint8_t *in, size_t len) {
+    int bs = stream->cipher.block_size;
+    size_t whole;
+
+    /* Rest of the key stream of the last block */
+    while (len > 0 && stream->used < bs) {
+        *out++ = *in++ ^ stream->keystream[stream->used++];
+        len--;
+    }
+
+    whole = len - len % bs;
+    if (whole > 0) {
+        if (ctr_crypt(stream->pool, &stream->cipher, stream->iv, stream->block, out, in, whole) != 0) {
+            return -1;
+        }
+        stream->block += whole / bs;
+        out += whole;
+        in += whole;
+        len -= whole;
+    }
+
+    /* Incomplete block: its key stream is kept for the next call */
+    if (len > 0) {
+        ctr_set(stream->keystream, stream->iv, bs, stream->block);
+        if (stream->cipher.ecb(stream->cipher.ks, stream->keystream, stream->keystream, bs) != 0) {
+            return -1;
+        }
+        stream->block++;
+        for (size_t i = 0; i < len; i++) {
+            out[i] = in[i] ^ stream->keystream[i];
+        }
+        stream->used = (int)len;
+    }
+
+    return 0;
+}
+
+long long ctr_stream_file(ctr_stream *stream, const char *in, const char *out) {
+    stream_reader reader;
+    stream_writer writer;
+    const uint8_t *chunk;
+    uint8_t *space;
+    size_t avail;
+    long long n, total = 0;
+    int error = 0;
+
+    if (stream_reader_open(&reader, in) != 0) {
+        return -1;
+    }
+    if (stream_writer_open(&writer, out) != 0) {
+        stream_reader_close(&reader);
+        return -1;
+    }
+
+    /* Chunks of at most the size of the buffer of the writer, encrypted from the input straight into it */
+    while (!error && (n = stream_reader_next(&reader, &chunk, STREAM_IO_CHUNK)) > 0) {
+        while (n > 0) {
+            space = stream_writer_space(&writer, &avail);
+            if (space == NULL) {
+                error = 1;
+                break;
+            }
+            if ((long long)avail > n) {
+                avail = (size_t)n;
+            }
+            if (ctr_stream_update(stream, space, chunk, avail) != 0) {
+                error = 1;
+                break;
+            }
+            stream_writer_commit(&writer, avail);
+            chunk += avail;
+            n -= (long long)avail;
+            total += (long long)avail;
+        }
+    }
+
+    stream_reader_close(&reader);
+    if (stream_writer_close(&writer) != 0 || n < 0) {
+        error = 1;
+    }
+
+    return error ? -1 : total;
+}
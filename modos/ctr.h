@@ -0,0 +1,149 @@
+/**
+ * @file ctr.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief CTR mode for the block ciphers of the project (AES and the DES engines). The block i of the message
+ *        is xored with E(iv + i), where iv + i is a big endian addition over the whole counter block, so
+ *        every part of a buffer can be processed independently: large buffers are split in chunks that the
+ *        threads of a pool process, and each thread encrypts CTR_BATCH_BLOCKS counters per call to the engine.
+ *        Encryption and decryption are the same operation
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CTR_H
+#define CTR_H
+
+#include "../utiles/utils.h"
+#include "../utiles/stream_io.h"
+#include "../aes/aes.h"
+#include "../des/des_table.h"
+#include "../des/des_bitslice.h"
+
+/* Largest block of the supported ciphers (AES) */
+#define CTR_MAX_BLOCK 16
+/* Counter blocks encrypted per call to the engine (the bitsliced DES does 64 at a time) */
+#define CTR_BATCH_BLOCKS 64
+/* Bytes of each chunk a thread takes from the buffer */
+#define CTR_CHUNK_SIZE (256 * 1024)
+
+/**
+ * @brief Block cipher seen by the mode: an ECB encryption of a number of whole blocks with a fixed key
+ */
+typedef struct {
+    int (*ecb)(const void *ks, uint8_t *out, const uint8_t *in, size_t len);
+    const void *ks;
+    int block_size;
+} ctr_cipher;
+
+/**
+ * @brief Pool of threads that process the chunks of a buffer. The threads are created once and wait for work
+ */
+typedef struct ctr_pool ctr_pool;
+
+/**
+ * @brief State of an encryption in several calls: the counter of the next block and the unused key stream
+ */
+typedef struct {
+    ctr_cipher cipher;
+    ctr_pool *pool;
+    uint8_t iv[CTR_MAX_BLOCK];
+    uint64_t block;                     /* Index of the next counter block */
+    uint8_t keystream[CTR_MAX_BLOCK];   /* Key stream of the last block */
+    int used;                           /* Bytes of keystream already used */
+} ctr_stream;
+
+/**
+ * @brief Uses AES as the cipher of the mode
+ *
+ * @param cipher (return) cipher
+ * @param ks expanded AES key, must live while the cipher is used
+ */
+void ctr_cipher_aes(ctr_cipher *cipher, const aes_key *ks);
+
+/**
+ * @brief Uses the table driven DES as the cipher of the mode
+ *
+ * @param cipher (return) cipher
+ * @param ks round keys, must live while the cipher is used
+ */
+void ctr_cipher_des(ctr_cipher *cipher, const des_table_key *ks);
+
+/**
+ * @brief Uses the bitsliced DES as the cipher of the mode
+ *
+ * @param cipher (return) cipher
+ * @param ks expanded key, must live while the cipher is used
+ */
+void ctr_cipher_des_bitslice(ctr_cipher *cipher, const des_bitslice_key *ks);
+
+/**
+ * @brief Creates a pool of threads
+ *
+ * @param threads number of threads, including the caller of ctr_crypt (0 to use one per online core)
+ *
+ * @return ctr_pool* the pool, NULL if the threads could not be created
+ */
+ctr_pool *ctr_pool_create(int threads);
+
+/**
+ * @brief Stops the threads of a pool and frees it
+ *
+ * @param pool pool to free (may be NULL)
+ */
+void ctr_pool_destroy(ctr_pool *pool);
+
+/**
+ * @brief Encrypts or decrypts a buffer starting at the counter block iv + first_block
+ *
+ * @param pool pool that processes the chunks (NULL to do everything in the calling thread)
+ * @param cipher cipher
+ * @param iv initial counter block of cipher->block_size bytes
+ * @param first_block index of the counter block of the first byte of the buffer
+ * @param out (return) output buffer of len bytes (may be the same as in)
+ * @param in input buffer
+ * @param len length of the buffer, any value
+ *
+ * @return int 0 if the buffer was processed, -1 if the cipher is not valid or failed on any chunk
+ */
+int ctr_crypt(ctr_pool *pool, const ctr_cipher *cipher, const uint8_t *iv, uint64_t first_block,
+              uint8_t *out, const uint8_t *in, size_t len);
+
+/**
+ * @brief Starts an encryption in several calls
+ *
+ * @param stream (return) state
+ * @param cipher cipher
+ * @param iv initial counter block of cipher->block_size bytes
+ * @param pool pool that processes the chunks (NULL to do everything in the calling thread)
+ */
+void ctr_stream_init(ctr_stream *stream, const ctr_cipher *cipher, const uint8_t *iv, ctr_pool *pool);
+
+/**
+ * @brief Encrypts or decrypts the next len bytes of the message. The pieces may have any length, the result
+ *        is the same as with a single call to ctr_crypt
+ *
+ * @param stream state
+ * @param out (return) output buffer of len bytes (may be the same as in)
+ * @param in input buffer
+ * @param len length of the buffer
+ *
+ * @return int 0 if the buffer was processed, -1 otherwise
+ */
+int ctr_stream_update(ctr_stream *stream, uint8_t *out, const uint8_t *in, size_t len);
+
+/**
+ * @brief Encrypts or decrypts a file of any size with bounded memory: the input is read with a stream_reader
+ *        (mmap windows when possible) and the result is written directly in the buffer of a stream_writer
+ *
+ * @param stream state
+ * @param in name of the input file (NULL for the standard input)
+ * @param out name of the output file (NULL for the standard output)
+ *
+ * @return long long number of bytes processed, -1 if there was an error
+ */
+long long ctr_stream_file(ctr_stream *stream, const char *in, const char *out);
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * @file ctr_benchmark.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Checks the CTR mode with the AES-128 vector of NIST SP 800-38A (F.5.1), compares the parallel and
+ *        streaming results with a single thread, and measures the throughput of every cipher with 1 to the
+ *        given number of threads
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "ctr.h"
+#include "../utiles/prng.h"
+
+#define DEFAULT_MEGABYTES 32
+#define BENCHMARK_SEED 12345
+#define NUM_CIPHERS 3
+
+/* NIST SP 800-38A F.5.1 (CTR-AES128), first two blocks */
+static const uint8_t TEST_KEY[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+static const uint8_t TEST_COUNTER[16] = {
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+static const uint8_t TEST_PLAINTEXT[32] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51};
+static const uint8_t TEST_CIPHERTEXT[32] = {
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff};
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param megabytes size of the buffer of the benchmark
+ * @param threads maximum number of threads
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], int *megabytes, int *threads, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+/**
+ * @brief Checks the test vector, and that a pool and a stream in pieces of odd sizes give the same result as
+ *        a single thread
+ *
+ * @param cipher cipher to check with the buffer
+ * @param pool pool of threads
+ * @param in buffer of len bytes
+ * @param len length of the buffer
+ *
+ * @return int number of errors
+ */
+int check_mode(const ctr_cipher *cipher, ctr_pool *pool, const uint8_t *in, size_t len);
+
+int main(int argc, char *argv[]) {
+
+    int megabytes = DEFAULT_MEGABYTES, threads = 0, errors = 0;
+    char *file_out = NULL;
+    const char *names[NUM_CIPHERS] = {"aes128", "des_table", "des_bitslice"};
+    uint8_t *in, *out, iv[CTR_MAX_BLOCK], key[16];
+    size_t len;
+    aes_key aes_ks;
+    des_table_key des_ks;
+    des_bitslice_key bitslice_ks;
+    ctr_cipher ciphers[NUM_CIPHERS];
+    ctr_pool *pool;
+    double start, t;
+
+    if (check_args(argc, argv, &megabytes, &threads, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if (file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    len = (size_t)megabytes * 1024 * 1024;
+    in = (uint8_t *)malloc(len);
+    out = (uint8_t *)malloc(len);
+    if (in == NULL || out == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    prng_seed(BENCHMARK_SEED);
+    prng_fill(in, len);
+    prng_fill(iv, CTR_MAX_BLOCK);
+    prng_fill(key, 16);
+
+    aes_set_key(&aes_ks, key, 128);
+    des_table_set_key(&des_ks, des_load_block(key));
+    des_bitslice_set_key(&bitslice_ks, des_load_block(key));
+    ctr_cipher_aes(&ciphers[0], &aes_ks);
+    ctr_cipher_des(&ciphers[1], &des_ks);
+    ctr_cipher_des_bitslice(&ciphers[2], &bitslice_ks);
+
+    pool = ctr_pool_create(threads < 2 ? 2 : threads);
+    if (pool == NULL) {
+        printf("Error creating the threads\n");
+        return -1;
+    }
+    for (int c = 0; c < NUM_CIPHERS; c++) {
+        errors += check_mode(&ciphers[c], pool, in, len < 4 * CTR_CHUNK_SIZE ? len : 4 * CTR_CHUNK_SIZE);
+    }
+    ctr_pool_destroy(pool);
+
+    if (errors > 0) {
+        printf("Error: %d wrong results\n", errors);
+        return -1;
+    }
+    printf("Test vector, threads and streaming: OK\n");
+
+    printf("Cipher Threads Bytes Time(s) MB/s\n");
+    for (int c = 0; c < NUM_CIPHERS; c++) {
+        for (int th = 1; th <= threads; th++) {
+            pool = ctr_pool_create(th);
+            if (pool == NULL) {
+                printf("Error creating the threads\n");
+                return -1;
+            }
+
+            start = get_wall_time();
+            ctr_crypt(pool, &ciphers[c], iv, 0, out, in, len);
+            t = get_wall_time() - start;
+
+            printf("%s %d %zu %lf %lf\n", names[c], th, len, t, len / t / (1024 * 1024));
+            ctr_pool_destroy(pool);
+        }
+    }
+
+    free(in);
+    free(out);
+
+    return 0;
+}
+
+int check_mode(const ctr_cipher *cipher, ctr_pool *pool, const uint8_t *in, size_t len) {
+    uint8_t *single, *parallel, block[32], iv[CTR_MAX_BLOCK];
+    aes_key ks;
+    ctr_cipher aes;
+    ctr_stream stream;
+    size_t done, piece;
+    int errors = 0;
+
+    /* Test vector, also in two pieces that cut a block */
+    aes_set_key(&ks, TEST_KEY, 128);
+    ctr_cipher_aes(&aes, &ks);
+    ctr_crypt(NULL, &aes, TEST_COUNTER, 0, block, TEST_PLAINTEXT, 32);
+    if (memcmp(block, TEST_CIPHERTEXT, 32) != 0) {
+        printf("CTR: wrong test vector\n");
+        errors++;
+    }
+    ctr_stream_init(&stream, &aes, TEST_COUNTER, NULL);
+    ctr_stream_update(&stream, block, TEST_PLAINTEXT, 5);
+    ctr_stream_update(&stream, block + 5, TEST_PLAINTEXT + 5, 27);
+    if (memcmp(block, TEST_CIPHERTEXT, 32) != 0) {
+        printf("CTR: wrong test vector in pieces\n");
+        errors++;
+    }
+
+    single = (uint8_t *)malloc(len);
+    parallel = (uint8_t *)malloc(len);
+    if (single == NULL || parallel == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    /* A counter that overflows its last bytes inside the buffer */
+    memset(iv, 0xFF, CTR_MAX_BLOCK);
+    iv[0] = 0x42;
+
+    ctr_crypt(NULL, cipher, iv, 0, single, in, len - 3);
+    ctr_crypt(pool, cipher, iv, 0, parallel, in, len - 3);
+    if (memcmp(single, parallel, len - 3) != 0) {
+        printf("CTR: threads give a different result\n");
+        errors++;
+    }
+
+    ctr_stream_init(&stream, cipher, iv, pool);
+    for (done = 0, piece = 1; done < len - 3; done += piece, piece = piece * 7 + 3) {
+        if (piece > len - 3 - done) {
+            piece = len - 3 - done;
+        }
+        ctr_stream_update(&stream, parallel + done, in + done, piece);
+    }
+    if (memcmp(single, parallel, len - 3) != 0) {
+        printf("CTR: the stream gives a different result\n");
+        errors++;
+    }
+
+    /* Decryption is the same operation */
+    ctr_crypt(pool, cipher, iv, 0, parallel, single, len - 3);
+    if (memcmp(parallel, in, len - 3) != 0) {
+        printf("CTR: wrong decryption\n");
+        errors++;
+    }
+
+    free(single);
+    free(parallel);
+
+    return errors;
+}
+
+int check_args(int argc, char *argv[], int *megabytes, int *threads, char **file_out) {
+    if (argc % 2 != 1 || argc > 7) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-m") == 0) {
+            *megabytes = atoi(argv[i+1]);
+            if (*megabytes <= 0) {
+                printf("Megabytes must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-t") == 0) {
+            *threads = atoi(argv[i+1]);
+            if (*threads < 0) {
+                printf("Threads must be 0 or greater\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./ctr_benchmark [-m <megabytes>] [-t <threads>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -m <megabytes>     Size of the buffer (default %d)\n", DEFAULT_MEGABYTES);
+    printf("  -t <threads>       Maximum number of threads (default 0, one per online core)\n");
+    printf("  -o <output_file>   Output file\n");
+}
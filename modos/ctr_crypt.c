@@ -0,0 +1,155 @@
+/**
+ * @file ctr_crypt.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Encrypts or decrypts a file of any size (binary data included) in CTR mode with AES or DES. The
+ *        file goes through the CTR stream in chunks, so the memory used does not depend on its size
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "ctr.h"
+
+#define MAX_KEY_BYTES 32
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param cipher_name name of the cipher
+ * @param key_hex key in hexadecimal
+ * @param iv_hex initial counter in hexadecimal
+ * @param threads number of threads
+ * @param file_in input file
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], char **cipher_name, char **key_hex, char **iv_hex, int *threads,
+               char **file_in, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+int main(int argc, char *argv[]) {
+
+    char *cipher_name = NULL, *key_hex = NULL, *iv_hex = NULL, *file_in = NULL, *file_out = NULL;
+    int threads = 0, key_bytes, block_size;
+    uint8_t key[MAX_KEY_BYTES], iv[CTR_MAX_BLOCK];
+    aes_key aes_ks;
+    des_table_key des_ks;
+    ctr_cipher cipher;
+    ctr_stream stream;
+    ctr_pool *pool;
+    long long bytes;
+    double start;
+
+    if (check_args(argc, argv, &cipher_name, &key_hex, &iv_hex, &threads, &file_in, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if (strcmp(cipher_name, "aes128") == 0 || strcmp(cipher_name, "aes192") == 0
+        || strcmp(cipher_name, "aes256") == 0) {
+        key_bytes = atoi(cipher_name + 3) / 8;
+        block_size = AES_BLOCK_SIZE;
+    } else if (strcmp(cipher_name, "des") == 0) {
+        key_bytes = DES_BLOCK_SIZE;
+        block_size = DES_BLOCK_SIZE;
+    } else {
+        printf("Unknown cipher %s\n", cipher_name);
+        print_help();
+        return -1;
+    }
+
+    if (parse_hex(key_hex, key, key_bytes) == -1) {
+        printf("The key must have %d hexadecimal digits\n", 2 * key_bytes);
+        return -1;
+    }
+    if (parse_hex(iv_hex, iv, block_size) == -1) {
+        printf("The initial counter must have %d hexadecimal digits\n", 2 * block_size);
+        return -1;
+    }
+
+    if (block_size == AES_BLOCK_SIZE) {
+        aes_set_key(&aes_ks, key, 8 * key_bytes);
+        ctr_cipher_aes(&cipher, &aes_ks);
+    } else {
+        des_table_set_key(&des_ks, des_load_block(key));
+        ctr_cipher_des(&cipher, &des_ks);
+    }
+
+    pool = ctr_pool_create(threads);
+    if (pool == NULL) {
+        printf("Error creating the threads\n");
+        return -1;
+    }
+
+    start = get_wall_time();
+    ctr_stream_init(&stream, &cipher, iv, pool);
+    bytes = ctr_stream_file(&stream, file_in, file_out);
+    ctr_pool_destroy(pool);
+
+    if (bytes < 0) {
+        printf("Error processing the file\n");
+        return -1;
+    }
+
+    /* The data may go to the standard output, the summary goes to stderr */
+    fprintf(stderr, "%lld bytes in %lf s\n", bytes, get_wall_time() - start);
+
+    return 0;
+}
+
+int check_args(int argc, char *argv[], char **cipher_name, char **key_hex, char **iv_hex, int *threads,
+               char **file_in, char **file_out) {
+    if (argc % 2 != 1 || argc > 13) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-c") == 0) {
+            *cipher_name = argv[i+1];
+        } else if (strcmp(argv[i], "-k") == 0) {
+            *key_hex = argv[i+1];
+        } else if (strcmp(argv[i], "-v") == 0) {
+            *iv_hex = argv[i+1];
+        } else if (strcmp(argv[i], "-t") == 0) {
+            *threads = atoi(argv[i+1]);
+            if (*threads < 0) {
+                printf("Threads must be 0 or greater\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-i") == 0) {
+            *file_in = argv[i+1];
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    if (*cipher_name == NULL || *key_hex == NULL || *iv_hex == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./ctr_crypt -c <cipher> -k <key> -v <counter> [-t <threads>] [-i <input_file>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -c <cipher>        aes128, aes192, aes256 or des\n");
+    printf("  -k <key>           Key in hexadecimal (32, 48, 64 or 16 digits)\n");
+    printf("  -v <counter>       Initial counter block in hexadecimal (32 digits for AES, 16 for DES)\n");
+    printf("  -t <threads>       Number of threads (default 0, one per online core)\n");
+    printf("  -i <input_file>    Input file (default standard input)\n");
+    printf("  -o <output_file>   Output file (default standard output)\n");
+    printf("Encryption and decryption are the same operation\n");
+}
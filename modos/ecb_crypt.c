@@ -0,0 +1,180 @@
+/**
+ * @file ecb_crypt.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Encrypts or decrypts files in ECB mode with AES or DES. Each file is read into a block_buffer that
+ *        already has room for the padding ('x' or PKCS#7), and the buffers are reused between files through
+ *        a pool
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "../utiles/block_buffer.h"
+#include "../aes/aes.h"
+#include "../des/des_table.h"
+
+#define MAX_KEY_BYTES 32
+#define MAX_FILES 16
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param cipher_name name of the cipher
+ * @param key_hex key in hexadecimal
+ * @param mode CYPHER or DECYPHER
+ * @param padding PADDING_X or PADDING_PKCS7
+ * @param files_in input files
+ * @param files_out output files
+ * @param num_files number of input and output files
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], char **cipher_name, char **key_hex, int *mode, int *padding,
+               char **files_in, char **files_out, int *num_files);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+int main(int argc, char *argv[]) {
+
+    char *cipher_name = NULL, *key_hex = NULL, *files_in[MAX_FILES], *files_out[MAX_FILES];
+    int mode = CYPHER, padding = PADDING_PKCS7, num_files = 0, key_bytes, block_size, result = 0;
+    uint8_t key[MAX_KEY_BYTES];
+    aes_key aes_ks;
+    des_table_key des_ks;
+    block_buffer buffer;
+    block_buffer_pool pool;
+
+    if (check_args(argc, argv, &cipher_name, &key_hex, &mode, &padding, files_in, files_out, &num_files) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if (strcmp(cipher_name, "aes128") == 0 || strcmp(cipher_name, "aes192") == 0
+        || strcmp(cipher_name, "aes256") == 0) {
+        key_bytes = atoi(cipher_name + 3) / 8;
+        block_size = AES_BLOCK_SIZE;
+    } else if (strcmp(cipher_name, "des") == 0) {
+        key_bytes = DES_BLOCK_SIZE;
+        block_size = DES_BLOCK_SIZE;
+    } else {
+        printf("Unknown cipher %s\n", cipher_name);
+        print_help();
+        return -1;
+    }
+
+    if (parse_hex(key_hex, key, key_bytes) == -1) {
+        printf("The key must have %d hexadecimal digits\n", 2 * key_bytes);
+        return -1;
+    }
+
+    if (block_size == AES_BLOCK_SIZE) {
+        aes_set_key(&aes_ks, key, 8 * key_bytes);
+    } else {
+        des_table_set_key(&des_ks, des_load_block(key));
+    }
+
+    block_pool_init(&pool);
+
+    for (int f = 0; f < num_files && result == 0; f++) {
+        if (block_buffer_init(&buffer, block_size, &pool, 0) != 0 || block_buffer_read(&buffer, files_in[f]) != 0) {
+            block_buffer_free(&buffer, &pool);
+            result = -1;
+            break;
+        }
+
+        if (mode == CYPHER) {
+            block_buffer_pad(&buffer, padding);
+        } else if (buffer.len % block_size != 0) {
+            printf("%s: the length is not a multiple of the block\n", files_in[f]);
+            block_buffer_free(&buffer, &pool);
+            result = -1;
+            break;
+        }
+
+        if (block_size == AES_BLOCK_SIZE) {
+            aes_ecb(&aes_ks, buffer.data, buffer.data, buffer.len, mode);
+        } else {
+            des_table_ecb(&des_ks, buffer.data, buffer.data, buffer.len, mode);
+        }
+
+        /* The 'x' padding can not be told apart from the text, it is left as addFilling does */
+        if (mode == DECYPHER && padding == PADDING_PKCS7 && block_buffer_unpad(&buffer) == -1) {
+            printf("%s: wrong padding (wrong key?)\n", files_in[f]);
+            result = -1;
+        }
+
+        if (result == 0 && stream_write_all(files_out[f], buffer.data, buffer.len) != 0) {
+            result = -1;
+        }
+
+        block_buffer_free(&buffer, &pool);
+    }
+
+    block_pool_clear(&pool);
+
+    return result;
+}
+
+int check_args(int argc, char *argv[], char **cipher_name, char **key_hex, int *mode, int *padding,
+               char **files_in, char **files_out, int *num_files) {
+    int num_out = 0;
+
+    if (argc % 2 != 1) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-c") == 0) {
+            *cipher_name = argv[i+1];
+        } else if (strcmp(argv[i], "-k") == 0) {
+            *key_hex = argv[i+1];
+        } else if (strcmp(argv[i], "-m") == 0) {
+            if (strcmp(argv[i+1], "cypher") == 0) {
+                *mode = CYPHER;
+            } else if (strcmp(argv[i+1], "decypher") == 0) {
+                *mode = DECYPHER;
+            } else {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-p") == 0) {
+            if (strcmp(argv[i+1], "pkcs7") == 0) {
+                *padding = PADDING_PKCS7;
+            } else if (strcmp(argv[i+1], "x") == 0) {
+                *padding = PADDING_X;
+            } else {
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-i") == 0 && *num_files < MAX_FILES) {
+            files_in[(*num_files)++] = argv[i+1];
+        } else if (strcmp(argv[i], "-o") == 0 && num_out < MAX_FILES) {
+            files_out[num_out++] = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    if (*cipher_name == NULL || *key_hex == NULL || *num_files == 0 || num_out != *num_files) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./ecb_crypt -c <cipher> -k <key> [-m cypher|decypher] [-p pkcs7|x] -i <input_file> -o <output_file> [-i ... -o ...]\n");
+    printf("Options:\n");
+    printf("  -c <cipher>        aes128, aes192, aes256 or des\n");
+    printf("  -k <key>           Key in hexadecimal (32, 48, 64 or 16 digits)\n");
+    printf("  -m cypher|decypher Operation (default cypher)\n");
+    printf("  -p pkcs7|x         Padding (default pkcs7)\n");
+    printf("  -i <input_file>    Input file, the i-th goes to the i-th output file (up to %d)\n", MAX_FILES);
+    printf("  -o <output_file>   Output file\n");
+}
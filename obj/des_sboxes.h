@@ -0,0 +1,697 @@
+/* Generated by des_sbox_gen from S_BOXES, E and P, do not edit. The box s takes the right half r
+   and the round key k (48 words) and adds its part of P(f) to the left half l */
+
+/* S1: 81 gates */
+static void des_bitslice_sbox1(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[31] ^ k[0];
+    uint64_t x1 = r[0] ^ k[1];
+    uint64_t x2 = r[1] ^ k[2];
+    uint64_t x3 = r[2] ^ k[3];
+    uint64_t x4 = r[3] ^ k[4];
+    uint64_t x5 = r[4] ^ k[5];
+    uint64_t t6 = x5 ^ x3;
+    uint64_t t7 = x5 ^ x2;
+    uint64_t t8 = x5 & x2;
+    uint64_t t9 = t8 & ~x3;
+    uint64_t t10 = t7 ^ t9;
+    uint64_t t11 = t10 & ~x4;
+    uint64_t t12 = t6 ^ t11;
+    uint64_t t13 = x3 ^ x2;
+    uint64_t t14 = ~t13;
+    uint64_t t15 = ~x2;
+    uint64_t t16 = x3 & x5;
+    uint64_t t17 = t15 & ~x5;
+    uint64_t t18 = t17 | t16;
+    uint64_t t19 = t18 & x4;
+    uint64_t t20 = t14 & ~x4;
+    uint64_t t21 = t20 | t19;
+    uint64_t t22 = t21 & x0;
+    uint64_t t23 = t12 & ~x0;
+    uint64_t t24 = t23 | t22;
+    uint64_t t25 = ~x5;
+    uint64_t t26 = x4 & x3;
+    uint64_t t27 = t25 & ~x3;
+    uint64_t t28 = t27 | t26;
+    uint64_t t29 = t28 ^ t8;
+    uint64_t t30 = t10 & t6;
+    uint64_t t31 = t18 ^ x5;
+    uint64_t t32 = t31 & ~x4;
+    uint64_t t33 = t30 ^ t32;
+    uint64_t t34 = t33 & x0;
+    uint64_t t35 = t29 ^ t34;
+    uint64_t t36 = t35 & ~x1;
+    uint64_t t37 = t24 ^ t36;
+    uint64_t t38 = t27 | x5;
+    uint64_t t39 = t38 & ~x4;
+    uint64_t t40 = t6 ^ t39;
+    uint64_t t41 = t40 ^ t20;
+    uint64_t t42 = t14 | t10;
+    uint64_t t43 = t14 | x3;
+    uint64_t t44 = t43 & x4;
+    uint64_t t45 = t42 ^ t44;
+    uint64_t t46 = t45 & ~x0;
+    uint64_t t47 = t41 ^ t46;
+    uint64_t t48 = ~t40;
+    uint64_t t49 = t26 ^ t16;
+    uint64_t t50 = t39 | t6;
+    uint64_t t51 = t50 & x0;
+    uint64_t t52 = t49 ^ t51;
+    uint64_t t53 = t52 & ~x2;
+    uint64_t t54 = t48 ^ t53;
+    uint64_t t55 = t54 & x1;
+    uint64_t t56 = t47 & ~x1;
+    uint64_t t57 = t56 | t55;
+    uint64_t t58 = t49 ^ t15;
+    uint64_t t59 = t25 & ~t39;
+    uint64_t t60 = t59 ^ t11;
+    uint64_t t61 = t60 & x0;
+    uint64_t t62 = t58 ^ t61;
+    uint64_t t63 = t10 | x3;
+    uint64_t t64 = t16 ^ t15;
+    uint64_t t65 = t64 & x4;
+    uint64_t t66 = t63 ^ t65;
+    uint64_t t67 = t50 ^ t38;
+    uint64_t t68 = t67 ^ t33;
+    uint64_t t69 = t68 & x0;
+    uint64_t t70 = t66 ^ t69;
+    uint64_t t71 = t70 & ~x1;
+    uint64_t t72 = t62 ^ t71;
+    uint64_t t73 = t7 & x4;
+    uint64_t t74 = x5 ^ t73;
+    uint64_t t75 = t74 ^ t6;
+    uint64_t t76 = t59 | t41;
+    uint64_t t77 = t76 & x0;
+    uint64_t t78 = t75 ^ t77;
+    uint64_t t79 = t29 & ~t65;
+    uint64_t t80 = t27 & ~t73;
+    uint64_t t81 = ~t80;
+    uint64_t t82 = t81 & x0;
+    uint64_t t83 = t79 ^ t82;
+    uint64_t t84 = t83 & x1;
+    uint64_t t85 = t78 & ~x1;
+    uint64_t t86 = t85 | t84;
+    l[8] ^= t57;
+    l[16] ^= t37;
+    l[22] ^= t72;
+    l[30] ^= t86;
+}
+
+/* S2: 71 gates */
+static void des_bitslice_sbox2(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[3] ^ k[6];
+    uint64_t x1 = r[4] ^ k[7];
+    uint64_t x2 = r[5] ^ k[8];
+    uint64_t x3 = r[6] ^ k[9];
+    uint64_t x4 = r[7] ^ k[10];
+    uint64_t x5 = r[8] ^ k[11];
+    uint64_t t6 = ~x4;
+    uint64_t t7 = x4 | x1;
+    uint64_t t8 = t7 & x3;
+    uint64_t t9 = t6 ^ t8;
+    uint64_t t10 = ~x1;
+    uint64_t t11 = t10 & x2;
+    uint64_t t12 = t9 ^ t11;
+    uint64_t t13 = t10 & ~t8;
+    uint64_t t14 = x1 & ~x2;
+    uint64_t t15 = t13 ^ t14;
+    uint64_t t16 = t15 & x0;
+    uint64_t t17 = t12 ^ t16;
+    uint64_t t18 = ~t14;
+    uint64_t t19 = x4 & ~t13;
+    uint64_t t20 = x4 ^ x1;
+    uint64_t t21 = t20 & ~x2;
+    uint64_t t22 = t19 ^ t21;
+    uint64_t t23 = t22 & x0;
+    uint64_t t24 = t18 ^ t23;
+    uint64_t t25 = t24 & x5;
+    uint64_t t26 = t17 ^ t25;
+    uint64_t t27 = t10 ^ x3;
+    uint64_t t28 = t15 ^ t8;
+    uint64_t t29 = t28 & ~x4;
+    uint64_t t30 = t27 ^ t29;
+    uint64_t t31 = t28 | t6;
+    uint64_t t32 = t31 & ~x0;
+    uint64_t t33 = t30 ^ t32;
+    uint64_t t34 = t20 ^ t11;
+    uint64_t t35 = t6 | x2;
+    uint64_t t36 = t35 & x3;
+    uint64_t t37 = t34 ^ t36;
+    uint64_t t38 = t37 ^ x0;
+    uint64_t t39 = t38 & x5;
+    uint64_t t40 = t33 & ~x5;
+    uint64_t t41 = t40 | t39;
+    uint64_t t42 = t27 ^ x4;
+    uint64_t t43 = x4 | x3;
+    uint64_t t44 = t43 & x2;
+    uint64_t t45 = t42 ^ t44;
+    uint64_t t46 = x4 ^ x3;
+    uint64_t t47 = t27 & t9;
+    uint64_t t48 = t47 & ~x2;
+    uint64_t t49 = t46 ^ t48;
+    uint64_t t50 = t49 & x0;
+    uint64_t t51 = t45 ^ t50;
+    uint64_t t52 = t14 | x4;
+    uint64_t t53 = x3 & ~x2;
+    uint64_t t54 = t46 ^ t53;
+    uint64_t t55 = t43 ^ t35;
+    uint64_t t56 = t55 & x1;
+    uint64_t t57 = t54 ^ t56;
+    uint64_t t58 = t57 & ~x0;
+    uint64_t t59 = t52 ^ t58;
+    uint64_t t60 = t59 & x5;
+    uint64_t t61 = t51 ^ t60;
+    uint64_t t62 = t35 & x1;
+    uint64_t t63 = t10 ^ x2;
+    uint64_t t64 = t63 | x4;
+    uint64_t t65 = t64 & ~x0;
+    uint64_t t66 = t62 ^ t65;
+    uint64_t t67 = t10 | t6;
+    uint64_t t68 = t67 & x3;
+    uint64_t t69 = t66 ^ t68;
+    uint64_t t70 = t55 ^ x1;
+    uint64_t t71 = t29 ^ t13;
+    uint64_t t72 = t71 & x0;
+    uint64_t t73 = t70 ^ t72;
+    uint64_t t74 = t73 & x5;
+    uint64_t t75 = t69 & ~x5;
+    uint64_t t76 = t75 | t74;
+    l[12] ^= t26;
+    l[27] ^= t41;
+    l[1] ^= t61;
+    l[17] ^= t76;
+}
+
+/* S3: 71 gates */
+static void des_bitslice_sbox3(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[7] ^ k[12];
+    uint64_t x1 = r[8] ^ k[13];
+    uint64_t x2 = r[9] ^ k[14];
+    uint64_t x3 = r[10] ^ k[15];
+    uint64_t x4 = r[11] ^ k[16];
+    uint64_t x5 = r[12] ^ k[17];
+    uint64_t t6 = x5 ^ x1;
+    uint64_t t7 = x3 & ~x4;
+    uint64_t t8 = t6 ^ t7;
+    uint64_t t9 = x4 & x2;
+    uint64_t t10 = t8 ^ t9;
+    uint64_t t11 = x5 | x3;
+    uint64_t t12 = ~x3;
+    uint64_t t13 = t12 & ~x4;
+    uint64_t t14 = t11 ^ t13;
+    uint64_t t15 = ~x4;
+    uint64_t t16 = t15 & x2;
+    uint64_t t17 = t14 ^ t16;
+    uint64_t t18 = t15 & ~x5;
+    uint64_t t19 = t12 ^ t11;
+    uint64_t t20 = t19 ^ x4;
+    uint64_t t21 = t20 & x2;
+    uint64_t t22 = t18 ^ t21;
+    uint64_t t23 = t22 & x1;
+    uint64_t t24 = t17 ^ t23;
+    uint64_t t25 = t24 & x0;
+    uint64_t t26 = t10 ^ t25;
+    uint64_t t27 = t13 | t11;
+    uint64_t t28 = t27 & ~x2;
+    uint64_t t29 = t20 ^ t28;
+    uint64_t t30 = ~t19;
+    uint64_t t31 = t12 ^ x5;
+    uint64_t t32 = t31 & x4;
+    uint64_t t33 = t30 ^ t32;
+    uint64_t t34 = ~t11;
+    uint64_t t35 = t34 & ~x2;
+    uint64_t t36 = t33 ^ t35;
+    uint64_t t37 = t36 & ~x1;
+    uint64_t t38 = t29 ^ t37;
+    uint64_t t39 = x4 & ~x3;
+    uint64_t t40 = t7 ^ x5;
+    uint64_t t41 = t40 & x2;
+    uint64_t t42 = t39 ^ t41;
+    uint64_t t43 = t31 | t7;
+    uint64_t t44 = ~x5;
+    uint64_t t45 = t44 & x2;
+    uint64_t t46 = t43 ^ t45;
+    uint64_t t47 = t46 & x1;
+    uint64_t t48 = t42 ^ t47;
+    uint64_t t49 = t48 & x0;
+    uint64_t t50 = t38 & ~x0;
+    uint64_t t51 = t50 | t49;
+    uint64_t t52 = t43 ^ t16;
+    uint64_t t53 = ~t52;
+    uint64_t t54 = t19 ^ x5;
+    uint64_t t55 = t18 ^ x3;
+    uint64_t t56 = t55 & ~x2;
+    uint64_t t57 = t54 ^ t56;
+    uint64_t t58 = t57 & x1;
+    uint64_t t59 = t53 ^ t58;
+    uint64_t t60 = t56 & t8;
+    uint64_t t61 = ~t60;
+    uint64_t t62 = t61 & x0;
+    uint64_t t63 = t59 ^ t62;
+    uint64_t t64 = t31 ^ x4;
+    uint64_t t65 = t64 ^ x2;
+    uint64_t t66 = t41 | t16;
+    uint64_t t67 = t66 & ~x1;
+    uint64_t t68 = t65 ^ t67;
+    uint64_t t69 = t19 | t9;
+    uint64_t t70 = x4 & ~t33;
+    uint64_t t71 = t12 & ~x2;
+    uint64_t t72 = t70 ^ t71;
+    uint64_t t73 = t72 & ~x1;
+    uint64_t t74 = t69 ^ t73;
+    uint64_t t75 = t74 & ~x0;
+    uint64_t t76 = t68 ^ t75;
+    l[23] ^= t76;
+    l[15] ^= t63;
+    l[29] ^= t51;
+    l[5] ^= t26;
+}
+
+/* S4: 53 gates */
+static void des_bitslice_sbox4(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[11] ^ k[18];
+    uint64_t x1 = r[12] ^ k[19];
+    uint64_t x2 = r[13] ^ k[20];
+    uint64_t x3 = r[14] ^ k[21];
+    uint64_t x4 = r[15] ^ k[22];
+    uint64_t x5 = r[16] ^ k[23];
+    uint64_t t6 = x2 & ~x0;
+    uint64_t t7 = x2 | x0;
+    uint64_t t8 = t7 & ~x4;
+    uint64_t t9 = t6 ^ t8;
+    uint64_t t10 = ~x2;
+    uint64_t t11 = t10 & ~x1;
+    uint64_t t12 = t9 ^ t11;
+    uint64_t t13 = t8 | t6;
+    uint64_t t14 = t13 & x1;
+    uint64_t t15 = x4 ^ t14;
+    uint64_t t16 = t15 & x3;
+    uint64_t t17 = t12 ^ t16;
+    uint64_t t18 = t10 ^ t7;
+    uint64_t t19 = t18 ^ t8;
+    uint64_t t20 = t19 & x1;
+    uint64_t t21 = t13 ^ t20;
+    uint64_t t22 = t18 & ~t13;
+    uint64_t t23 = x4 ^ x2;
+    uint64_t t24 = t23 & ~x1;
+    uint64_t t25 = t22 ^ t24;
+    uint64_t t26 = t25 & ~x3;
+    uint64_t t27 = t21 ^ t26;
+    uint64_t t28 = t27 & ~x5;
+    uint64_t t29 = t17 ^ t28;
+    uint64_t t30 = t10 ^ x0;
+    uint64_t t31 = x2 & x4;
+    uint64_t t32 = t30 ^ t31;
+    uint64_t t33 = t22 ^ x0;
+    uint64_t t34 = t33 & x1;
+    uint64_t t35 = t32 ^ t34;
+    uint64_t t36 = t15 ^ t9;
+    uint64_t t37 = t36 & ~x3;
+    uint64_t t38 = t35 ^ t37;
+    uint64_t t39 = t18 & x4;
+    uint64_t t40 = t13 ^ x4;
+    uint64_t t41 = t40 & ~x1;
+    uint64_t t42 = t39 ^ t41;
+    uint64_t t43 = ~x4;
+    uint64_t t44 = t23 ^ t13;
+    uint64_t t45 = t44 & x1;
+    uint64_t t46 = t43 ^ t45;
+    uint64_t t47 = t46 & x3;
+    uint64_t t48 = t42 ^ t47;
+    uint64_t t49 = t48 & x5;
+    uint64_t t50 = t38 & ~x5;
+    uint64_t t51 = t50 | t49;
+    uint64_t t52 = ~t27;
+    uint64_t t53 = t52 & x5;
+    uint64_t t54 = t17 ^ t53;
+    uint64_t t55 = ~t48;
+    uint64_t t56 = t38 & x5;
+    uint64_t t57 = t55 & ~x5;
+    uint64_t t58 = t57 | t56;
+    l[25] ^= t29;
+    l[19] ^= t54;
+    l[9] ^= t51;
+    l[0] ^= t58;
+}
+
+/* S5: 82 gates */
+static void des_bitslice_sbox5(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[15] ^ k[24];
+    uint64_t x1 = r[16] ^ k[25];
+    uint64_t x2 = r[17] ^ k[26];
+    uint64_t x3 = r[18] ^ k[27];
+    uint64_t x4 = r[19] ^ k[28];
+    uint64_t x5 = r[20] ^ k[29];
+    uint64_t t6 = x2 | x0;
+    uint64_t t7 = x0 & ~x3;
+    uint64_t t8 = t6 ^ t7;
+    uint64_t t9 = x2 ^ x0;
+    uint64_t t10 = ~t6;
+    uint64_t t11 = t10 & x3;
+    uint64_t t12 = t9 & ~x3;
+    uint64_t t13 = t12 | t11;
+    uint64_t t14 = t13 & x1;
+    uint64_t t15 = t8 & ~x1;
+    uint64_t t16 = t15 | t14;
+    uint64_t t17 = t11 | x2;
+    uint64_t t18 = t8 ^ x0;
+    uint64_t t19 = ~t18;
+    uint64_t t20 = t19 & x1;
+    uint64_t t21 = t17 ^ t20;
+    uint64_t t22 = t21 & x4;
+    uint64_t t23 = t16 ^ t22;
+    uint64_t t24 = t10 | x2;
+    uint64_t t25 = t18 | t11;
+    uint64_t t26 = t24 ^ x3;
+    uint64_t t27 = t26 & ~x1;
+    uint64_t t28 = t25 ^ t27;
+    uint64_t t29 = t28 & ~x4;
+    uint64_t t30 = t24 ^ t29;
+    uint64_t t31 = t30 & x5;
+    uint64_t t32 = t23 ^ t31;
+    uint64_t t33 = t9 ^ x3;
+    uint64_t t34 = t13 ^ t6;
+    uint64_t t35 = t34 & x1;
+    uint64_t t36 = t33 ^ t35;
+    uint64_t t37 = t24 | t7;
+    uint64_t t38 = t37 & x4;
+    uint64_t t39 = t36 ^ t38;
+    uint64_t t40 = t19 | x2;
+    uint64_t t41 = t6 & ~x3;
+    uint64_t t42 = t41 & ~x1;
+    uint64_t t43 = t40 ^ t42;
+    uint64_t t44 = t12 & x4;
+    uint64_t t45 = t43 ^ t44;
+    uint64_t t46 = t45 & x5;
+    uint64_t t47 = t39 ^ t46;
+    uint64_t t48 = t18 ^ t12;
+    uint64_t t49 = t26 | t7;
+    uint64_t t50 = t49 & x1;
+    uint64_t t51 = t48 ^ t50;
+    uint64_t t52 = t48 ^ t40;
+    uint64_t t53 = x3 & ~x0;
+    uint64_t t54 = t53 & ~x1;
+    uint64_t t55 = t52 ^ t54;
+    uint64_t t56 = t55 & x4;
+    uint64_t t57 = t51 ^ t56;
+    uint64_t t58 = t26 ^ t12;
+    uint64_t t59 = t8 ^ x3;
+    uint64_t t60 = t59 & x1;
+    uint64_t t61 = t58 ^ t60;
+    uint64_t t62 = t24 ^ t12;
+    uint64_t t63 = t7 ^ x2;
+    uint64_t t64 = t63 & ~x1;
+    uint64_t t65 = t62 ^ t64;
+    uint64_t t66 = t65 & x4;
+    uint64_t t67 = t61 ^ t66;
+    uint64_t t68 = t67 & x5;
+    uint64_t t69 = t57 ^ t68;
+    uint64_t t70 = t26 ^ x1;
+    uint64_t t71 = t33 ^ t8;
+    uint64_t t72 = t71 & ~x1;
+    uint64_t t73 = x2 ^ t72;
+    uint64_t t74 = t73 & ~x4;
+    uint64_t t75 = t70 ^ t74;
+    uint64_t t76 = x2 & ~x0;
+    uint64_t t77 = t76 & x1;
+    uint64_t t78 = t25 & ~x1;
+    uint64_t t79 = t78 | t77;
+    uint64_t t80 = t52 & ~x0;
+    uint64_t t81 = ~t8;
+    uint64_t t82 = t81 & x1;
+    uint64_t t83 = t80 ^ t82;
+    uint64_t t84 = t83 & x4;
+    uint64_t t85 = t79 ^ t84;
+    uint64_t t86 = t85 & ~x5;
+    uint64_t t87 = t75 ^ t86;
+    l[7] ^= t69;
+    l[13] ^= t47;
+    l[24] ^= t87;
+    l[2] ^= t32;
+}
+
+/* S6: 75 gates */
+static void des_bitslice_sbox6(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[19] ^ k[30];
+    uint64_t x1 = r[20] ^ k[31];
+    uint64_t x2 = r[21] ^ k[32];
+    uint64_t x3 = r[22] ^ k[33];
+    uint64_t x4 = r[23] ^ k[34];
+    uint64_t x5 = r[24] ^ k[35];
+    uint64_t t6 = x3 & ~x4;
+    uint64_t t7 = x4 & x1;
+    uint64_t t8 = t6 & ~x1;
+    uint64_t t9 = t8 | t7;
+    uint64_t t10 = x4 | x1;
+    uint64_t t11 = t10 & ~x2;
+    uint64_t t12 = t9 ^ t11;
+    uint64_t t13 = t10 & ~x3;
+    uint64_t t14 = x3 & x1;
+    uint64_t t15 = ~t14;
+    uint64_t t16 = t15 ^ t10;
+    uint64_t t17 = t16 & ~x2;
+    uint64_t t18 = t13 ^ t17;
+    uint64_t t19 = t18 & x5;
+    uint64_t t20 = t12 ^ t19;
+    uint64_t t21 = t15 | t6;
+    uint64_t t22 = x4 & ~x3;
+    uint64_t t23 = t22 ^ t14;
+    uint64_t t24 = t23 & x2;
+    uint64_t t25 = t21 ^ t24;
+    uint64_t t26 = t21 ^ t18;
+    uint64_t t27 = t26 & ~x5;
+    uint64_t t28 = t25 ^ t27;
+    uint64_t t29 = t28 & ~x0;
+    uint64_t t30 = t20 ^ t29;
+    uint64_t t31 = t22 | t9;
+    uint64_t t32 = t16 ^ t7;
+    uint64_t t33 = t32 & ~x2;
+    uint64_t t34 = t31 ^ t33;
+    uint64_t t35 = x3 | x2;
+    uint64_t t36 = t35 ^ t22;
+    uint64_t t37 = t36 ^ t24;
+    uint64_t t38 = t37 & ~x5;
+    uint64_t t39 = t34 ^ t38;
+    uint64_t t40 = x4 | x2;
+    uint64_t t41 = t31 ^ t18;
+    uint64_t t42 = t41 & x5;
+    uint64_t t43 = t40 ^ t42;
+    uint64_t t44 = t43 & x0;
+    uint64_t t45 = t39 ^ t44;
+    uint64_t t46 = t13 | t9;
+    uint64_t t47 = t16 ^ t9;
+    uint64_t t48 = t47 & x5;
+    uint64_t t49 = t46 & ~x5;
+    uint64_t t50 = t49 | t48;
+    uint64_t t51 = t50 ^ t11;
+    uint64_t t52 = x1 & ~x2;
+    uint64_t t53 = ~t52;
+    uint64_t t54 = t53 ^ t40;
+    uint64_t t55 = t54 ^ t21;
+    uint64_t t56 = t53 & ~t7;
+    uint64_t t57 = t56 ^ t22;
+    uint64_t t58 = t57 & x5;
+    uint64_t t59 = t55 & ~x5;
+    uint64_t t60 = t59 | t58;
+    uint64_t t61 = t60 & x0;
+    uint64_t t62 = t51 ^ t61;
+    uint64_t t63 = t14 ^ x4;
+    uint64_t t64 = t47 | t7;
+    uint64_t t65 = t64 & x2;
+    uint64_t t66 = t63 & ~x2;
+    uint64_t t67 = t66 | t65;
+    uint64_t t68 = t47 | t18;
+    uint64_t t69 = ~t68;
+    uint64_t t70 = t69 & x5;
+    uint64_t t71 = t67 ^ t70;
+    uint64_t t72 = t32 ^ t23;
+    uint64_t t73 = ~t72;
+    uint64_t t74 = t73 ^ t33;
+    uint64_t t75 = t35 | t34;
+    uint64_t t76 = t75 & x5;
+    uint64_t t77 = t74 ^ t76;
+    uint64_t t78 = t77 & x0;
+    uint64_t t79 = t71 & ~x0;
+    uint64_t t80 = t79 | t78;
+    l[3] ^= t45;
+    l[28] ^= t30;
+    l[10] ^= t62;
+    l[18] ^= t80;
+}
+
+/* S7: 73 gates */
+static void des_bitslice_sbox7(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[23] ^ k[36];
+    uint64_t x1 = r[24] ^ k[37];
+    uint64_t x2 = r[25] ^ k[38];
+    uint64_t x3 = r[26] ^ k[39];
+    uint64_t x4 = r[27] ^ k[40];
+    uint64_t x5 = r[28] ^ k[41];
+    uint64_t t6 = x5 ^ x3;
+    uint64_t t7 = ~x5;
+    uint64_t t8 = x3 & x1;
+    uint64_t t9 = ~t8;
+    uint64_t t10 = t9 | t7;
+    uint64_t t11 = t10 & ~x4;
+    uint64_t t12 = t6 ^ t11;
+    uint64_t t13 = x5 & x1;
+    uint64_t t14 = t13 & ~x4;
+    uint64_t t15 = t10 ^ t14;
+    uint64_t t16 = t15 & x0;
+    uint64_t t17 = t12 ^ t16;
+    uint64_t t18 = ~x1;
+    uint64_t t19 = ~x4;
+    uint64_t t20 = t19 & x3;
+    uint64_t t21 = t18 ^ t20;
+    uint64_t t22 = t21 | x5;
+    uint64_t t23 = x5 & ~t21;
+    uint64_t t24 = t23 & ~x0;
+    uint64_t t25 = t22 ^ t24;
+    uint64_t t26 = t25 & ~x2;
+    uint64_t t27 = t17 ^ t26;
+    uint64_t t28 = t8 ^ x4;
+    uint64_t t29 = x4 ^ x1;
+    uint64_t t30 = t29 & ~x3;
+    uint64_t t31 = t19 ^ t30;
+    uint64_t t32 = t31 & ~x5;
+    uint64_t t33 = t28 ^ t32;
+    uint64_t t34 = t21 & ~t28;
+    uint64_t t35 = ~t34;
+    uint64_t t36 = t28 ^ x1;
+    uint64_t t37 = t36 & ~x5;
+    uint64_t t38 = t35 ^ t37;
+    uint64_t t39 = t38 & x0;
+    uint64_t t40 = t33 ^ t39;
+    uint64_t t41 = t31 | x5;
+    uint64_t t42 = t11 | x1;
+    uint64_t t43 = t42 ^ t32;
+    uint64_t t44 = t43 & x0;
+    uint64_t t45 = t41 ^ t44;
+    uint64_t t46 = t45 & ~x2;
+    uint64_t t47 = t40 ^ t46;
+    uint64_t t48 = t9 ^ x1;
+    uint64_t t49 = t48 & x5;
+    uint64_t t50 = t28 ^ t49;
+    uint64_t t51 = t29 ^ t12;
+    uint64_t t52 = t51 & ~x0;
+    uint64_t t53 = t50 ^ t52;
+    uint64_t t54 = t41 & t10;
+    uint64_t t55 = t31 ^ x1;
+    uint64_t t56 = t55 ^ t13;
+    uint64_t t57 = t56 & ~x0;
+    uint64_t t58 = t54 ^ t57;
+    uint64_t t59 = t58 & x2;
+    uint64_t t60 = t53 ^ t59;
+    uint64_t t61 = t21 ^ t9;
+    uint64_t t62 = t31 | x1;
+    uint64_t t63 = t62 & x5;
+    uint64_t t64 = t61 ^ t63;
+    uint64_t t65 = t9 | x4;
+    uint64_t t66 = t19 & ~x5;
+    uint64_t t67 = t65 ^ t66;
+    uint64_t t68 = t67 & ~x0;
+    uint64_t t69 = t64 ^ t68;
+    uint64_t t70 = t43 | t28;
+    uint64_t t71 = t20 ^ t9;
+    uint64_t t72 = t61 | t28;
+    uint64_t t73 = t72 & ~x5;
+    uint64_t t74 = t71 ^ t73;
+    uint64_t t75 = t74 & ~x0;
+    uint64_t t76 = t70 ^ t75;
+    uint64_t t77 = t76 & x2;
+    uint64_t t78 = t69 ^ t77;
+    l[31] ^= t47;
+    l[11] ^= t60;
+    l[21] ^= t78;
+    l[6] ^= t27;
+}
+
+/* S8: 71 gates */
+static void des_bitslice_sbox8(const uint64_t *r, const uint64_t *k, uint64_t *l) {
+    uint64_t x0 = r[27] ^ k[42];
+    uint64_t x1 = r[28] ^ k[43];
+    uint64_t x2 = r[29] ^ k[44];
+    uint64_t x3 = r[30] ^ k[45];
+    uint64_t x4 = r[31] ^ k[46];
+    uint64_t x5 = r[0] ^ k[47];
+    uint64_t t6 = ~x4;
+    uint64_t t7 = ~x1;
+    uint64_t t8 = t7 & x2;
+    uint64_t t9 = t6 ^ t8;
+    uint64_t t10 = t7 | t6;
+    uint64_t t11 = t6 | x1;
+    uint64_t t12 = t11 & x2;
+    uint64_t t13 = t10 & ~x2;
+    uint64_t t14 = t13 | t12;
+    uint64_t t15 = t14 & ~x0;
+    uint64_t t16 = t9 ^ t15;
+    uint64_t t17 = x4 | x0;
+    uint64_t t18 = t6 | x0;
+    uint64_t t19 = t18 & ~x2;
+    uint64_t t20 = t17 ^ t19;
+    uint64_t t21 = t20 ^ t7;
+    uint64_t t22 = t21 & x3;
+    uint64_t t23 = t16 & ~x3;
+    uint64_t t24 = t23 | t22;
+    uint64_t t25 = t7 | x2;
+    uint64_t t26 = t25 ^ t10;
+    uint64_t t27 = x4 & ~t12;
+    uint64_t t28 = t27 & x0;
+    uint64_t t29 = t26 ^ t28;
+    uint64_t t30 = x4 & x0;
+    uint64_t t31 = t10 & ~x0;
+    uint64_t t32 = t31 | t30;
+    uint64_t t33 = t32 ^ t25;
+    uint64_t t34 = t33 & x3;
+    uint64_t t35 = t29 ^ t34;
+    uint64_t t36 = t35 & ~x5;
+    uint64_t t37 = t24 ^ t36;
+    uint64_t t38 = t13 | x4;
+    uint64_t t39 = t38 ^ t7;
+    uint64_t t40 = t7 & ~t9;
+    uint64_t t41 = t40 & ~x0;
+    uint64_t t42 = t39 ^ t41;
+    uint64_t t43 = t17 | t7;
+    uint64_t t44 = t43 & x3;
+    uint64_t t45 = t42 ^ t44;
+    uint64_t t46 = t20 | t6;
+    uint64_t t47 = x0 & ~t8;
+    uint64_t t48 = t47 & x3;
+    uint64_t t49 = t46 ^ t48;
+    uint64_t t50 = t49 & ~x5;
+    uint64_t t51 = t45 ^ t50;
+    uint64_t t52 = t18 ^ x1;
+    uint64_t t53 = t43 ^ t30;
+    uint64_t t54 = ~t53;
+    uint64_t t55 = t54 & x3;
+    uint64_t t56 = t52 & ~x3;
+    uint64_t t57 = t56 | t55;
+    uint64_t t58 = t32 | x1;
+    uint64_t t59 = t58 & x2;
+    uint64_t t60 = t57 ^ t59;
+    uint64_t t61 = t58 & ~t40;
+    uint64_t t62 = t33 | t20;
+    uint64_t t63 = t62 & ~x3;
+    uint64_t t64 = t61 ^ t63;
+    uint64_t t65 = t64 & x5;
+    uint64_t t66 = t60 ^ t65;
+    uint64_t t67 = ~t60;
+    uint64_t t68 = t25 ^ x1;
+    uint64_t t69 = t68 ^ t47;
+    uint64_t t70 = t69 ^ t29;
+    uint64_t t71 = t52 | t16;
+    uint64_t t72 = t71 ^ t41;
+    uint64_t t73 = t72 & x3;
+    uint64_t t74 = t70 ^ t73;
+    uint64_t t75 = t74 & ~x5;
+    uint64_t t76 = t67 ^ t75;
+    l[4] ^= t76;
+    l[26] ^= t51;
+    l[14] ^= t37;
+    l[20] ^= t66;
+}
+
+/* 577 gates in total */
+static void (*const des_bitslice_sboxes[NUM_S_BOXES])(const uint64_t *r, const uint64_t *k, uint64_t *l) = {
+    des_bitslice_sbox1, des_bitslice_sbox2, des_bitslice_sbox3, des_bitslice_sbox4,
+    des_bitslice_sbox5, des_bitslice_sbox6, des_bitslice_sbox7, des_bitslice_sbox8
+};
@@ -0,0 +1,29 @@
+# Script de Gnuplot para graficar el benchmark de los motores de potenciacion modular
+set title "Comparación de motores de potenciacion modular"
+set xlabel "Número de bits del módulo"
+set ylabel "Tiempo mediano (segundos)"
+set grid
+set logscale xy 2
+
+# Definir las leyendas de las curvas
+set key left top
+
+# Establecer el tipo de archivo de salida
+set terminal pngcairo size 800,600
+set output "data/grafico_benchmark.png"
+
+# Graficar los datos (una columna por motor, en el orden de la cabecera del fichero)
+file = "data/benchmark_potenciacion.txt"
+plot file using 1:2 with linespoints title "Algoritmo propio", \
+     file using 1:3 with linespoints title "Montgomery", \
+     file using 1:4 with linespoints title "Montgomery (contexto precalculado)", \
+     file using 1:5 with linespoints title "Montgomery binario", \
+     file using 1:6 with linespoints title "Base fija", \
+     file using 1:7 with linespoints title "CRT", \
+     file using 1:8 with linespoints title "mpz powm", \
+     file using 1:9 with linespoints title "mpz powm sec", \
+     file using 1:10 with linespoints title "Montgomery ladder (tiempo constante)", \
+     file using 1:11 with linespoints title "Montgomery (cache de contextos)"
+
+# Cerrar el archivo de salida
+set output
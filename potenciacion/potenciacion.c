@@ -10,6 +10,9 @@
  */
 
 #include "../utiles/utils.h"
+#include "../utiles/montgomery.h"
+#include "../utiles/powm_cache.h"
+#include "../utiles/bench.h"
 
 #define INITIAL_N 100
 #define FINAL_N 4000
@@ -17,13 +20,52 @@
 
 #define OUTPUT_FILE "data/output.txt"
 #define GNUPLOT_SCRIPT "potenciacion/grafica.gnu"
+#define TEST_SEED 12345
+
+#define BENCHMARK_FILE "data/benchmark_potenciacion.txt"
+#define BENCHMARK_GNUPLOT_SCRIPT "potenciacion/benchmark.gnu"
+#define BENCHMARK_SEED 12345
+#define BENCHMARK_REPETITIONS 10
+#define BENCHMARK_MIN_BITS 64
+#define BENCHMARK_MAX_BITS 8192
+
+#define VARIANCE_SAMPLES 200
+#define VARIANCE_MIN_BITS 512
+#define VARIANCE_MAX_BITS 2048
+#define VARIANCE_CLASSES 4
+
+/**
+ * @brief Operands and precomputed contexts of the exponentiation benchmark for one size. The modulus
+ *        is n = p*q so that the CRT engine can be compared with the same numbers
+ */
+typedef struct {
+    mpz_t base, exp, mod, result;
+    mpz_t p, q, qinv;                   /* Factors of mod, qinv = q^-1 mod p */
+    montgomery_ctx ctx, ctx_p, ctx_q;   /* Contexts of mod, p and q */
+    montgomery_exp plan, plan_binary;   /* exp recoded with the default window and with window 1 */
+    montgomery_exp plan_p, plan_q;      /* exp mod p-1 and exp mod q-1 */
+    montgomery_fixed_base fb;           /* Table of powers of base */
+    mp_limb_t *work;                    /* Work area big enough for every engine */
+    mp_limb_t *exp_ladder;              /* exp zero padded to the limbs of mod, for the ladder */
+    mpz_t mp, mq;                       /* Partial results of the CRT engine */
+} powm_benchmark;
+
+/**
+ * @brief Engine of the benchmark
+ */
+typedef struct {
+    const char *name;
+    bench_kernel kernel;
+} powm_engine;
 
 /**
  * @brief Generates a random number with n bits
  * 
+ * @param number (return) random number, lower than 2^n
  * @param n number of bits of the number
+ * @param state random state
  */
-mpz_t *generate_nbit_number(int n);
+void generate_nbit_number(mpz_t number, int n, gmp_randstate_t state);
 
 /**
  * @brief Test function for potencia_modular, comparing it with mpz_powm and getting the time of execution
@@ -31,12 +73,72 @@ mpz_t *generate_nbit_number(int n);
 void test_potencia_modular();
 
 /**
- * @brief Generates a plot with the time of execution of potencia_modular and mpz_powm
+ * @brief Generates a plot running a gnuplot script
+ *
+ * @param script gnuplot script
+ */
+void generate_plot(const char *script);
+
+/**
+ * @brief Times every exponentiation engine against mpz_powm and mpz_powm_sec for odd moduli from
+ *        BENCHMARK_MIN_BITS to BENCHMARK_MAX_BITS bits, with the same seed in every run, writing the median
+ *        time of each engine to BENCHMARK_FILE
+ *
+ * @param repetitions samples of each engine
+ * @return int 0 if every engine gave the right result, 1 otherwise
+ */
+int benchmark_potencia_modular(int repetitions);
+
+/**
+ * @brief Timing variance test of the constant time ladder against the sliding window: for several classes
+ *        of exponents (random, low Hamming weight, all ones and short) it times one exponentiation with
+ *        samples different exponents of each class and prints the median per class. The ladder should
+ *        take the same time for every class, the sliding window depends on the exponent
+ *
+ * @param samples exponents of each class
+ * @return int 0 if every result is correct, 1 otherwise
  */
-void generate_plot();
+int variance_potencia_modular(int samples);
+
+/**
+ * @brief Raises the same base to several exponents with a precomputed fixed base table, checking every
+ *        result with mpz_powm
+ *
+ * @param base_str base in decimal
+ * @param mod_str odd modulus in decimal
+ * @param exps exponents in decimal
+ * @param count number of exponents
+ * @return int 0 if every result is correct, 1 otherwise
+ */
+int fixed_base_potencia_modular(char *base_str, char *mod_str, char **exps, int count);
+
+/**
+ * @brief Computes the product of several powers with one shared chain of squarings, comparing the time
+ *        with independent exponentiations and checking the result with mpz_powm
+ *
+ * @param mod_str modulus in decimal
+ * @param args pairs base exponent in decimal
+ * @param count number of pairs
+ * @return int 0 if the result is correct, 1 otherwise
+ */
+int multi_potencia_modular(char *mod_str, char **args, int count);
+
+/**
+ * @brief Calculates base^exp mod mod with the contexts of a cache file, which is loaded before and written
+ *        after, so a later run with the same modulus (and exponent) skips the precomputations
+ *
+ * @param cache_file binary file of powm_cache_save (it is created if it does not exist)
+ * @param base_str base in decimal
+ * @param exp_str exponent in decimal
+ * @param mod_str modulus in decimal
+ * @return int 0 if the result is correct, 1 otherwise
+ */
+int cached_potencia_modular(char *cache_file, char *base_str, char *exp_str, char *mod_str);
 
 int main(int argc, char *argv[]) {
-    if (argc != 5 && strcmp(argv[1], "test") != 0) {
+    if (argc < 2 || (argc != 5 && strcmp(argv[1], "test") != 0 && strcmp(argv[1], "fixed") != 0 && strcmp(argv[1], "multi") != 0
+                     && strcmp(argv[1], "benchmark") != 0 && strcmp(argv[1], "variance") != 0
+                     && strcmp(argv[1], "cache") != 0)) {
         printf("Uso: %s mode base exponent module\n", argv[0]);
         return 1;
     }
@@ -45,8 +147,26 @@ int main(int argc, char *argv[]) {
 
     if (strcmp(argv[1], "test") == 0) {
         test_potencia_modular();
-        generate_plot();
+        generate_plot(GNUPLOT_SCRIPT);
         return 0;
+    } else if (strcmp(argv[1], "benchmark") == 0) {
+        int repetitions = argc > 2 ? atoi(argv[2]) : BENCHMARK_REPETITIONS;
+        if (repetitions <= 0) {
+            printf("Uso: %s benchmark [repetitions]\n", argv[0]);
+            return 1;
+        }
+        if (benchmark_potencia_modular(repetitions) != 0) {
+            return 1;
+        }
+        generate_plot(BENCHMARK_GNUPLOT_SCRIPT);
+        return 0;
+    } else if (strcmp(argv[1], "variance") == 0) {
+        int samples = argc > 2 ? atoi(argv[2]) : VARIANCE_SAMPLES;
+        if (samples <= 0) {
+            printf("Uso: %s variance [samples]\n", argv[0]);
+            return 1;
+        }
+        return variance_potencia_modular(samples);
     } else if (strcmp(argv[1], "get") == 0) {
         if (mpz_cmp_ui(base, 0) < 0 || mpz_cmp_ui(exp, 0) < 0 || mpz_cmp_ui(mod, 0) < 0) {
             printf("Los valores de base, exponente y modulo deben ser mayores a 0\n");
@@ -59,19 +179,37 @@ int main(int argc, char *argv[]) {
         mpz_init(result);
 
         //Get initial time
-        float start = clock();
+        double start = get_wall_time();
 
         potencia_modular(result, base, exp, mod);
 
         //Get final time
-        float finish = clock();
+        double finish = get_wall_time();
 
-        gmp_printf("Resultado: %Zd\tTiempo: %lf\n", result, (finish - start) / 1000000);
+        gmp_printf("Resultado: %Zd\tTiempo: %lf\n", result, finish - start);
 
         mpz_clear(base);
         mpz_clear(exp);
         mpz_clear(mod);
         mpz_clear(result);
+    } else if (strcmp(argv[1], "cache") == 0) {
+        if (argc != 6) {
+            printf("Uso: %s cache cache_file base exponent module\n", argv[0]);
+            return 1;
+        }
+        return cached_potencia_modular(argv[2], argv[3], argv[4], argv[5]);
+    } else if (strcmp(argv[1], "fixed") == 0) {
+        if (argc < 5) {
+            printf("Uso: %s fixed base module exponent [exponent ...]\n", argv[0]);
+            return 1;
+        }
+        return fixed_base_potencia_modular(argv[2], argv[3], argv + 4, argc - 4);
+    } else if (strcmp(argv[1], "multi") == 0) {
+        if (argc < 5 || argc % 2 != 1) {
+            printf("Uso: %s multi module base exponent [base exponent ...]\n", argv[0]);
+            return 1;
+        }
+        return multi_potencia_modular(argv[2], argv + 3, (argc - 3) / 2);
     } else {
         printf("Modo no reconocido\n");
         return 1;
@@ -80,36 +218,24 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
-mpz_t *generate_nbit_number(int n) {
-    mpz_t *number = malloc(sizeof(mpz_t));  // Reservar espacio para el número
-
-    mpz_init(*number);
-
-    // Crear un estado para los números aleatorios
-    gmp_randstate_t state;
-    gmp_randinit_default(state);  // Inicializar con el generador por defecto
-
-    // Generar una semilla más aleatoria combinando el tiempo actual con un valor aleatorio
-    unsigned long seed = time(NULL) ^ rand();  // XOR con rand() para mezclar con más aleatoriedad
-    gmp_randseed_ui(state, seed);
-
-    // Generar el número aleatorio de n bits
-    mpz_urandomb(*number, state, n);
-
-    // Limpiar el estado del generador de números aleatorios
-    gmp_randclear(state);
-
-    return number;
+void generate_nbit_number(mpz_t number, int n, gmp_randstate_t state) {
+    // Generar el número aleatorio de n bits con el estado del llamante
+    mpz_urandomb(number, state, n);
 }
 
 void test_potencia_modular() {
     
     mpz_t base, exp, mod, result, result2;
+    gmp_randstate_t state;
 
-    float start_n, start_mpz, finish_n, finish_mpz;
+    double start_n, start_mpz, finish_n, finish_mpz;
 
     FILE *output = fopen(OUTPUT_FILE, "w");
 
+    // Misma semilla en cada ejecucion para poder comparar resultados
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, TEST_SEED);
+
     mpz_init(base);
     mpz_init(exp);
     mpz_init(mod);
@@ -118,35 +244,40 @@ void test_potencia_modular() {
 
     for(int i = INITIAL_N; i < FINAL_N; i += STEP) {
 
-        mpz_set(base, *generate_nbit_number(i));
-        mpz_set(exp, *generate_nbit_number(i));
-        mpz_set(mod, *generate_nbit_number(i));
+        generate_nbit_number(base, i, state);
+        generate_nbit_number(exp, i, state);
+        generate_nbit_number(mod, i, state);
 
-        start_n = clock();
+        // Modulo impar de i bits
+        mpz_setbit(mod, i - 1);
+        mpz_setbit(mod, 0);
+
+        start_n = get_wall_time();
 
         potencia_modular(result, base, exp, mod);
 
-        finish_n = clock();
+        finish_n = get_wall_time();
 
-        start_mpz = clock();
+        start_mpz = get_wall_time();
 
         mpz_powm(result2, base, exp, mod);
 
 
-        finish_mpz = clock();
+        finish_mpz = get_wall_time();
 
         //gmp_printf("base: %Zd\nexp: %Zd\nmod: %Zd\nresult: %Zd\nresult2: %Zd\n", base, exp, mod, result, result2);
 
         if (mpz_cmp(result, result2) != 0) {
             printf("Error en la potenciacion modular\n");
-            return;
+            break;
         }
 
-        fprintf(output, "%d %lf %lf\n", i, (finish_n - start_n) / 1000000, (finish_mpz - start_mpz) / 1000000);
+        fprintf(output, "%d %lf %lf\n", i, finish_n - start_n, finish_mpz - start_mpz);
 
     }
 
     fclose(output);
+    gmp_randclear(state);
 
     mpz_clear(base);
     mpz_clear(exp);
@@ -156,12 +287,647 @@ void test_potencia_modular() {
 
 }
 
-void generate_plot() {
-    // Ejecuto el script de gnuplot contenido en GNUPLT_SCRIPT
-    char *command = malloc(strlen(GNUPLOT_SCRIPT) + 10);
-    sprintf(command, "gnuplot %s", GNUPLOT_SCRIPT);
+void generate_plot(const char *script) {
+    // Ejecuto el script de gnuplot recibido
+    char *command = malloc(strlen(script) + 10);
+    sprintf(command, "gnuplot %s", script);
     system(command);
 
     free(command);
     
 }
+
+int fixed_base_potencia_modular(char *base_str, char *mod_str, char **exps, int count) {
+
+    montgomery_ctx ctx;
+    montgomery_fixed_base fb;
+    mp_limb_t *work;
+    mpz_t base, mod, exp, result, result2;
+    size_t max_bits = 1;
+    double start, finish;
+    int errors = 0;
+
+    mpz_init(base);
+    mpz_init(mod);
+    mpz_init(exp);
+    mpz_init(result);
+    mpz_init(result2);
+
+    if (mpz_set_str(base, base_str, 10) != 0 || mpz_set_str(mod, mod_str, 10) != 0) {
+        printf("La base y el modulo deben ser numeros decimales\n");
+        errors = 1;
+        goto clear_numbers;
+    }
+
+    if (montgomery_init(&ctx, mod) == -1) {
+        printf("El modulo debe ser impar y mayor que 1\n");
+        errors = 1;
+        goto clear_numbers;
+    }
+
+    /* Every exponent is checked before any result is printed, and the table must cover the biggest one */
+    for (int i = 0; i < count; i++) {
+        if (mpz_set_str(exp, exps[i], 10) != 0 || mpz_sgn(exp) < 0) {
+            printf("Los exponentes deben ser numeros decimales no negativos\n");
+            errors = 1;
+            goto clear_ctx;
+        }
+        if (mpz_sizeinbase(exp, 2) > max_bits) {
+            max_bits = mpz_sizeinbase(exp, 2);
+        }
+    }
+
+    mpz_mod(base, base, mod);
+
+    start = get_wall_time();
+    if (montgomery_fixed_base_init(&fb, &ctx, base, max_bits, 0) == -1) {
+        printf("Error en la potenciacion modular\n");
+        errors = 1;
+        goto clear_ctx;
+    }
+    finish = get_wall_time();
+    printf("Tabla precalculada\tTiempo: %lf\n", finish - start);
+
+    work = (mp_limb_t *)malloc(montgomery_fixed_base_itch(&ctx) * sizeof(mp_limb_t));
+    if (work == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < count; i++) {
+        mpz_set_str(exp, exps[i], 10);
+
+        start = get_wall_time();
+        if (montgomery_fixed_base_powm(&fb, result, exp, work) == -1) {
+            printf("Error en la potenciacion modular\n");
+            errors = 1;
+            break;
+        }
+        finish = get_wall_time();
+
+        mpz_powm(result2, base, exp, mod);
+        if (mpz_cmp(result, result2) != 0) {
+            printf("Error en la potenciacion modular\n");
+            errors = 1;
+            break;
+        }
+
+        gmp_printf("Resultado: %Zd\tTiempo: %lf\n", result, finish - start);
+    }
+
+    free(work);
+    montgomery_fixed_base_clear(&fb);
+clear_ctx:
+    montgomery_clear(&ctx);
+clear_numbers:
+    mpz_clear(base);
+    mpz_clear(mod);
+    mpz_clear(exp);
+    mpz_clear(result);
+    mpz_clear(result2);
+
+    return errors;
+}
+
+int multi_potencia_modular(char *mod_str, char **args, int count) {
+
+    mpz_t *bases, *exps;
+    mpz_t mod, result, result2, aux;
+    double start, finish_multi, finish_single;
+    int error = 0;
+
+    bases = (mpz_t *)malloc(count * sizeof(mpz_t));
+    exps = (mpz_t *)malloc(count * sizeof(mpz_t));
+    if (bases == NULL || exps == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    mpz_init(mod);
+    mpz_init(result);
+    mpz_init(result2);
+    mpz_init(aux);
+
+    for (int i = 0; i < count; i++) {
+        mpz_init(bases[i]);
+        mpz_init(exps[i]);
+        if (mpz_set_str(bases[i], args[2 * i], 10) != 0 || mpz_set_str(exps[i], args[2 * i + 1], 10) != 0 ||
+            mpz_sgn(exps[i]) < 0) {
+            error = 1;
+        }
+    }
+    if (error) {
+        printf("Las bases y los exponentes deben ser numeros decimales, los exponentes no negativos\n");
+        goto clear;
+    }
+    if (mpz_set_str(mod, mod_str, 10) != 0 || mpz_cmp_ui(mod, 1) <= 0) {
+        printf("El modulo debe ser un numero decimal mayor que 1\n");
+        error = 1;
+        goto clear;
+    }
+
+    start = get_wall_time();
+    if (potencia_modular_multi(result, bases, exps, count, mod) != 0) {
+        printf("Error en la potenciacion modular\n");
+        error = 1;
+        goto clear;
+    }
+    finish_multi = get_wall_time() - start;
+
+    /* Independent exponentiations and products */
+    start = get_wall_time();
+    mpz_set_ui(result2, 1);
+    for (int i = 0; i < count; i++) {
+        potencia_modular_montgomery(aux, bases[i], exps[i], mod);
+        mpz_mul(result2, result2, aux);
+        mpz_mod(result2, result2, mod);
+    }
+    finish_single = get_wall_time() - start;
+
+    error = mpz_cmp(result, result2) != 0;
+
+    mpz_set_ui(result2, 1);
+    for (int i = 0; i < count; i++) {
+        mpz_powm(aux, bases[i], exps[i], mod);
+        mpz_mul(result2, result2, aux);
+        mpz_mod(result2, result2, mod);
+    }
+    error |= mpz_cmp(result, result2) != 0;
+
+    if (error) {
+        printf("Error en la potenciacion modular\n");
+    } else {
+        gmp_printf("Resultado: %Zd\tTiempo: %lf\tTiempo por separado: %lf\n", result, finish_multi, finish_single);
+    }
+
+clear:
+    for (int i = 0; i < count; i++) {
+        mpz_clear(bases[i]);
+        mpz_clear(exps[i]);
+    }
+    free(bases);
+    free(exps);
+    mpz_clear(mod);
+    mpz_clear(result);
+    mpz_clear(result2);
+    mpz_clear(aux);
+
+    return error;
+}
+
+int cached_potencia_modular(char *cache_file, char *base_str, char *exp_str, char *mod_str) {
+
+    powm_cache cache;
+    mpz_t base, exp, mod, result, result2;
+    double start, finish;
+    int loaded, error;
+
+    if (powm_cache_init(&cache, POWM_CACHE_DEFAULT_SIZE) != 0) {
+        return 1;
+    }
+
+    mpz_init(base);
+    mpz_init(exp);
+    mpz_init(mod);
+    mpz_init(result);
+    mpz_init(result2);
+
+    error = mpz_set_str(base, base_str, 10) != 0 || mpz_set_str(exp, exp_str, 10) != 0 ||
+            mpz_set_str(mod, mod_str, 10) != 0;
+    if (error || mpz_sgn(exp) < 0 || mpz_sgn(mod) <= 0) {
+        printf("Los valores deben ser numeros decimales, el exponente no negativo y el modulo positivo\n");
+        error = 1;
+        goto clear;
+    }
+
+    loaded = powm_cache_load(&cache, cache_file);
+    printf("Contextos cargados: %d\n", loaded < 0 ? 0 : loaded);
+
+    start = get_wall_time();
+    powm_cache_powm(&cache, result, base, exp, mod);
+    finish = get_wall_time();
+
+    mpz_powm(result2, base, exp, mod);
+    error = mpz_cmp(result, result2) != 0;
+    if (error) {
+        printf("Error en la potenciacion modular\n");
+        goto clear;
+    }
+
+    gmp_printf("Resultado: %Zd\tTiempo: %lf\tContexto en cache: %s\n", result, finish - start,
+               cache.hits > 0 ? "si" : "no");
+
+    if (powm_cache_save(&cache, cache_file) != 0) {
+        error = 1;
+    }
+
+clear:
+    powm_cache_clear(&cache);
+    mpz_clear(base);
+    mpz_clear(exp);
+    mpz_clear(mod);
+    mpz_clear(result);
+    mpz_clear(result2);
+
+    return error;
+}
+
+static void engine_potencia_modular(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    potencia_modular(b->result, b->base, b->exp, b->mod);
+}
+
+static void engine_montgomery(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    potencia_modular_montgomery(b->result, b->base, b->exp, b->mod);
+}
+
+static void engine_montgomery_window(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    montgomery_powm(&b->ctx, &b->plan, b->result, b->base, b->work);
+}
+
+static void engine_montgomery_binary(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    montgomery_powm(&b->ctx, &b->plan_binary, b->result, b->base, b->work);
+}
+
+static void engine_fixed_base(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    montgomery_fixed_base_powm(&b->fb, b->result, b->exp, b->work);
+}
+
+static void engine_crt(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+
+    /* mp = base^(exp mod p-1) mod p, mq = base^(exp mod q-1) mod q */
+    mpz_mod(b->mp, b->base, b->p);
+    montgomery_powm(&b->ctx_p, &b->plan_p, b->mp, b->mp, b->work);
+    mpz_mod(b->mq, b->base, b->q);
+    montgomery_powm(&b->ctx_q, &b->plan_q, b->mq, b->mq, b->work);
+
+    /* result = mq + q * (qinv * (mp - mq) mod p) */
+    mpz_sub(b->mp, b->mp, b->mq);
+    mpz_mul(b->mp, b->mp, b->qinv);
+    mpz_mod(b->mp, b->mp, b->p);
+    mpz_mul(b->result, b->mp, b->q);
+    mpz_add(b->result, b->result, b->mq);
+}
+
+static void engine_montgomery_ladder(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    montgomery_ladder_powm(&b->ctx, b->result, b->base, b->exp_ladder, b->work);
+}
+
+static void engine_montgomery_cached(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    potencia_modular_cached(b->result, b->base, b->exp, b->mod);
+}
+
+static void engine_mpz_powm(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    mpz_powm(b->result, b->base, b->exp, b->mod);
+}
+
+static void engine_mpz_powm_sec(void *arg) {
+    powm_benchmark *b = (powm_benchmark *)arg;
+    mpz_powm_sec(b->result, b->base, b->exp, b->mod);
+}
+
+/* Engines of the benchmark, in the order of the columns of BENCHMARK_FILE. The precomputations
+   (contexts, recodings and tables) are done before timing, as they are shared by many exponentiations */
+static const powm_engine powm_engines[] = {
+    {"potencia_modular", engine_potencia_modular},
+    {"montgomery", engine_montgomery},
+    {"montgomery_window", engine_montgomery_window},
+    {"montgomery_binary", engine_montgomery_binary},
+    {"fixed_base", engine_fixed_base},
+    {"crt", engine_crt},
+    {"mpz_powm", engine_mpz_powm},
+    {"mpz_powm_sec", engine_mpz_powm_sec},
+    {"montgomery_ladder", engine_montgomery_ladder},
+    {"montgomery_cached", engine_montgomery_cached},
+};
+#define NUM_POWM_ENGINES (int)(sizeof(powm_engines) / sizeof(powm_engines[0]))
+
+/**
+ * @brief Generates the operands of one size and all the precomputations of the engines
+ *
+ * @param b operands to initialize
+ * @param bits size of the modulus
+ * @param state random state
+ */
+static void powm_benchmark_init(powm_benchmark *b, int bits, gmp_randstate_t state) {
+    mpz_t aux;
+    mp_size_t itch, itch_p, itch_q;
+
+    mpz_init(b->base);
+    mpz_init(b->exp);
+    mpz_init(b->mod);
+    mpz_init(b->result);
+    mpz_init(b->p);
+    mpz_init(b->q);
+    mpz_init(b->qinv);
+    mpz_init(b->mp);
+    mpz_init(b->mq);
+    mpz_init(aux);
+
+    /* mod = p*q with p and q of bits/2 bits and mod of exactly bits bits */
+    do {
+        generate_nbit_number(b->p, bits / 2, state);
+        mpz_setbit(b->p, bits / 2 - 1);
+        mpz_setbit(b->p, bits / 2 - 2);
+        mpz_nextprime(b->p, b->p);
+        generate_nbit_number(b->q, bits - bits / 2, state);
+        mpz_setbit(b->q, bits - bits / 2 - 1);
+        mpz_setbit(b->q, bits - bits / 2 - 2);
+        mpz_nextprime(b->q, b->q);
+        mpz_mul(b->mod, b->p, b->q);
+    } while (mpz_cmp(b->p, b->q) == 0 || mpz_sizeinbase(b->mod, 2) != (size_t)bits);
+
+    mpz_urandomm(b->base, state, b->mod);
+    generate_nbit_number(b->exp, bits, state);
+    mpz_setbit(b->exp, bits - 1);
+    mpz_invert(b->qinv, b->q, b->p);
+
+    montgomery_init(&b->ctx, b->mod);
+    montgomery_init(&b->ctx_p, b->p);
+    montgomery_init(&b->ctx_q, b->q);
+    montgomery_exp_init(&b->plan, b->exp, 0);
+    montgomery_exp_init(&b->plan_binary, b->exp, 1);
+    mpz_sub_ui(aux, b->p, 1);
+    mpz_mod(aux, b->exp, aux);
+    montgomery_exp_init(&b->plan_p, aux, 0);
+    mpz_sub_ui(aux, b->q, 1);
+    mpz_mod(aux, b->exp, aux);
+    montgomery_exp_init(&b->plan_q, aux, 0);
+    montgomery_fixed_base_init(&b->fb, &b->ctx, b->base, bits, 0);
+
+    itch = montgomery_powm_itch(&b->ctx, b->plan.window);
+    if (montgomery_fixed_base_itch(&b->ctx) > itch) {
+        itch = montgomery_fixed_base_itch(&b->ctx);
+    }
+    if (montgomery_ladder_itch(&b->ctx) > itch) {
+        itch = montgomery_ladder_itch(&b->ctx);
+    }
+    itch_p = montgomery_powm_itch(&b->ctx_p, b->plan_p.window);
+    itch_q = montgomery_powm_itch(&b->ctx_q, b->plan_q.window);
+    itch = itch > itch_p ? itch : itch_p;
+    itch = itch > itch_q ? itch : itch_q;
+
+    b->work = (mp_limb_t *)malloc(itch * sizeof(mp_limb_t));
+    b->exp_ladder = (mp_limb_t *)malloc(b->ctx.size * sizeof(mp_limb_t));
+    if (b->work == NULL || b->exp_ladder == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+    montgomery_ladder_exp(&b->ctx, b->exp_ladder, b->exp);
+
+    mpz_clear(aux);
+}
+
+/**
+ * @brief Frees the operands and precomputations of one size
+ *
+ * @param b operands to free
+ */
+static void powm_benchmark_clear(powm_benchmark *b) {
+    free(b->work);
+    free(b->exp_ladder);
+    montgomery_fixed_base_clear(&b->fb);
+    montgomery_exp_clear(&b->plan);
+    montgomery_exp_clear(&b->plan_binary);
+    montgomery_exp_clear(&b->plan_p);
+    montgomery_exp_clear(&b->plan_q);
+    montgomery_clear(&b->ctx);
+    montgomery_clear(&b->ctx_p);
+    montgomery_clear(&b->ctx_q);
+    mpz_clear(b->base);
+    mpz_clear(b->exp);
+    mpz_clear(b->mod);
+    mpz_clear(b->result);
+    mpz_clear(b->p);
+    mpz_clear(b->q);
+    mpz_clear(b->qinv);
+    mpz_clear(b->mp);
+    mpz_clear(b->mq);
+}
+
+int benchmark_potencia_modular(int repetitions) {
+
+    powm_benchmark b;
+    gmp_randstate_t state;
+    bench_stats stats;
+    mpz_t expected;
+    double *samples;
+    long inner;
+    int errors = 0;
+
+    FILE *output = fopen(BENCHMARK_FILE, "w");
+    if (output == NULL) {
+        printf("Error abriendo %s\n", BENCHMARK_FILE);
+        return 1;
+    }
+
+    samples = (double *)malloc(repetitions * sizeof(double));
+    if (samples == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, BENCHMARK_SEED);
+    mpz_init(expected);
+
+    /* Header with the columns, gnuplot skips the lines starting with # */
+    fprintf(output, "# Median time (s) of one exponentiation, %d samples\n# Bits", repetitions);
+    printf("Bits");
+    for (int e = 0; e < NUM_POWM_ENGINES; e++) {
+        fprintf(output, " %s", powm_engines[e].name);
+        printf(" %s", powm_engines[e].name);
+    }
+    fprintf(output, "\n");
+    printf("\n");
+
+    for (int bits = BENCHMARK_MIN_BITS; bits <= BENCHMARK_MAX_BITS; bits *= 2) {
+        powm_benchmark_init(&b, bits, state);
+        mpz_powm(expected, b.base, b.exp, b.mod);
+
+        fprintf(output, "%d", bits);
+        printf("%d", bits);
+
+        for (int e = 0; e < NUM_POWM_ENGINES; e++) {
+            /* Check the engine before timing it */
+            powm_engines[e].kernel(&b);
+            if (mpz_cmp(b.result, expected) != 0) {
+                printf("\nError en la potenciacion modular (%s, %d bits)\n", powm_engines[e].name, bits);
+                errors++;
+            }
+
+            inner = bench_calibrate(powm_engines[e].kernel, &b);
+            bench_run(powm_engines[e].kernel, &b, 1, repetitions, inner, samples);
+            bench_compute_stats(samples, repetitions, inner, &stats);
+
+            fprintf(output, " %.9f", stats.median);
+            printf(" %.9f", stats.median);
+            fflush(stdout);
+        }
+
+        fprintf(output, "\n");
+        printf("\n");
+        powm_benchmark_clear(&b);
+    }
+
+    fclose(output);
+    free(samples);
+    mpz_clear(expected);
+    gmp_randclear(state);
+
+    return errors == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Generates an exponent of bits bits of one class of the variance test
+ *
+ * @param exp (return) exponent
+ * @param bits size of the exponent
+ * @param class 0 random, 1 low Hamming weight, 2 all ones, 3 short (bits/16 bits)
+ * @param state random state
+ */
+static void generate_class_exponent(mpz_t exp, int bits, int class, gmp_randstate_t state) {
+    switch (class) {
+    case 0:
+        mpz_urandomb(exp, state, bits);
+        mpz_setbit(exp, bits - 1);
+        break;
+    case 1:
+        mpz_set_ui(exp, 0);
+        mpz_setbit(exp, bits - 1);
+        for (int i = 0; i < 8; i++) {
+            mpz_setbit(exp, gmp_urandomm_ui(state, bits));
+        }
+        break;
+    case 2:
+        mpz_set_ui(exp, 0);
+        mpz_setbit(exp, bits);
+        mpz_sub_ui(exp, exp, 1);
+        break;
+    default:
+        mpz_urandomb(exp, state, bits / 16);
+        mpz_setbit(exp, bits / 16 - 1);
+        break;
+    }
+}
+
+int variance_potencia_modular(int samples) {
+
+    static const char *class_names[VARIANCE_CLASSES] = {"random", "low_weight", "all_ones", "short"};
+    montgomery_ctx ctx;
+    montgomery_exp plan;
+    gmp_randstate_t state;
+    bench_stats stats;
+    mpz_t mod, base, exp, result, expected;
+    mp_limb_t *work, *exp_ladder;
+    mp_size_t itch;
+    double *fast, *ladder, start, median_fast[VARIANCE_CLASSES], median_ladder[VARIANCE_CLASSES];
+    double min_fast, max_fast, min_ladder, max_ladder;
+    int errors = 0;
+
+    fast = (double *)malloc(VARIANCE_CLASSES * samples * sizeof(double));
+    ladder = (double *)malloc(VARIANCE_CLASSES * samples * sizeof(double));
+    if (fast == NULL || ladder == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, BENCHMARK_SEED);
+    mpz_init(mod);
+    mpz_init(base);
+    mpz_init(exp);
+    mpz_init(result);
+    mpz_init(expected);
+
+    printf("Bits Class Window_median(s) Window_stddev(s) Ladder_median(s) Ladder_stddev(s)\n");
+
+    for (int bits = VARIANCE_MIN_BITS; bits <= VARIANCE_MAX_BITS; bits *= 2) {
+        generate_nbit_number(mod, bits, state);
+        mpz_setbit(mod, bits - 1);
+        mpz_setbit(mod, 0);
+        mpz_urandomm(base, state, mod);
+        montgomery_init(&ctx, mod);
+
+        itch = montgomery_powm_itch(&ctx, MONTGOMERY_MAX_WINDOW);
+        if (montgomery_ladder_itch(&ctx) > itch) {
+            itch = montgomery_ladder_itch(&ctx);
+        }
+        work = (mp_limb_t *)malloc((itch + ctx.size) * sizeof(mp_limb_t));
+        if (work == NULL) {
+            printf("Error en la asignacion de memoria\n");
+            exit(1);
+        }
+        exp_ladder = work + itch;
+
+        /* The classes are interleaved so that the noise of the machine affects all of them equally */
+        for (int i = 0; i < samples; i++) {
+            for (int c = 0; c < VARIANCE_CLASSES; c++) {
+                generate_class_exponent(exp, bits, c, state);
+                mpz_powm(expected, base, exp, mod);
+
+                /* The recoding is part of the cost of the fast path for a new exponent */
+                start = get_wall_time();
+                montgomery_exp_init(&plan, exp, 0);
+                montgomery_powm(&ctx, &plan, result, base, work);
+                fast[c * samples + i] = get_wall_time() - start;
+                montgomery_exp_clear(&plan);
+                errors += mpz_cmp(result, expected) != 0;
+
+                /* The padding of the exponent is done once per key, out of the ladder */
+                montgomery_ladder_exp(&ctx, exp_ladder, exp);
+                start = get_wall_time();
+                montgomery_ladder_powm(&ctx, result, base, exp_ladder, work);
+                ladder[c * samples + i] = get_wall_time() - start;
+                errors += mpz_cmp(result, expected) != 0;
+            }
+        }
+
+        for (int c = 0; c < VARIANCE_CLASSES; c++) {
+            bench_compute_stats(fast + c * samples, samples, 1, &stats);
+            median_fast[c] = stats.median;
+            printf("%d %s %.9f %.9f", bits, class_names[c], stats.median, stats.stddev);
+            bench_compute_stats(ladder + c * samples, samples, 1, &stats);
+            median_ladder[c] = stats.median;
+            printf(" %.9f %.9f\n", stats.median, stats.stddev);
+        }
+
+        /* Spread of the medians between classes, relative to the fastest class */
+        min_fast = max_fast = median_fast[0];
+        min_ladder = max_ladder = median_ladder[0];
+        for (int c = 1; c < VARIANCE_CLASSES; c++) {
+            min_fast = median_fast[c] < min_fast ? median_fast[c] : min_fast;
+            max_fast = median_fast[c] > max_fast ? median_fast[c] : max_fast;
+            min_ladder = median_ladder[c] < min_ladder ? median_ladder[c] : min_ladder;
+            max_ladder = median_ladder[c] > max_ladder ? median_ladder[c] : max_ladder;
+        }
+        printf("%d spread %.2f%% %.2f%%\n", bits, 100 * (max_fast - min_fast) / min_fast,
+               100 * (max_ladder - min_ladder) / min_ladder);
+
+        free(work);
+        montgomery_clear(&ctx);
+    }
+
+    if (errors > 0) {
+        printf("Error en la potenciacion modular (%d resultados incorrectos)\n", errors);
+    }
+
+    free(fast);
+    free(ladder);
+    mpz_clear(mod);
+    mpz_clear(base);
+    mpz_clear(exp);
+    mpz_clear(result);
+    mpz_clear(expected);
+    gmp_randclear(state);
+
+    return errors == 0 ? 0 : 1;
+}
@@ -5,15 +5,25 @@ def graphic_primo(file):
     with open(file) as f:
         lines = f.readlines()
         x = []
-        y = []
+        mean = []
+        median = []
+        p90 = []
         for line in lines:
+            # Skip the header of the benchmark
+            if line.startswith('#'):
+                continue
             data = line.split()
             x.append(int(data[0]))
-            y.append(float(data[1]))
-    plt.plot(x, y)
+            mean.append(float(data[3]))
+            median.append(float(data[4]))
+            p90.append(float(data[6]))
+    plt.plot(x, mean, label='Mean')
+    plt.plot(x, median, label='Median')
+    plt.plot(x, p90, label='P90')
     plt.xlabel('Primes size (bits)')
     plt.ylabel('Time (s)')
-    plt.title('Average time to generate primes')
+    plt.title('Time to generate primes')
+    plt.legend()
     
     # Create image of the graphic
     plt.savefig('data/primos.png')
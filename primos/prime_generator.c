@@ -10,6 +10,21 @@
  */
 
 #include "primo.h"
+#include "../utiles/stats.h"
+#include "../utiles/bench.h"
+#include "../utiles/mpz_file.h"
+
+#define BENCHMARK_SAMPLES 30
+#define BENCHMARK_SEED 12345
+#define BENCHMARK_PROB 0.999
+
+/* The sieve rejects the numbers divisible by primes_table (up to 17389), that is, also those primes, so
+   the candidates must be bigger: 16 bits numbers with the highest bit set are at least 32768 */
+#define BENCHMARK_MIN_BITS 16
+
+/* Sizes of the benchmark when -b is not given */
+static const int benchmark_sizes[] = {64, 128, 256, 512, 1024, 2048};
+#define NUM_BENCHMARK_SIZES 6
 
 /**
  * @brief Check the arguments of the program
@@ -20,9 +35,56 @@
  * @param prob probability of the number being prime
  * @param iterations number of primes to generate
  * @param file_out output file to print results
+ * @param primes_out binary file where the primes are written
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], int *size, double *prob, int *iterations, char **file_out, char **primes_out);
+
+/**
+ * @brief Check the arguments of the read mode
+ * 
+ * @param argc number of arguments
+ * @param argv arguments (argv[1] is "read")
+ * @param primes_in binary file of primes
+ * @param prob probability of the numbers being prime in the test
+ * @param file_out output file to print results
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_read_args(int argc, char *argv[], char **primes_in, double *prob, char **file_out);
+
+/**
+ * @brief Loads the primes of a binary file written with -w and tests them with Miller-Rabin, printing the
+ *        time spent loading and testing
+ * 
+ * @param primes_in binary file of primes
+ * @param prob probability of the numbers being prime in the test
+ * @return int 0 if the whole file was read, -1 otherwise
+ */
+int read_prime_file(char *primes_in, double prob);
+
+/**
+ * @brief Check the arguments of the benchmark mode
+ * 
+ * @param argc number of arguments
+ * @param argv arguments (argv[1] is "benchmark")
+ * @param size size of the primes (0 for all the sizes of the benchmark)
+ * @param prob probability of the numbers being prime
+ * @param samples primes generated per size
+ * @param file_out output file to print results
  * @return int 0 if the arguments are correct, -1 otherwise
  */
-int check_args(int argc, char *argv[], int *size, double *prob, int *iterations, char **file_out);
+int check_benchmark_args(int argc, char *argv[], int *size, double *prob, int *samples, char **file_out);
+
+/**
+ * @brief Generates samples primes of the given size, the sample i always starting from the seed
+ *        BENCHMARK_SEED + i, and prints a line with the distribution of the time and of the candidates
+ *        tested, and the time spent in the trial division and in Miller-Rabin
+ * 
+ * @param size size of the primes
+ * @param prob probability of the numbers being prime
+ * @param samples primes to generate
+ */
+void benchmark_prime_generation(int size, double prob, int samples);
 
 /**
  * @brief Print the help of the program
@@ -37,14 +99,61 @@ int main(int argc, char *argv[])
     mpz_t prime;
     double prob, acumulative_time=0;
     int iterations = 0;
-    char *file_out = NULL;
+    char *file_out = NULL, *primes_out = NULL;
+    mpz_file_writer writer;
 
-    mpz_init(prime);
+    STATS_PRINT_AT_EXIT();
+
+    if (argc >= 2 && strcmp(argv[1], "read") == 0) {
+        char *primes_in = NULL;
+
+        prob = BENCHMARK_PROB;
+        if (check_read_args(argc, argv, &primes_in, &prob, &file_out) == -1) {
+            printf("Error in the arguments\n");
+            print_help();
+            return -1;
+        }
 
-    srand(time(NULL));
+        if(file_out != NULL) {
+            freopen(file_out, "w", stdout);
+        }
 
-    if (check_args(argc, argv, &size, &prob, &iterations, &file_out) == -1){
+        return read_prime_file(primes_in, prob);
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "benchmark") == 0) {
+        int samples = BENCHMARK_SAMPLES;
+
+        size = 0;
+        prob = BENCHMARK_PROB;
+        if (check_benchmark_args(argc, argv, &size, &prob, &samples, &file_out) == -1) {
+            printf("Error in the arguments\n");
+            print_help();
+            return -1;
+        }
+
+        if(file_out != NULL) {
+            freopen(file_out, "w", stdout);
+        }
+
+        printf("# Bits Samples Rounds Mean(s) Median(s) Stddev(s) P90(s) P99(s) Max(s) Candidates(mean) Candidates(median) MR_tests(mean) Sieve(s) MR(s)\n");
+
+        if (size != 0) {
+            benchmark_prime_generation(size, prob, samples);
+        } else {
+            for (int i = 0; i < NUM_BENCHMARK_SIZES; i++) {
+                benchmark_prime_generation(benchmark_sizes[i], prob, samples);
+            }
+        }
+
+        return 0;
+    }
+
+    mpz_init(prime);
+
+    if (check_args(argc, argv, &size, &prob, &iterations, &file_out, &primes_out) == -1){
         printf("Error in the arguments\n");
+        mpz_clear(prime);
         return -1;
     }
 
@@ -52,6 +161,11 @@ int main(int argc, char *argv[])
         freopen(file_out, "w", stdout);
     }
 
+    if(primes_out != NULL && mpz_file_writer_open(&writer, primes_out, MPZ_FILE_PRIMES, 1) != 0) {
+        mpz_clear(prime);
+        return -1;
+    }
+
     int rounds = 0;
     rounds = calculate_rounds(size, prob);
 
@@ -78,18 +192,28 @@ int main(int argc, char *argv[])
 
         acumulative_time += (double)(end - start) / CLOCKS_PER_SEC;
 
+        if(primes_out != NULL && mpz_file_write(&writer, prime) != 0) {
+            printf("Error writing the prime to %s\n", primes_out);
+            mpz_file_writer_close(&writer);
+            primes_out = NULL;
+        }
+
     }
 
     printf("Average time: %lf\n", acumulative_time/iterations);
 
+    if(primes_out != NULL && mpz_file_writer_close(&writer) != 0) {
+        printf("Error writing the primes to %s\n", primes_out);
+    }
+
     mpz_clear(prime);
 
     return 0;
 }
 
-int check_args(int argc, char *argv[], int *size, double *prob, int *iterations, char **file_out)
+int check_args(int argc, char *argv[], int *size, double *prob, int *iterations, char **file_out, char **primes_out)
 {
-    if (argc != 7 && argc != 9){
+    if (argc != 7 && argc != 9 && argc != 11){
         print_help();
         return -1;
     }
@@ -137,10 +261,14 @@ int check_args(int argc, char *argv[], int *size, double *prob, int *iterations,
         return -1;
     }
 
-    if(argc == 9) {
-        if (strcmp(argv[7], "-o") == 0)
+    for (int i = 7; i < argc; i += 2) {
+        if (strcmp(argv[i], "-o") == 0)
         {
-            *file_out = argv[8];
+            *file_out = argv[i+1];
+        }
+        else if (strcmp(argv[i], "-w") == 0)
+        {
+            *primes_out = argv[i+1];
         }
         else
         {
@@ -152,6 +280,180 @@ int check_args(int argc, char *argv[], int *size, double *prob, int *iterations,
     return 0;
 }
 
+void benchmark_prime_generation(int size, double prob, int samples)
+{
+    mpz_t prime;
+    gmp_randstate_t state;
+    prime_search_info info;
+    bench_stats time_stats, candidate_stats;
+    double *times, *candidates, start, mr_tests = 0, sieve_time = 0, mr_time = 0;
+    int rounds = calculate_rounds(size, prob);
+
+    times = (double *)malloc(samples * sizeof(double));
+    candidates = (double *)malloc(samples * sizeof(double));
+    if (times == NULL || candidates == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    mpz_init(prime);
+    gmp_randinit_default(state);
+
+    for (int i = 0; i < samples; i++) {
+        gmp_randseed_ui(state, BENCHMARK_SEED + i);
+
+        start = get_wall_time();
+        generate_prime_number_info(size, rounds, prime, state, &info);
+        times[i] = get_wall_time() - start;
+
+        candidates[i] = info.candidates;
+        mr_tests += info.mr_tests;
+        sieve_time += info.sieve_time;
+        mr_time += info.mr_time;
+    }
+
+    bench_compute_stats(times, samples, 1, &time_stats);
+    bench_compute_stats(candidates, samples, 1, &candidate_stats);
+
+    printf("%d %d %d %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf\n", size, samples, rounds, time_stats.mean,
+           time_stats.median, time_stats.stddev, time_stats.p90, time_stats.p99, time_stats.max,
+           candidate_stats.mean, candidate_stats.median, mr_tests / samples, sieve_time / samples, mr_time / samples);
+    fflush(stdout);
+
+    gmp_randclear(state);
+    mpz_clear(prime);
+    free(times);
+    free(candidates);
+}
+
+int check_benchmark_args(int argc, char *argv[], int *size, double *prob, int *samples, char **file_out)
+{
+    if (argc % 2 != 0 || argc > 10) {
+        return -1;
+    }
+
+    for (int i = 2; i < argc; i += 2) {
+        if (strcmp(argv[i], "-b") == 0) {
+            *size = atoi(argv[i+1]);
+            if (*size < BENCHMARK_MIN_BITS) {
+                printf("Size must be at least %d bits\n", BENCHMARK_MIN_BITS);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-p") == 0) {
+            *prob = strtod(argv[i+1], NULL);
+            if (*prob < 0 || *prob > 1) {
+                printf("Probability must be between 0 and 1\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-n") == 0) {
+            *samples = atoi(argv[i+1]);
+            if (*samples <= 0) {
+                printf("Samples must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int check_read_args(int argc, char *argv[], char **primes_in, double *prob, char **file_out)
+{
+    if (argc % 2 != 0 || argc > 8) {
+        return -1;
+    }
+
+    for (int i = 2; i < argc; i += 2) {
+        if (strcmp(argv[i], "-f") == 0) {
+            *primes_in = argv[i+1];
+        } else if (strcmp(argv[i], "-p") == 0) {
+            *prob = strtod(argv[i+1], NULL);
+            if (*prob < 0 || *prob > 1) {
+                printf("Probability must be between 0 and 1\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    if (*primes_in == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int read_prime_file(char *primes_in, double prob)
+{
+    mpz_file_reader reader;
+    mpz_t prime;
+    int result;
+    long long primes = 0, passed = 0;
+    size_t bits, min_bits = 0, max_bits = 0;
+    double start, load_time = 0, test_time = 0;
+
+    start = get_wall_time();
+    if (mpz_file_reader_open(&reader, primes_in) != 0) {
+        return -1;
+    }
+    if (reader.kind != MPZ_FILE_PRIMES || reader.fields != 1) {
+        printf("%s is not a file of primes\n", primes_in);
+        mpz_file_reader_close(&reader);
+        return -1;
+    }
+    load_time += get_wall_time() - start;
+
+    mpz_init(prime);
+
+    for (;;) {
+        start = get_wall_time();
+        result = mpz_file_read(&reader, prime);
+        load_time += get_wall_time() - start;
+        if (result != 1) {
+            break;
+        }
+
+        bits = mpz_sizeinbase(prime, 2);
+        if (primes == 0 || bits < min_bits) {
+            min_bits = bits;
+        }
+        if (bits > max_bits) {
+            max_bits = bits;
+        }
+        primes++;
+
+        /* test_miller_rabin needs an odd number greater than 3, and returns -1 for composites */
+        start = get_wall_time();
+        if ((mpz_cmp_ui(prime, 2) == 0 || mpz_cmp_ui(prime, 3) == 0) ||
+            (mpz_odd_p(prime) && mpz_cmp_ui(prime, 3) > 0 && test_miller_rabin(prime, calculate_rounds((int)bits, prob)) == 1)) {
+            passed++;
+        }
+        test_time += get_wall_time() - start;
+    }
+
+    if (result == -1) {
+        printf("Error reading the prime %lld of %s\n", primes + 1, primes_in);
+    }
+
+    printf("Primes: %lld (%lu to %lu bits), pass the Miller-Rabin test: %lld\n", primes,
+           (unsigned long)min_bits, (unsigned long)max_bits, passed);
+    printf("Load time: %lf, test time: %lf\n", load_time, test_time);
+
+    mpz_clear(prime);
+    mpz_file_reader_close(&reader);
+
+    return result == -1 ? -1 : 0;
+}
+
 void print_help() {
-    printf("Usage: primo -b <size> -p <probability> -i <iterations> [-o <file_name>]\n");
+    printf("Usage: primo -b <size> -p <probability> -i <iterations> [-o <file_name>] [-w <primes_file>]\n");
+    printf("       primo benchmark [-b <size>] [-p <probability>] [-n <samples>] [-o <file_name>]\n");
+    printf("       primo read -f <primes_file> [-p <probability>] [-o <file_name>]\n");
 }
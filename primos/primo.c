@@ -10,34 +10,74 @@
  */
 
 #include "primo.h"
+#include "../utiles/stats.h"
+#include "../utiles/prng.h"
 
 void generate_prime_number(int size, int rounds, mpz_t prime)
 {
-    int found = 0;
-    char *str;
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    prng_seed_gmp(state);
+
+    generate_prime_number_state(size, rounds, prime, state);
+
+    gmp_randclear(state);
+}
+
+void generate_prime_number_state(int size, int rounds, mpz_t prime, gmp_randstate_t state)
+{
+    generate_prime_number_info(size, rounds, prime, state, NULL);
+}
+
+void generate_prime_number_info(int size, int rounds, mpz_t prime, gmp_randstate_t state, prime_search_info *info)
+{
+    int found = 0, divisible, result;
+    double start = 0;
     
     mpz_t number;
     mpz_init(number);
 
-    /* Create random number */
-    str = malloc((size+1) * sizeof(char));
-    str[0] = '1';
-    for (int i = 1; i < size-1; i++)
-    {
-        str[i] = random_num(0, 1) + '0';
+    STATS_INC(STATS_PRIME_CALLS);
+    STATS_TIMER_START(prime_start);
+
+    /* Create random odd number with the highest bit set */
+    mpz_urandomb(number, state, size);
+    mpz_setbit(number, size-1);
+    mpz_setbit(number, 0);
+
+    if(info != NULL) {
+        memset(info, 0, sizeof(prime_search_info));
     }
-    str[size-1] = '1';
-    str[size] = '\0';
-    mpz_set_str(number, str, 2);
 
     /* Loop until find the prime number */
     while (!found)
     {
-        if(check_divisibility_first_primes(number) == 0) {
+        STATS_INC(STATS_PRIME_CANDIDATES);
+
+        if(info != NULL) {
+            info->candidates++;
+            start = get_wall_time();
+        }
+        divisible = check_divisibility_first_primes(number) == 0;
+        if(info != NULL) {
+            info->sieve_time += get_wall_time() - start;
+        }
+
+        if(divisible) {
             mpz_add_ui(number, number, 2);
+            continue;
+        }
+
+        if(info != NULL) {
+            info->mr_tests++;
+            start = get_wall_time();
+        }
+        result = test_miller_rabin_state(number, rounds, state);
+        if(info != NULL) {
+            info->mr_time += get_wall_time() - start;
         }
 
-        else if (test_miller_rabin(number, rounds) > 0)
+        if (result > 0)
         {
             found = 1;
         }
@@ -47,13 +87,26 @@ void generate_prime_number(int size, int rounds, mpz_t prime)
         }
     }
 
-    free(str);
+    STATS_TIMER_STOP(STATS_TIME_PRIME, prime_start);
 
     mpz_set(prime, number);
     mpz_clear(number);
 }
 
 int test_miller_rabin(mpz_t number, int rounds)
+{
+    int result;
+    gmp_randstate_t state;
+    gmp_randinit_default(state);
+    prng_seed_gmp(state);
+
+    result = test_miller_rabin_state(number, rounds, state);
+
+    gmp_randclear(state);
+    return result;
+}
+
+int test_miller_rabin_state(mpz_t number, int rounds, gmp_randstate_t state)
 {
 
     mpz_t d;
@@ -68,6 +121,9 @@ int test_miller_rabin(mpz_t number, int rounds)
     mpz_init(two);
     mpz_init(number_minus_1);
 
+    STATS_INC(STATS_MR_CALLS);
+    STATS_TIMER_START(mr_start);
+
     /* Discompose number in 2^n*d + 1 */
     mpz_set(number_minus_1, number);
     mpz_sub_ui(number_minus_1, number_minus_1, 1);
@@ -83,7 +139,8 @@ int test_miller_rabin(mpz_t number, int rounds)
 
     /* Test if number is prime */
     for(int i=0; i<rounds; i++) {
-        generate_testigue(a, number); // Generate random testigue
+        generate_testigue_state(a, number, state); // Generate random testigue
+        STATS_INC(STATS_MR_ROUNDS);
 
         /* Test if a^d mod number == 1  or -1*/
         potencia_modular(aux, a, d, number);
@@ -97,6 +154,8 @@ int test_miller_rabin(mpz_t number, int rounds)
             potencia_modular(aux, a, d, number);
 
             if(mpz_cmp_ui(aux, 1) == 0) {
+                STATS_INC(STATS_MR_COMPOSITES);
+                STATS_TIMER_STOP(STATS_TIME_MR, mr_start);
                 mpz_clear(d);
                 mpz_clear(a);
                 mpz_clear(aux);
@@ -111,6 +170,8 @@ int test_miller_rabin(mpz_t number, int rounds)
 
             /* If last iteration, and algorithm didn't answer yet, is composite */
             if(ii == s-1) {
+                STATS_INC(STATS_MR_COMPOSITES);
+                STATS_TIMER_STOP(STATS_TIME_MR, mr_start);
                 mpz_clear(d);
                 mpz_clear(a);
                 mpz_clear(aux);
@@ -121,6 +182,8 @@ int test_miller_rabin(mpz_t number, int rounds)
         }
     }
 
+    STATS_TIMER_STOP(STATS_TIME_MR, mr_start);
+
     mpz_clear(d);
     mpz_clear(a);
     mpz_clear(aux);
@@ -153,12 +216,20 @@ void generate_testigue(mpz_t a, mpz_t number) {
    
     /* Random a testigue method */
     
-    mpz_t aux;
     gmp_randstate_t state;
     gmp_randinit_default(state);
 
-    gmp_randseed_ui(state, rand());
+    prng_seed_gmp(state);
 
+    generate_testigue_state(a, number, state);
+
+    gmp_randclear(state);
+
+}
+
+void generate_testigue_state(mpz_t a, mpz_t number, gmp_randstate_t state) {
+
+    mpz_t aux;
     mpz_init(aux);
 
     mpz_sub_ui(aux, number, 2);
@@ -168,17 +239,25 @@ void generate_testigue(mpz_t a, mpz_t number) {
     mpz_add_ui(a, a, 2);
 
     mpz_clear(aux);
-    gmp_randclear(state);
 
 }
 
 int check_divisibility_first_primes(mpz_t number){
 
+    STATS_INC(STATS_SIEVE_CALLS);
+    STATS_TIMER_START(sieve_start);
+
     for(int i=0; i<PRIME_LIST_SIZE; i++) {
         if(mpz_divisible_ui_p(number, primes_table[i])) {
+            STATS_INC(STATS_SIEVE_REJECTED);
+            STATS_ADD(STATS_SIEVE_DIVISIONS, i + 1);
+            STATS_TIMER_STOP(STATS_TIME_SIEVE, sieve_start);
             return 0;
         }
     }
 
+    STATS_ADD(STATS_SIEVE_DIVISIONS, PRIME_LIST_SIZE);
+    STATS_TIMER_STOP(STATS_TIME_SIEVE, sieve_start);
+
     return -1;
 }
@@ -103,6 +103,16 @@ static const unsigned short primes_table[PRIME_LIST_SIZE] = {2, 3, 5, 7, 11, 13,
 17021, 17027, 17029, 17033, 17041, 17047, 17053, 17077, 17093, 17099, 17107, 17117, 17123, 17137, 17159, 17167, 17183, 17189, 17191, 17203, 17207,
 17209, 17231, 17239, 17257, 17291, 17293, 17299, 17317, 17321, 17327, 17333, 17341, 17351, 17359, 17377, 17383, 17387, 17389};
 
+/**
+ * @brief Cost of one prime search, split between the trial division by the first primes and Miller-Rabin
+ */
+typedef struct {
+    unsigned long candidates;   /* Odd numbers tested */
+    unsigned long mr_tests;     /* Candidates that passed the trial division and reached Miller-Rabin */
+    double sieve_time;          /* Seconds spent in check_divisibility_first_primes */
+    double mr_time;             /* Seconds spent in test_miller_rabin */
+} prime_search_info;
+
 /**
  * @brief Generate a prime number of a given size
  * 
@@ -112,6 +122,28 @@ static const unsigned short primes_table[PRIME_LIST_SIZE] = {2, 3, 5, 7, 11, 13,
  */
 void generate_prime_number(int size, int rounds, mpz_t prime);
 
+/**
+ * @brief Generate a prime number of a given size using the given random state. As it does not touch
+ *        any shared state it can be called from several threads at the same time, each one with its own state
+ * 
+ * @param size size of the prime number
+ * @param rounds number of rounds for the Miller-Rabin test
+ * @param prime (return) the prime number generated
+ * @param state random state used for the candidate and the testigues
+ */
+void generate_prime_number_state(int size, int rounds, mpz_t prime, gmp_randstate_t state);
+
+/**
+ * @brief Same as generate_prime_number_state, but also returns the cost of the search
+ * 
+ * @param size size of the prime number
+ * @param rounds number of rounds for the Miller-Rabin test
+ * @param prime (return) the prime number generated
+ * @param state random state used for the candidate and the testigues
+ * @param info (return) candidates tested and time of each phase (NULL to not measure anything)
+ */
+void generate_prime_number_info(int size, int rounds, mpz_t prime, gmp_randstate_t state, prime_search_info *info);
+
 /**
  * @brief Test if a number is prime using the Miller-Rabin test
  * 
@@ -121,6 +153,16 @@ void generate_prime_number(int size, int rounds, mpz_t prime);
  */
 int test_miller_rabin(mpz_t number, int rounds);
 
+/**
+ * @brief Test if a number is prime using the Miller-Rabin test, taking the testigues from the given random state
+ * 
+ * @param number number to test
+ * @param rounds number of rounds
+ * @param state random state used for the testigues
+ * @return int 1 if the number is potentially prime, 0 otherwise
+ */
+int test_miller_rabin_state(mpz_t number, int rounds, gmp_randstate_t state);
+
 /**
  * @brief Calculate the number of rounds for the Miller-Rabin test for a given size and probability
  * 
@@ -138,6 +180,15 @@ int calculate_rounds(int size, double prob);
  */
 void generate_testigue(mpz_t a, mpz_t number);
 
+/**
+ * @brief generates a random testigue a in [2, number-1] using the given random state
+ * 
+ * @param a testigue (return)
+ * @param number number to test primality
+ * @param state random state
+ */
+void generate_testigue_state(mpz_t a, mpz_t number, gmp_randstate_t state);
+
 /**
  * @brief Check if a number is divisible by the first 2000 prime numbers
  * 
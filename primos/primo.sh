@@ -1,31 +1,16 @@
-# File that will execute the prime number generator program with differents parameters and 
+# File that will execute the benchmark mode of the prime number generator and 
 # will store the results in a file called "primos.txt" in the data folder.
+# Every size generates the same primes in every run (fixed seed schedule), so the 
+# results of two versions of the code can be compared.
 
 # Create the data folder if it doesn't exist
 mkdir -p data
 
-# Table with the sizes of the prime numbers to generate
-initial_size=8
-final_size=2048
-number_muestras=20
-step_size=$((($final_size - $initial_size)/$number_muestras))
-
-iterations=1
+samples=30
 probabilidad=0.999
 
 file="data/primos.txt"
-output="data/output.txt"
-
-# Remove the file if it already exists
-rm -f $file
-
-# Generate the prime numbers and store the results in the file
-for ((i=$initial_size; i<=$final_size; i+=$step_size))
-do
-    echo "Generating prime numbers with size $i"
-    ./primos/primo -b $i -p $probabilidad -i $iterations -o $output
 
-    # Last line of output will be: "Average time: X", take that time and store it in the file
-    time=$(tail -n 1 $output | cut -d ' ' -f 3)
-    echo "$i $time" >> $file
-done
\ No newline at end of file
+# One line per size, columns: Bits Samples Rounds Mean(s) Median(s) Stddev(s) P90(s) P99(s) Max(s)
+# Candidates(mean) Candidates(median) MR_tests(mean) Sieve(s) MR(s) (header line starts with #)
+./primos/prime_generator benchmark -p $probabilidad -n $samples -o $file
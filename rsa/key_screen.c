@@ -0,0 +1,153 @@
+/**
+ * @file key_screen.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Program that screens a file of RSA keys looking for weak keys: p and q too close (Fermat method)
+ *        and small private exponent (Wiener attack)
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "../utiles/utils.h"
+#include "rsa.h"
+
+/* Maximum length of a line of the key file (two 8192 bits numbers in decimal fit) */
+#define KEY_LINE_SIZE 16384
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param file_in file with the keys, one key per line: modulus n and optionally public exponent e, in decimal
+ * @param iterations iterations of the Fermat method for each key
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], char **file_in, unsigned long *iterations, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+int main(int argc, char *argv[]) {
+
+    char *file_in = NULL, *file_out = NULL;
+    char *line;
+    unsigned long iterations = FERMAT_DEFAULT_ITERATIONS;
+    int keys = 0, weak_keys = 0, read;
+    FILE *input;
+    mpz_t n, e, d, p, q;
+
+    if(check_args(argc, argv, &file_in, &iterations, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    input = fopen(file_in, "r");
+    if(input == NULL) {
+        printf("Error opening the key file\n");
+        return -1;
+    }
+
+    if(file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    line = malloc(KEY_LINE_SIZE * sizeof(char));
+    if(line == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        fclose(input);
+        return -1;
+    }
+
+    mpz_init(n);
+    mpz_init(e);
+    mpz_init(d);
+    mpz_init(p);
+    mpz_init(q);
+
+    clock_t start = clock();
+
+    while(fgets(line, KEY_LINE_SIZE, input) != NULL) {
+
+        /* Skip empty lines and comments */
+        if(line[0] == '\n' || line[0] == '#') {
+            continue;
+        }
+
+        read = gmp_sscanf(line, "%Zd %Zd", n, e);
+        if(read < 1 || mpz_cmp_ui(n, 3) < 0) {
+            printf("Key %d: invalid modulus, skipped\n", keys + 1);
+            continue;
+        }
+
+        keys++;
+
+        if(fermat_factor(n, iterations, p, q) == 1) {
+            weak_keys++;
+            gmp_printf("Key %d: WEAK (Fermat)\np: %Zd\nq: %Zd\n", keys, p, q);
+        } else if(read == 2 && wiener_attack(e, n, d, p, q) == 1) {
+            weak_keys++;
+            gmp_printf("Key %d: WEAK (Wiener)\nd: %Zd\np: %Zd\nq: %Zd\n", keys, d, p, q);
+        } else {
+            printf("Key %d: passed\n", keys);
+        }
+    }
+
+    clock_t end = clock();
+
+    printf("Keys screened: %d\nWeak keys: %d\n", keys, weak_keys);
+    printf("Time: %lf\n", (double)(end - start) / CLOCKS_PER_SEC);
+
+    fclose(input);
+    free(line);
+    mpz_clear(n);
+    mpz_clear(e);
+    mpz_clear(d);
+    mpz_clear(p);
+    mpz_clear(q);
+
+    return 0;
+}
+
+int check_args(int argc, char *argv[], char **file_in, unsigned long *iterations, char **file_out) {
+    if (argc != 3 && argc != 5 && argc != 7) {
+        return -1;
+    }
+
+    if (strcmp(argv[1], "-i") == 0) {
+        *file_in = argv[2];
+    } else {
+        return -1;
+    }
+
+    for (int i = 3; i < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) {
+            if (atol(argv[i+1]) <= 0) {
+                printf("Iterations must be greater than 0\n");
+                return -1;
+            }
+            *iterations = strtoul(argv[i+1], NULL, 10);
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./key_screen -i <key_file> [-n <iterations>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -i <key_file>      File with one key per line: n [e] (decimal)\n");
+    printf("  -n <iterations>    Iterations of the Fermat method per key (default %d)\n", FERMAT_DEFAULT_ITERATIONS);
+    printf("  -o <output_file>   Output file\n");
+}
@@ -10,6 +10,9 @@
  */
 
 #include "rsa.h"
+#include "../utiles/stats.h"
+#include "../utiles/prng.h"
+#include "../utiles/powm_cache.h"
 
 
 void generate_euler_f(mpz_t p, mpz_t q, mpz_t euler_f){
@@ -52,3 +55,776 @@ int generate_d(mpz_t e, mpz_t euler_f, mpz_t d){
 
     return 0;
 }
+
+void vegas_attack(mpz_t d, mpz_t n, mpz_t mod, mpz_t p, mpz_t q) {
+
+    mpz_t e, ed, n_1, two, m, aux, pre_aux, w, mod_p;
+    int s = 0, found = 0;
+
+    STATS_INC(STATS_VEGAS_CALLS);
+    STATS_TIMER_START(vegas_start);
+
+    mpz_init(e);
+    mpz_init(ed);
+    mpz_init(n_1);
+    mpz_init_set_ui(two, 2);
+    mpz_init(m);
+    mpz_init(aux);
+    mpz_init(pre_aux);
+    mpz_init(w);
+    mpz_init(mod_p);
+
+    /* Calculate e (implicit data)*/
+    if( generate_d(d, mod, e) == -1) {
+        printf("Error generating e\n");
+        goto clear;
+    }
+
+    mpz_mul(ed, e, d);
+    mpz_sub_ui(m, ed, 1);
+    mpz_sub_ui(n_1, n, 1);
+
+    while (mpz_even_p(m))
+    {
+        mpz_fdiv_q_2exp(m, m, 1);
+        s++;
+    }
+
+    /* Test if number is prime */
+    while(found==0) {
+
+        generate_testigue(w, n); // Generate random testigue
+        STATS_INC(STATS_VEGAS_WITNESSES);
+        
+        /* Test if a^m mod number == 1  or -1*/
+        potencia_modular_cached(aux, w, m, n);
+
+        if(mpz_cmp_ui(aux, 1) == 0 || mpz_cmp(aux, n_1) == 0) {
+            continue; // can't answer, continue with next round
+        }
+
+        /* For every 2^d*s */
+        for(int ii=0; ii<s; ii++) {
+            mpz_set(pre_aux, aux);
+            mpz_mul_ui(m, m, 2);
+            potencia_modular_cached(aux, w, m, n);
+
+            if(mpz_cmp_ui(aux, 1) == 0) {
+                mpz_sub_ui(pre_aux, pre_aux, 1);
+                euclides_mcd(pre_aux, n, p);
+                found = 1;
+                break; // Found p 
+            }
+
+            if(mpz_cmp(aux, n_1) == 0) {
+                break; // don't answer, might be prime. Continue with next round
+            }
+
+            /* If last iteration, and algorithm didn't answer yet, is composite */
+            if(ii == s-1) {
+                mpz_sub_ui(pre_aux, pre_aux, 1);
+                euclides_mcd(pre_aux, n, p);
+                found = 1;
+                break; // Found p
+            }
+        }
+    }
+
+    if(found == 0) {
+        printf("Error, couldn't find p\n");
+        goto clear;
+    }
+
+    /* Verify the test worked mod%p = 0*/
+    mpz_mod(mod_p, n, p);
+
+    if(mpz_cmp_ui(mod_p, 0) != 0) {
+        printf("Error, the test didn't work\n");
+        goto clear;
+    }
+
+    mpz_div(q, n, p);
+
+    /* Every exit goes through here, so the timer of the attack is always stopped */
+clear:
+    STATS_TIMER_STOP(STATS_TIME_VEGAS, vegas_start);
+
+    mpz_clear(e);
+    mpz_clear(ed);
+    mpz_clear(n_1);
+    mpz_clear(two);
+    mpz_clear(m);
+    mpz_clear(aux);
+    mpz_clear(pre_aux);
+    mpz_clear(w);
+    mpz_clear(mod_p);
+}
+
+int fermat_factor(mpz_t n, unsigned long iterations, mpz_t p, mpz_t q) {
+
+    mpz_t a, b, r;
+    unsigned long i;
+    int found = 0;
+
+    if (mpz_even_p(n)) {
+        mpz_set_ui(p, 2);
+        mpz_fdiv_q_2exp(q, n, 1);
+        return 1;
+    }
+
+    mpz_init(a);
+    mpz_init(b);
+    mpz_init(r);
+
+    /* n = a^2 + r with a = floor(sqrt(n)) */
+    mpz_sqrtrem(a, r, n);
+
+    if (mpz_sgn(r) == 0) {
+        mpz_set(p, a);
+        mpz_set(q, a);
+        found = 1;
+    } else {
+        /* Start at a+1: (a+1)^2 - n = 2a + 1 - r */
+        mpz_mul_2exp(b, a, 1);
+        mpz_add_ui(b, b, 1);
+        mpz_sub(r, b, r);
+        mpz_add_ui(a, a, 1);
+
+        for (i = 0; i < iterations; i++) {
+            /* If a^2 - n = b^2, then n = (a-b)*(a+b) */
+            if (mpz_perfect_square_p(r)) {
+                mpz_sqrt(b, r);
+                mpz_sub(p, a, b);
+                mpz_add(q, a, b);
+                /* Trivial factorization n = 1*n means n is prime */
+                found = mpz_cmp_ui(p, 1) != 0;
+                break;
+            }
+
+            /* (a+1)^2 - n = (a^2 - n) + 2a + 1 */
+            mpz_addmul_ui(r, a, 2);
+            mpz_add_ui(r, r, 1);
+            mpz_add_ui(a, a, 1);
+        }
+    }
+
+    mpz_clear(a);
+    mpz_clear(b);
+    mpz_clear(r);
+
+    return found;
+}
+
+int wiener_attack(mpz_t e, mpz_t n, mpz_t d, mpz_t p, mpz_t q) {
+
+    continued_fraction cf;
+    mpz_t phi, s, disc, root, rem;
+    int found = 0;
+
+    mpz_init(phi);
+    mpz_init(s);
+    mpz_init(disc);
+    mpz_init(root);
+    mpz_init(rem);
+
+    continued_fraction_init(&cf, e, n);
+
+    /* Each convergent h/k of e/n is a candidate k/d */
+    while (!found && continued_fraction_next(&cf)) {
+
+        if (mpz_sgn(cf.h) == 0 || mpz_even_p(cf.k)) {
+            continue; // d is odd because e*d = 1 mod phi(n), which is even
+        }
+
+        /* phi = (e*d - 1) / k, must be exact */
+        mpz_mul(phi, e, cf.k);
+        mpz_sub_ui(phi, phi, 1);
+        mpz_tdiv_qr(phi, rem, phi, cf.h);
+        if (mpz_sgn(rem) != 0) {
+            continue;
+        }
+
+        /* p + q = n - phi + 1, (q - p)^2 = (p + q)^2 - 4n */
+        mpz_sub(s, n, phi);
+        mpz_add_ui(s, s, 1);
+        mpz_mul(disc, s, s);
+        mpz_submul_ui(disc, n, 4);
+        if (mpz_sgn(disc) < 0 || !mpz_perfect_square_p(disc)) {
+            continue;
+        }
+        mpz_sqrt(root, disc);
+
+        mpz_sub(p, s, root);
+        mpz_fdiv_q_2exp(p, p, 1);
+        mpz_add(q, s, root);
+        mpz_fdiv_q_2exp(q, q, 1);
+
+        mpz_mul(rem, p, q);
+        if (mpz_cmp(rem, n) == 0) {
+            mpz_set(d, cf.k);
+            found = 1;
+        }
+    }
+
+    continued_fraction_clear(&cf);
+    mpz_clear(phi);
+    mpz_clear(s);
+    mpz_clear(disc);
+    mpz_clear(root);
+    mpz_clear(rem);
+
+    return found;
+}
+
+int check_private_exponent(mpz_t e, mpz_t d, mpz_t n) {
+
+    mpz_t aux, guess_d, guess_p, guess_q;
+    int result = 0;
+
+    mpz_init(aux);
+
+    /* d^4 < n  <=>  d < n^0.25 */
+    mpz_pow_ui(aux, d, 4);
+    if (mpz_cmp(aux, n) < 0) {
+        mpz_clear(aux);
+        return -1;
+    }
+    mpz_clear(aux);
+
+    mpz_init(guess_d);
+    mpz_init(guess_p);
+    mpz_init(guess_q);
+
+    if (wiener_attack(e, n, guess_d, guess_p, guess_q) == 1) {
+        result = -1;
+    }
+
+    mpz_clear(guess_d);
+    mpz_clear(guess_p);
+    mpz_clear(guess_q);
+
+    return result;
+}
+
+/* Arguments of the thread that generates one of the primes of the key */
+typedef struct {
+    int size;               /* Size of the prime */
+    uint64_t seed[4];       /* Seed of the random state of the thread */
+    mpz_ptr prime;          /* (return) prime generated */
+    double time;            /* (return) time spent */
+} prime_thread_args;
+
+/* Fills the seed of a prime thread from the secure generator (prng_next if the system gives no entropy) */
+static void prime_thread_seed(prime_thread_args *args) {
+    if (prng_secure_fill(args->seed, sizeof(args->seed)) != 0) {
+        for (int i = 0; i < 4; i++) {
+            args->seed[i] = prng_next();
+        }
+    }
+}
+
+/* Generates a prime with its own random state, so it can run alongside other threads */
+static void *prime_thread(void *arg) {
+
+    prime_thread_args *args = (prime_thread_args *)arg;
+    gmp_randstate_t state;
+    mpz_t seed;
+    double start = get_wall_time();
+
+    gmp_randinit_default(state);
+    mpz_init(seed);
+    mpz_import(seed, 4, 1, sizeof(uint64_t), 0, 0, args->seed);
+    gmp_randseed(state, seed);
+    mpz_clear(seed);
+
+    generate_prime_number_state(args->size, RSA_MR_ROUNDS, args->prime, state);
+
+    gmp_randclear(state);
+
+    args->time = get_wall_time() - start;
+
+    return NULL;
+}
+
+void rsa_key_init(rsa_key *key) {
+    mpz_init(key->n);
+    mpz_init(key->e);
+    mpz_init(key->d);
+    mpz_init(key->p);
+    mpz_init(key->q);
+    mpz_init(key->euler_f);
+    mpz_init(key->dp);
+    mpz_init(key->dq);
+    mpz_init(key->qinv);
+    memset(&key->times, 0, sizeof(rsa_keygen_times));
+}
+
+void rsa_key_clear(rsa_key *key) {
+    mpz_clear(key->n);
+    mpz_clear(key->e);
+    mpz_clear(key->d);
+    mpz_clear(key->p);
+    mpz_clear(key->q);
+    mpz_clear(key->euler_f);
+    mpz_clear(key->dp);
+    mpz_clear(key->dq);
+    mpz_clear(key->qinv);
+}
+
+int rsa_keygen(int bits, unsigned long e, rsa_key *key) {
+
+    prime_thread_args args_p, args_q;
+    pthread_t thread_p;
+    mpz_t aux_p, aux_q;
+    double start, phase;
+    int valid = 0;
+    unsigned long fermat_iterations;
+
+    /* Smaller primes would be rejected by check_divisibility_first_primes */
+    if (bits < 32) {
+        return -1;
+    }
+
+    /* k iterations of Fermat find p and q when |p-q| < ~sqrt(8k)*n^(1/4). With small moduli the default
+       catches every key, so the screen is scaled to 2^(bits/8) iterations until it reaches the default */
+    fermat_iterations = bits / 8 < 14 ? 1UL << (bits / 8) : FERMAT_DEFAULT_ITERATIONS;
+    if (fermat_iterations > FERMAT_DEFAULT_ITERATIONS) {
+        fermat_iterations = FERMAT_DEFAULT_ITERATIONS;
+    }
+
+    memset(&key->times, 0, sizeof(rsa_keygen_times));
+
+    mpz_init(aux_p);
+    mpz_init(aux_q);
+
+    start = get_wall_time();
+
+    while (!valid) {
+
+        /* Generate p in a new thread while this one generates q */
+        args_p.size = (bits + 1) / 2;
+        prime_thread_seed(&args_p);
+        args_p.prime = key->p;
+
+        args_q.size = bits / 2;
+        prime_thread_seed(&args_q);
+        args_q.prime = key->q;
+
+        phase = get_wall_time();
+
+        if (pthread_create(&thread_p, NULL, prime_thread, &args_p) != 0) {
+            printf("Error creating the thread of p\n");
+            mpz_clear(aux_p);
+            mpz_clear(aux_q);
+            return -1;
+        }
+        prime_thread(&args_q);
+        pthread_join(thread_p, NULL);
+
+        key->times.p += args_p.time;
+        key->times.q += args_q.time;
+        key->times.primes += get_wall_time() - phase;
+
+        /* Derive the rest of the key */
+        phase = get_wall_time();
+
+        mpz_mul(key->n, key->p, key->q);
+
+        /* Fermat screen: p and q must not be close */
+        if (mpz_cmp(key->p, key->q) == 0 || fermat_factor(key->n, fermat_iterations, aux_p, aux_q) == 1) {
+            key->times.derive += get_wall_time() - phase;
+            continue;
+        }
+
+        generate_euler_f(key->p, key->q, key->euler_f);
+
+        if (e == 0) {
+            /* Random e, generate it again until d is not small */
+            do {
+                generate_e(key->euler_f, key->e);
+                if (generate_d(key->e, key->euler_f, key->d) == -1) {
+                    mpz_clear(aux_p);
+                    mpz_clear(aux_q);
+                    return -1;
+                }
+            } while (check_private_exponent(key->e, key->d, key->n) == -1);
+            valid = 1;
+        } else {
+            /* Fixed e, the primes must be generated again if e is not coprime with the euler function */
+            mpz_set_ui(key->e, e);
+            euclides_mcd(key->e, key->euler_f, aux_p);
+            if (mpz_cmp_ui(aux_p, 1) == 0 && generate_d(key->e, key->euler_f, key->d) == 0) {
+                valid = check_private_exponent(key->e, key->d, key->n) == 0;
+            }
+        }
+
+        if (valid) {
+            rsa_key_set_crt(key);
+        }
+
+        key->times.derive += get_wall_time() - phase;
+    }
+
+    key->times.total = get_wall_time() - start;
+
+    mpz_clear(aux_p);
+    mpz_clear(aux_q);
+
+    return 0;
+}
+
+int rsa_key_set_crt(rsa_key *key) {
+
+    mpz_sub_ui(key->dp, key->p, 1);
+    mpz_mod(key->dp, key->d, key->dp);
+
+    mpz_sub_ui(key->dq, key->q, 1);
+    mpz_mod(key->dq, key->d, key->dq);
+
+    if (mpz_invert(key->qinv, key->q, key->p) == 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int rsa_key_write(mpz_file_writer *writer, rsa_key *key) {
+    mpz_ptr fields[RSA_KEY_FILE_FIELDS] = {key->n, key->e, key->d, key->p, key->q, key->dp, key->dq, key->qinv};
+
+    for (int i = 0; i < RSA_KEY_FILE_FIELDS; i++) {
+        if (mpz_file_write(writer, fields[i]) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int rsa_key_read(mpz_file_reader *reader, rsa_key *key) {
+    mpz_ptr fields[RSA_KEY_FILE_FIELDS] = {key->n, key->e, key->d, key->p, key->q, key->dp, key->dq, key->qinv};
+    int result;
+
+    if (reader->kind != MPZ_FILE_RSA_KEYS || reader->fields != RSA_KEY_FILE_FIELDS) {
+        return -1;
+    }
+
+    for (int i = 0; i < RSA_KEY_FILE_FIELDS; i++) {
+        if ((result = mpz_file_read(reader, fields[i])) != 1) {
+            /* The end of the file is only valid before the first number of a key */
+            return i == 0 ? result : -1;
+        }
+    }
+
+    generate_euler_f(key->p, key->q, key->euler_f);
+    memset(&key->times, 0, sizeof(rsa_keygen_times));
+
+    return 1;
+}
+
+/* Copies x (x >= 0, at most n limbs) into dst as n limbs, filling with zeros */
+static void rsa_limbs(mp_limb_t *dst, const mpz_t x, mp_size_t n) {
+    memset(dst, 0, n * sizeof(mp_limb_t));
+    mpz_export(dst, NULL, -1, sizeof(mp_limb_t), 0, 0, x);
+}
+
+int rsa_batch_init(rsa_batch_ctx *ctx, rsa_key *key) {
+
+    mp_size_t np, nq;
+
+    if (montgomery_init(&ctx->ctx_n, key->n) == -1) {
+        return -1;
+    }
+    if (montgomery_init(&ctx->ctx_p, key->p) == -1) {
+        montgomery_clear(&ctx->ctx_n);
+        return -1;
+    }
+    if (montgomery_init(&ctx->ctx_q, key->q) == -1) {
+        montgomery_clear(&ctx->ctx_n);
+        montgomery_clear(&ctx->ctx_p);
+        return -1;
+    }
+
+    if (montgomery_exp_init(&ctx->exp_e, key->e, 0) == -1) {
+        montgomery_clear(&ctx->ctx_n);
+        montgomery_clear(&ctx->ctx_p);
+        montgomery_clear(&ctx->ctx_q);
+        return -1;
+    }
+    if (montgomery_exp_init(&ctx->exp_dp, key->dp, 0) == -1) {
+        montgomery_exp_clear(&ctx->exp_e);
+        montgomery_clear(&ctx->ctx_n);
+        montgomery_clear(&ctx->ctx_p);
+        montgomery_clear(&ctx->ctx_q);
+        return -1;
+    }
+    if (montgomery_exp_init(&ctx->exp_dq, key->dq, 0) == -1) {
+        montgomery_exp_clear(&ctx->exp_e);
+        montgomery_exp_clear(&ctx->exp_dp);
+        montgomery_clear(&ctx->ctx_n);
+        montgomery_clear(&ctx->ctx_p);
+        montgomery_clear(&ctx->ctx_q);
+        return -1;
+    }
+
+    np = ctx->ctx_p.size;
+    nq = ctx->ctx_q.size;
+    ctx->sec = (mp_limb_t *)malloc((3 * np + 2 * nq) * sizeof(mp_limb_t));
+    if (ctx->sec == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        montgomery_exp_clear(&ctx->exp_e);
+        montgomery_exp_clear(&ctx->exp_dp);
+        montgomery_exp_clear(&ctx->exp_dq);
+        montgomery_clear(&ctx->ctx_n);
+        montgomery_clear(&ctx->ctx_p);
+        montgomery_clear(&ctx->ctx_q);
+        return -1;
+    }
+    rsa_limbs(ctx->sec, key->p, np);
+    rsa_limbs(ctx->sec + np, key->q, nq);
+    rsa_limbs(ctx->sec + np + nq, key->qinv, np);
+    montgomery_ladder_exp(&ctx->ctx_p, ctx->sec + 2 * np + nq, key->dp);
+    montgomery_ladder_exp(&ctx->ctx_q, ctx->sec + 3 * np + nq, key->dq);
+
+    mpz_init_set(ctx->p, key->p);
+    mpz_init_set(ctx->q, key->q);
+    mpz_init_set(ctx->qinv, key->qinv);
+    ctx->constant_time = 0;
+
+    return 0;
+}
+
+void rsa_batch_clear(rsa_batch_ctx *ctx) {
+    montgomery_clear(&ctx->ctx_n);
+    montgomery_clear(&ctx->ctx_p);
+    montgomery_clear(&ctx->ctx_q);
+    montgomery_exp_clear(&ctx->exp_e);
+    montgomery_exp_clear(&ctx->exp_dp);
+    montgomery_exp_clear(&ctx->exp_dq);
+    mpz_clear(ctx->p);
+    mpz_clear(ctx->q);
+    mpz_clear(ctx->qinv);
+    /* The private exponents are not left in memory */
+    memset(ctx->sec, 0, (3 * ctx->ctx_p.size + 2 * ctx->ctx_q.size) * sizeof(mp_limb_t));
+    free(ctx->sec);
+}
+
+#define MAX_ITCH(a, b) ((a) > (b) ? (a) : (b))
+
+/* Limbs of the work area of rsa_decrypt_sec */
+static mp_size_t rsa_decrypt_sec_itch(const rsa_batch_ctx *ctx) {
+    mp_size_t nn = ctx->ctx_n.size, np = ctx->ctx_p.size, nq = ctx->ctx_q.size, nm = MAX_ITCH(np, nq);
+    mp_size_t itch;
+
+    /* Ladder, t (nn, 2np or np+nq limbs), m1 (np), m2 (nq), u (nm) and h (np) */
+    itch = MAX_ITCH(montgomery_ladder_itch(&ctx->ctx_p), montgomery_ladder_itch(&ctx->ctx_q));
+    itch += MAX_ITCH(nn, MAX_ITCH(2 * np, np + nq)) + 2 * np + nq + nm;
+
+    /* Work area of the mpn_sec functions */
+    return itch + MAX_ITCH(MAX_ITCH(mpn_sec_div_r_itch(nn, np), mpn_sec_div_r_itch(nn, nq)),
+                           MAX_ITCH(MAX_ITCH(mpn_sec_div_r_itch(nm, np), mpn_sec_div_r_itch(2 * np, np)),
+                                    MAX_ITCH(MAX_ITCH(mpn_sec_mul_itch(np, np), mpn_sec_mul_itch(nm, np + nq - nm)),
+                                             mpn_sec_add_1_itch(np))));
+}
+
+/* Constant time CRT decryption of one ciphertext: the reductions, the exponentiations and the
+   recombination only use mpn_sec functions, so no branch or memory access depends on p, q, dp or dq.
+   Only the sizes in limbs of the numbers are public */
+static void rsa_decrypt_sec(const rsa_batch_ctx *ctx, mpz_t out, const mpz_t cipher, mp_limb_t *work) {
+    mp_size_t nn = ctx->ctx_n.size, np = ctx->ctx_p.size, nq = ctx->ctx_q.size, nm = MAX_ITCH(np, nq);
+    const mp_limb_t *p = ctx->sec, *q = p + np, *qinv = q + nq, *dp = qinv + np, *dq = dp + np;
+    mp_limb_t *t, *m1, *m2, *u, *h, *tp, cy;
+
+    t = work + MAX_ITCH(montgomery_ladder_itch(&ctx->ctx_p), montgomery_ladder_itch(&ctx->ctx_q));
+    m1 = t + MAX_ITCH(nn, MAX_ITCH(2 * np, np + nq));
+    m2 = m1 + np;
+    u = m2 + nq;
+    h = u + nm;
+    tp = h + np;
+
+    /* m1 = (c mod p)^dp mod p, m2 = (c mod q)^dq mod q. The ciphertext is public, its size is not secret */
+    rsa_limbs(t, cipher, nn);
+    mpn_sec_div_r(t, nn, p, np, tp);
+    montgomery_ladder_powm_limbs(&ctx->ctx_p, m1, t, dp, work);
+    rsa_limbs(t, cipher, nn);
+    mpn_sec_div_r(t, nn, q, nq, tp);
+    montgomery_ladder_powm_limbs(&ctx->ctx_q, m2, t, dq, work);
+
+    /* h = qinv * (m1 - m2 mod p) mod p, the subtraction is corrected with a conditional addition */
+    memset(u, 0, nm * sizeof(mp_limb_t));
+    memcpy(u, m2, nq * sizeof(mp_limb_t));
+    mpn_sec_div_r(u, nm, p, np, tp);
+    cy = mpn_sub_n(h, m1, u, np);
+    mpn_cnd_add_n(cy, h, h, p, np);
+    mpn_sec_mul(t, h, np, qinv, np, tp);
+    mpn_sec_div_r(t, 2 * np, p, np, tp);
+    memcpy(h, t, np * sizeof(mp_limb_t));
+
+    /* m = m2 + q * h, lower than n, in np + nq limbs (mpn_sec_mul wants the longest operand first) */
+    if (nq >= np) {
+        mpn_sec_mul(t, q, nq, h, np, tp);
+    } else {
+        mpn_sec_mul(t, h, np, q, nq, tp);
+    }
+    cy = mpn_add_n(t, t, m2, nq);
+    mpn_sec_add_1(t + nq, t + nq, np, cy, tp);
+
+    memcpy(mpz_limbs_write(out, np + nq), t, (np + nq) * sizeof(mp_limb_t));
+    mpz_limbs_finish(out, np + nq);
+}
+
+/* Arguments of each thread of a batch operation */
+typedef struct {
+    rsa_batch_ctx *ctx;
+    mpz_t *out;
+    mpz_t *in;
+    int start;              /* First element of the thread */
+    int end;                /* Last element of the thread (not included) */
+    int decrypt;            /* 1 to decrypt, 0 to encrypt */
+} rsa_batch_args;
+
+/* Encrypts or decrypts the elements [start, end) of a batch */
+static void *rsa_batch_thread(void *arg) {
+
+    rsa_batch_args *args = (rsa_batch_args *)arg;
+    rsa_batch_ctx *ctx = args->ctx;
+    mp_limb_t *work;
+    mp_size_t itch, itch_q;
+    mpz_t c, m1, m2;
+
+    if (!args->decrypt) {
+        work = (mp_limb_t *)malloc(montgomery_powm_itch(&ctx->ctx_n, ctx->exp_e.window) * sizeof(mp_limb_t));
+        if (work == NULL) {
+            printf("Error en la asignacion de memoria\n");
+            exit(1);
+        }
+
+        for (int i = args->start; i < args->end; i++) {
+            montgomery_powm(&ctx->ctx_n, &ctx->exp_e, args->out[i], args->in[i], work);
+        }
+
+        free(work);
+        return NULL;
+    }
+
+    /* The work area is shared by the exponentiations mod p and mod q */
+    if (ctx->constant_time) {
+        itch = rsa_decrypt_sec_itch(ctx);
+        itch_q = 0;
+    } else {
+        itch = montgomery_powm_itch(&ctx->ctx_p, ctx->exp_dp.window);
+        itch_q = montgomery_powm_itch(&ctx->ctx_q, ctx->exp_dq.window);
+    }
+    if (itch_q > itch) {
+        itch = itch_q;
+    }
+    work = (mp_limb_t *)malloc(itch * sizeof(mp_limb_t));
+    if (work == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    mpz_init(c);
+    mpz_init(m1);
+    mpz_init(m2);
+
+    for (int i = args->start; i < args->end; i++) {
+        if (ctx->constant_time) {
+            rsa_decrypt_sec(ctx, args->out[i], args->in[i], work);
+            continue;
+        }
+
+        /* m1 = c^dp mod p, m2 = c^dq mod q */
+        mpz_mod(c, args->in[i], ctx->p);
+        montgomery_powm(&ctx->ctx_p, &ctx->exp_dp, m1, c, work);
+        mpz_mod(c, args->in[i], ctx->q);
+        montgomery_powm(&ctx->ctx_q, &ctx->exp_dq, m2, c, work);
+
+        /* m = m2 + q * (qinv * (m1 - m2) mod p) */
+        mpz_sub(m1, m1, m2);
+        mpz_mul(m1, m1, ctx->qinv);
+        mpz_mod(m1, m1, ctx->p);
+        mpz_mul(args->out[i], m1, ctx->q);
+        mpz_add(args->out[i], args->out[i], m2);
+    }
+
+    mpz_clear(c);
+    mpz_clear(m1);
+    mpz_clear(m2);
+    free(work);
+
+    return NULL;
+}
+
+/* Splits a batch between threads */
+static int rsa_batch_run(rsa_batch_ctx *ctx, mpz_t *out, mpz_t *in, int count, int threads, int decrypt) {
+
+    pthread_t *ids;
+    rsa_batch_args *args;
+    int created = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (mpz_sgn(in[i]) < 0 || mpz_cmp(in[i], ctx->ctx_n.modulus) >= 0) {
+            return -1;
+        }
+    }
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads > count) {
+        threads = count;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    args = (rsa_batch_args *)malloc(threads * sizeof(rsa_batch_args));
+    if (ids == NULL || args == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        free(ids);
+        free(args);
+        return -1;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        args[t].ctx = ctx;
+        args[t].out = out;
+        args[t].in = in;
+        args[t].start = (int)((long)count * t / threads);
+        args[t].end = (int)((long)count * (t + 1) / threads);
+        args[t].decrypt = decrypt;
+    }
+
+    /* The calling thread does the first part */
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&ids[t], NULL, rsa_batch_thread, &args[t]) != 0) {
+            break;
+        }
+        created = t;
+    }
+
+    rsa_batch_thread(&args[0]);
+
+    /* If a thread could not be created, its part and the following ones are done here */
+    for (int t = created + 1; t < threads; t++) {
+        rsa_batch_thread(&args[t]);
+    }
+
+    for (int t = 1; t <= created; t++) {
+        pthread_join(ids[t], NULL);
+    }
+
+    free(ids);
+    free(args);
+
+    return 0;
+}
+
+int rsa_encrypt_batch(rsa_batch_ctx *ctx, mpz_t *out, mpz_t *msgs, int count, int threads) {
+    return rsa_batch_run(ctx, out, msgs, count, threads, 0);
+}
+
+int rsa_decrypt_batch(rsa_batch_ctx *ctx, mpz_t *out, mpz_t *ciphers, int count, int threads) {
+    return rsa_batch_run(ctx, out, ciphers, count, threads, 1);
+}
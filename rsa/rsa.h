@@ -14,6 +14,63 @@
 
 #include "../utiles/utils.h"
 #include "../primos/primo.h"
+#include "../utiles/montgomery.h"
+#include "../utiles/mpz_file.h"
+
+/* Iterations of the Fermat screen run on every generated key (fewer for moduli under 112 bits) */
+#define FERMAT_DEFAULT_ITERATIONS 10000
+
+/* Rounds of the Miller-Rabin test used for p and q */
+#define RSA_MR_ROUNDS 15
+
+/* Numbers of a key in a file of keys: n, e, d, p, q, dp, dq, qinv */
+#define RSA_KEY_FILE_FIELDS 8
+
+/**
+ * @brief Time (seconds) spent on each phase of rsa_keygen
+ */
+typedef struct {
+    double p;           /* Generation of p (its own thread) */
+    double q;           /* Generation of q (its own thread) */
+    double primes;      /* Wall time of the concurrent generation of p and q */
+    double derive;      /* n, euler function, e, d and the checks of the key */
+    double total;       /* Wall time of the whole keygen, including rejected keys */
+} rsa_keygen_times;
+
+/**
+ * @brief RSA key with its prime factors and the time it took to generate it
+ */
+typedef struct {
+    mpz_t n;            /* p*q */
+    mpz_t e;            /* Public exponent */
+    mpz_t d;            /* Private exponent */
+    mpz_t p;            /* Prime p */
+    mpz_t q;            /* Prime q */
+    mpz_t euler_f;      /* (p-1)*(q-1) */
+    mpz_t dp;           /* d mod (p-1) */
+    mpz_t dq;           /* d mod (q-1) */
+    mpz_t qinv;         /* q^-1 mod p */
+    rsa_keygen_times times;
+} rsa_key;
+
+/**
+ * @brief Precomputed data to encrypt and decrypt many messages with the same key. The Montgomery
+ *        contexts and the recoded exponents are shared by all the messages (and threads)
+ */
+typedef struct {
+    montgomery_ctx ctx_n;   /* Context of n, for encryption */
+    montgomery_ctx ctx_p;   /* Context of p, for CRT decryption */
+    montgomery_ctx ctx_q;   /* Context of q, for CRT decryption */
+    montgomery_exp exp_e;   /* Recoded e */
+    montgomery_exp exp_dp;  /* Recoded d mod (p-1) */
+    montgomery_exp exp_dq;  /* Recoded d mod (q-1) */
+    mpz_t p;
+    mpz_t q;
+    mpz_t qinv;
+    mp_limb_t *sec;         /* p, q, qinv, d mod (p-1) and d mod (q-1) zero padded to the limbs of p or q,
+                               for the constant time decryption */
+    int constant_time;      /* 1 to decrypt in constant time (0 after rsa_batch_init) */
+} rsa_batch_ctx;
 
 /**
  * @brief Generate the euler function value
@@ -43,4 +100,161 @@ void generate_e(mpz_t euler_f, mpz_t e);
  */
 int generate_d(mpz_t e, mpz_t euler_f, mpz_t d);
 
+/**
+ * @brief Function that will simulate the attack of the RSA algorithm using the Vegas algorithm
+ *        Will manage to guess p and q knowing d.
+ * 
+ * @param d private exponent d
+ * @param n p*q
+ * @param mod euler function value
+ * @param p (return) prime number p
+ * @param q (return) prime number q
+ */
+void vegas_attack(mpz_t d, mpz_t n, mpz_t mod, mpz_t p, mpz_t q);
+
+/**
+ * @brief Try to factor n with the Fermat method (n = a^2 - b^2 = (a-b)*(a+b)). It only succeeds
+ *        quickly when p and q are close to each other, so it is used as a cheap screen for weak keys.
+ *        a^2 - n is updated incrementally on each step instead of recomputing the square.
+ * 
+ * @param n modulus to factor
+ * @param iterations maximum number of values of a to try
+ * @param p (return) smaller factor of n if found
+ * @param q (return) bigger factor of n if found
+ * 
+ * @return int 1 if n was factored within the given iterations, 0 otherwise
+ */
+int fermat_factor(mpz_t n, unsigned long iterations, mpz_t p, mpz_t q);
+
+/**
+ * @brief Wiener attack. Goes through the convergents k/d of the continued fraction of e/n looking for
+ *        the one that gives phi(n) = (e*d - 1)/k and p, q as roots of x^2 - (n - phi(n) + 1)x + n.
+ *        It succeeds when d is small (d < n^0.25 / 3).
+ * 
+ * @param e public exponent e
+ * @param n p*q
+ * @param d (return) private exponent d if found
+ * @param p (return) smaller prime factor of n if found
+ * @param q (return) bigger prime factor of n if found
+ * 
+ * @return int 1 if the attack worked, 0 otherwise
+ */
+int wiener_attack(mpz_t e, mpz_t n, mpz_t d, mpz_t p, mpz_t q);
+
+/**
+ * @brief Post keygen check against small private exponents. The key is rejected if d < n^0.25
+ *        or if the Wiener attack is able to recover d.
+ * 
+ * @param e public exponent e
+ * @param d private exponent d
+ * @param n p*q
+ * 
+ * @return int 0 if the key is safe, -1 otherwise
+ */
+int check_private_exponent(mpz_t e, mpz_t d, mpz_t n);
+
+/**
+ * @brief Initializes the numbers of a key
+ * 
+ * @param key key to initialize
+ */
+void rsa_key_init(rsa_key *key);
+
+/**
+ * @brief Frees the numbers of a key
+ * 
+ * @param key key to free
+ */
+void rsa_key_clear(rsa_key *key);
+
+/**
+ * @brief Generates an RSA key with a modulus of bits bits. p and q are generated at the same time in
+ *        two threads, each one with its own random state (seeded with 256 bits of prng_secure_fill), and then n, the euler
+ *        function, e and d are derived. Keys that fail the Fermat screen or check_private_exponent are
+ *        discarded. The time of every phase is left in key->times
+ * 
+ * @param bits size of the modulus n. p has (bits+1)/2 bits and q has bits/2 bits
+ * @param e public exponent (for example 65537). If it is 0, a random e is generated with generate_e
+ * @param key (return) initialized key where the result is stored
+ * 
+ * @return int 0 if the key was generated, -1 otherwise
+ */
+int rsa_keygen(int bits, unsigned long e, rsa_key *key);
+
+/**
+ * @brief Computes the CRT parameters of a key (dp, dq, qinv) from p, q and d
+ * 
+ * @param key key with p, q and d
+ * 
+ * @return int 0 if the parameters were computed, -1 otherwise
+ */
+int rsa_key_set_crt(rsa_key *key);
+
+/**
+ * @brief Writes a key to a file of keys (opened with kind MPZ_FILE_RSA_KEYS and RSA_KEY_FILE_FIELDS numbers
+ *        per record): n, e, d, p, q, dp, dq and qinv. The euler function and the times are not written
+ * 
+ * @param writer file of keys
+ * @param key key with the CRT parameters computed
+ * 
+ * @return int 0 if the key was written, -1 otherwise
+ */
+int rsa_key_write(mpz_file_writer *writer, rsa_key *key);
+
+/**
+ * @brief Reads the next key of a file of keys. The euler function is computed again from p and q
+ * 
+ * @param reader file of keys
+ * @param key (return) initialized key
+ * 
+ * @return int 1 if a key was read, 0 at the end of the file, -1 if the file is not a valid file of keys
+ */
+int rsa_key_read(mpz_file_reader *reader, rsa_key *key);
+
+/**
+ * @brief Prepares the Montgomery contexts and recoded exponents of a key for batch operations
+ * 
+ * @param ctx context to initialize
+ * @param key key with the CRT parameters computed
+ * 
+ * @return int 0 if the context was initialized, -1 otherwise
+ */
+int rsa_batch_init(rsa_batch_ctx *ctx, rsa_key *key);
+
+/**
+ * @brief Frees a batch context
+ * 
+ * @param ctx context to free
+ */
+void rsa_batch_clear(rsa_batch_ctx *ctx);
+
+/**
+ * @brief Encrypts count messages, out[i] = msgs[i]^e mod n. The messages are split between threads
+ * 
+ * @param ctx batch context of the key
+ * @param out (return) array of count initialized numbers for the ciphertexts
+ * @param msgs array of count messages, 0 <= msgs[i] < n
+ * @param count number of messages
+ * @param threads number of threads (0 to use one per online core)
+ * 
+ * @return int 0 if everything went well, -1 otherwise
+ */
+int rsa_encrypt_batch(rsa_batch_ctx *ctx, mpz_t *out, mpz_t *msgs, int count, int threads);
+
+/**
+ * @brief Decrypts count ciphertexts with the CRT, out[i] = ciphers[i]^d mod n. The ciphertexts are
+ *        split between threads. If ctx->constant_time is set the whole decryption (reductions mod p and
+ *        mod q, montgomery_ladder_powm_limbs and the recombination) uses mpn_sec functions, so its time
+ *        does not depend on p, q, dp or dq
+ * 
+ * @param ctx batch context of the key
+ * @param out (return) array of count initialized numbers for the messages
+ * @param ciphers array of count ciphertexts, 0 <= ciphers[i] < n
+ * @param count number of ciphertexts
+ * @param threads number of threads (0 to use one per online core)
+ * 
+ * @return int 0 if everything went well, -1 otherwise
+ */
+int rsa_decrypt_batch(rsa_batch_ctx *ctx, mpz_t *out, mpz_t *ciphers, int count, int threads);
+
 #endif
@@ -0,0 +1,308 @@
+/**
+ * @file rsa_batch.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Benchmark of the batch RSA encryption and decryption (shared Montgomery contexts and threads)
+ *        compared with one mpz_powm call per message. The batch is also run in one thread, and the
+ *        decryption baseline is given with and without the CRT, so the gain of reusing the contexts can be
+ *        told apart from the gain of the threads and of the CRT
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "../utiles/utils.h"
+#include "rsa.h"
+
+#define DEFAULT_MESSAGES 1000
+#define PUBLIC_EXPONENT 65537
+#define MESSAGES_SEED 12345
+
+/* Key sizes of the benchmark when -b is not given */
+static const int benchmark_bits[] = {1024, 2048, 3072, 4096};
+#define NUM_BENCHMARK_BITS 4
+
+/**
+ * @brief Function to check the arguments of the program
+ *
+ * @param argc number of arguments
+ * @param argv arguments
+ * @param bits size of the key (0 for all the sizes of the benchmark)
+ * @param messages number of messages of the batch
+ * @param threads number of threads (0 for one per core)
+ * @param file_out output file
+ * @return int 0 if the arguments are correct, -1 otherwise
+ */
+int check_args(int argc, char *argv[], int *bits, int *messages, int *threads, char **file_out);
+
+/**
+ * @brief Function to print the help of the program
+ *
+ */
+void print_help();
+
+/**
+ * @brief Runs the benchmark for one key size and prints a line of the table
+ *
+ * @param bits size of the key
+ * @param messages number of messages of the batch
+ * @param threads number of threads
+ * @return int 0 if the results are correct, -1 otherwise
+ */
+int benchmark_batch(int bits, int messages, int threads);
+
+/**
+ * @brief Encrypts and decrypts the messages with the batch functions and counts the messages not recovered
+ *
+ * @param ctx batch context of the key
+ * @param msgs messages
+ * @param ciphers (return) ciphertexts
+ * @param plains (return) decrypted messages
+ * @param messages number of messages
+ * @param threads number of threads
+ * @param t_enc (return) time of the encryption
+ * @param t_dec (return) time of the decryption
+ * @param errors (return) messages not recovered are added here
+ * @return int 0 if the batch functions worked, -1 otherwise
+ */
+int run_batch(rsa_batch_ctx *ctx, mpz_t *msgs, mpz_t *ciphers, mpz_t *plains, int messages, int threads,
+              double *t_enc, double *t_dec, int *errors);
+
+/**
+ * @brief Decrypts one ciphertext with mpz_powm and the CRT: m1 = c^dp mod p, m2 = c^dq mod q and
+ *        m = m2 + q*(qinv*(m1 - m2) mod p)
+ *
+ * @param plain (return) message
+ * @param cipher ciphertext
+ * @param key key with the CRT parameters
+ * @param m1 auxiliary number
+ * @param m2 auxiliary number
+ */
+void decrypt_mpz_crt(mpz_t plain, mpz_t cipher, rsa_key *key, mpz_t m1, mpz_t m2);
+
+int main(int argc, char *argv[]) {
+
+    int bits = 0, messages = DEFAULT_MESSAGES, threads = 0;
+    char *file_out = NULL;
+
+    if(check_args(argc, argv, &bits, &messages, &threads, &file_out) == -1) {
+        printf("Error in the arguments\n");
+        print_help();
+        return -1;
+    }
+
+    if(file_out != NULL) {
+        freopen(file_out, "w", stdout);
+    }
+
+    printf("Bits Messages Threads Encrypt(ops/s) Decrypt(ops/s) Decrypt_ct(ops/s) mpz_powm_encrypt(ops/s) mpz_powm_decrypt(ops/s) "
+           "Encrypt_1t(ops/s) Decrypt_1t(ops/s) mpz_powm_decrypt_crt(ops/s)\n");
+
+    if(bits != 0) {
+        return benchmark_batch(bits, messages, threads);
+    }
+
+    for(int i = 0; i < NUM_BENCHMARK_BITS; i++) {
+        if(benchmark_batch(benchmark_bits[i], messages, threads) == -1) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int benchmark_batch(int bits, int messages, int threads) {
+
+    rsa_key key;
+    rsa_batch_ctx ctx;
+    gmp_randstate_t state;
+    mpz_t *msgs, *ciphers, *plains, m1, m2;
+    double start, t_enc, t_dec, t_dec_ct, t_enc_1, t_dec_1, t_enc_mpz, t_dec_mpz, t_dec_crt;
+    int errors = 0, result;
+
+    rsa_key_init(&key);
+    if(rsa_keygen(bits, PUBLIC_EXPONENT, &key) == -1 || rsa_batch_init(&ctx, &key) == -1) {
+        printf("Error generating the key\n");
+        rsa_key_clear(&key);
+        return -1;
+    }
+
+    msgs = (mpz_t *)malloc(messages * sizeof(mpz_t));
+    ciphers = (mpz_t *)malloc(messages * sizeof(mpz_t));
+    plains = (mpz_t *)malloc(messages * sizeof(mpz_t));
+    if(msgs == NULL || ciphers == NULL || plains == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    gmp_randinit_default(state);
+    gmp_randseed_ui(state, MESSAGES_SEED);
+    mpz_init(m1);
+    mpz_init(m2);
+
+    for(int i = 0; i < messages; i++) {
+        mpz_init(msgs[i]);
+        mpz_init(ciphers[i]);
+        mpz_init(plains[i]);
+        mpz_urandomm(msgs[i], state, key.n);
+    }
+
+    /* Batch operations, with the threads and in one thread */
+    result = run_batch(&ctx, msgs, ciphers, plains, messages, threads, &t_enc, &t_dec, &errors);
+    if(result == 0 && threads == 1) {
+        t_enc_1 = t_enc;
+        t_dec_1 = t_dec;
+    } else if(result == 0) {
+        result = run_batch(&ctx, msgs, ciphers, plains, messages, 1, &t_enc_1, &t_dec_1, &errors);
+    }
+
+    /* Constant time decryption (Montgomery ladder) */
+    if(result == 0) {
+        ctx.constant_time = 1;
+        start = get_wall_time();
+        result = rsa_decrypt_batch(&ctx, plains, ciphers, messages, threads);
+        t_dec_ct = get_wall_time() - start;
+        ctx.constant_time = 0;
+
+        for(int i = 0; i < messages; i++) {
+            if(mpz_cmp(msgs[i], plains[i]) != 0) {
+                errors++;
+            }
+        }
+    }
+
+    if(result == 0) {
+        /* One call per message, without reusing anything */
+        start = get_wall_time();
+        for(int i = 0; i < messages; i++) {
+            mpz_powm(ciphers[i], msgs[i], key.e, key.n);
+        }
+        t_enc_mpz = get_wall_time() - start;
+
+        start = get_wall_time();
+        for(int i = 0; i < messages; i++) {
+            mpz_powm(plains[i], ciphers[i], key.d, key.n);
+        }
+        t_dec_mpz = get_wall_time() - start;
+
+        /* One call per message with the CRT, the same arithmetic as the batch in one thread */
+        start = get_wall_time();
+        for(int i = 0; i < messages; i++) {
+            decrypt_mpz_crt(plains[i], ciphers[i], &key, m1, m2);
+        }
+        t_dec_crt = get_wall_time() - start;
+
+        for(int i = 0; i < messages; i++) {
+            if(mpz_cmp(msgs[i], plains[i]) != 0) {
+                errors++;
+            }
+        }
+
+        printf("%d %d %d %lf %lf %lf %lf %lf %lf %lf %lf\n", bits, messages, threads, messages / t_enc,
+               messages / t_dec, messages / t_dec_ct, messages / t_enc_mpz, messages / t_dec_mpz,
+               messages / t_enc_1, messages / t_dec_1, messages / t_dec_crt);
+    } else {
+        printf("Error in the batch operations of the %d bits key\n", bits);
+    }
+
+    if(errors > 0) {
+        printf("Error: %d messages were not recovered\n", errors);
+    }
+
+    for(int i = 0; i < messages; i++) {
+        mpz_clear(msgs[i]);
+        mpz_clear(ciphers[i]);
+        mpz_clear(plains[i]);
+    }
+    free(msgs);
+    free(ciphers);
+    free(plains);
+    mpz_clear(m1);
+    mpz_clear(m2);
+    gmp_randclear(state);
+    rsa_batch_clear(&ctx);
+    rsa_key_clear(&key);
+
+    return result == 0 && errors == 0 ? 0 : -1;
+}
+
+int run_batch(rsa_batch_ctx *ctx, mpz_t *msgs, mpz_t *ciphers, mpz_t *plains, int messages, int threads,
+              double *t_enc, double *t_dec, int *errors) {
+
+    double start;
+
+    start = get_wall_time();
+    if(rsa_encrypt_batch(ctx, ciphers, msgs, messages, threads) != 0) {
+        return -1;
+    }
+    *t_enc = get_wall_time() - start;
+
+    start = get_wall_time();
+    if(rsa_decrypt_batch(ctx, plains, ciphers, messages, threads) != 0) {
+        return -1;
+    }
+    *t_dec = get_wall_time() - start;
+
+    for(int i = 0; i < messages; i++) {
+        if(mpz_cmp(msgs[i], plains[i]) != 0) {
+            (*errors)++;
+        }
+    }
+
+    return 0;
+}
+
+void decrypt_mpz_crt(mpz_t plain, mpz_t cipher, rsa_key *key, mpz_t m1, mpz_t m2) {
+    mpz_powm(m1, cipher, key->dp, key->p);
+    mpz_powm(m2, cipher, key->dq, key->q);
+
+    mpz_sub(m1, m1, m2);
+    mpz_mul(m1, m1, key->qinv);
+    mpz_mod(m1, m1, key->p);
+    mpz_mul(m1, m1, key->q);
+    mpz_add(plain, m2, m1);
+}
+
+int check_args(int argc, char *argv[], int *bits, int *messages, int *threads, char **file_out) {
+    if (argc % 2 != 1 || argc > 9) {
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-b") == 0) {
+            *bits = atoi(argv[i+1]);
+            if (*bits < 32) {
+                printf("Size must be at least 32 bits\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-m") == 0) {
+            *messages = atoi(argv[i+1]);
+            if (*messages <= 0) {
+                printf("Messages must be greater than 0\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-t") == 0) {
+            *threads = atoi(argv[i+1]);
+            if (*threads < 0) {
+                printf("Threads must be 0 or greater\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *file_out = argv[i+1];
+        } else {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+void print_help() {
+    printf("Usage: ./rsa_batch [-b <bits>] [-m <messages>] [-t <threads>] [-o <output_file>]\n");
+    printf("Options:\n");
+    printf("  -b <bits>          Size of the key (default: 1024, 2048, 3072 and 4096)\n");
+    printf("  -m <messages>      Messages of the batch (default %d)\n", DEFAULT_MESSAGES);
+    printf("  -t <threads>       Threads of the batch (default 0, one per core), the batch is run in one thread too\n");
+    printf("  -o <output_file>   Output file\n");
+}
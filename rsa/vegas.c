@@ -11,30 +11,39 @@
 
 #include "../utiles/utils.h"
 #include "../primos/primo.h"
+#include "../utiles/stats.h"
 #include "rsa.h"
 
-/**
- * @brief Function that will simulate the attack of the RSA algorithm using the Vegas algorithm
- *        Will manage to guess p and q knowing d.
- * 
- * @param d private exponent d
- * @param n p*q
- * @param mod euler function value
- * @param p (return) prime number p
- * @param q (return) prime number q
- */
-void vegas_attack(mpz_t d, mpz_t n, mpz_t mod, mpz_t p, mpz_t q);
-
 /**
  * @brief Function to check the arguments of the program
  * 
  * @param argc number of arguments
  * @param argv arguments
- * @param size size of the prime number
+ * @param size size of the prime p, q has one bit less (as in the data of vegas.sh)
  * @param string output file
+ * @param keys_in file of keys to attack (instead of generating one)
+ * @param keys_out file where the generated key is written
  * @return int 0 if the arguments are correct, -1 otherwise
  */
-int check_args(int argc, char *argv[], int *size, char **string);
+int check_args(int argc, char *argv[], int *size, char **string, char **keys_in, char **keys_out);
+
+/**
+ * @brief Runs the Vegas attack on a key and checks the factors found
+ * 
+ * @param key key with n, d and the euler function
+ * @param verbose 1 to print the factors guessed
+ * @param time (return) time of the attack
+ * @return int 1 if the attack found p and q, 0 otherwise
+ */
+int attack_key(rsa_key *key, int verbose, double *time);
+
+/**
+ * @brief Attacks every key of a file of keys written with -w (or rsa_key_write)
+ * 
+ * @param keys_in name of the file
+ * @return int 0 if the whole file was read, -1 otherwise
+ */
+int attack_key_file(char *keys_in);
 
 /**
  * @brief Function to print the help of the program
@@ -44,11 +53,13 @@ void print_help();
 
 int main(int argc, char *argv[]) {
     
-    mpz_t p, q, n, euler_f, e, d;
-    int size;
-    char *string = NULL;
+    rsa_key key;
+    int size = 0;
+    char *string = NULL, *keys_in = NULL, *keys_out = NULL;
+    mpz_file_writer writer;
+    double time;
 
-    if(check_args(argc, argv, &size, &string) == -1) {
+    if(check_args(argc, argv, &size, &string, &keys_in, &keys_out) == -1) {
         printf("Error in the arguments\n");
         print_help();
         return -1;
@@ -58,198 +69,160 @@ int main(int argc, char *argv[]) {
         freopen(string, "w", stdout);
     }
 
-    mpz_init(p); mpz_init(q); mpz_init(n); 
-    mpz_init(euler_f); mpz_init(e); mpz_init(d);
+    STATS_PRINT_AT_EXIT();
 
-    srand(time(NULL));
+    if(keys_in != NULL) {
+        return attack_key_file(keys_in);
+    }
+
+    rsa_key_init(&key);
 
     /* Starts RSA procedure */
-    /* Generate primes p and q */
-    printf("Generating p...\n");
-    generate_prime_number(size, 15, p);
-    printf("Generating q...\n");
-    generate_prime_number(size-1, 15, q); // q has one less bit than p to make sure they are different numbers
-    mpz_mul(n, p, q);
-    /* Generates Euler function value*/
-    generate_euler_f(p, q, euler_f);
-    /* Generate e */
-    generate_e(euler_f, e);
-    /* Generate d */
-    if( generate_d(e, euler_f, d) == -1) {
-        printf("Error generating d\n");
+    /* Generate p and q (concurrently), euler function, e and d. p has size bits and q one less, so that
+       they are different numbers */
+    printf("Generating key...\n");
+    if(rsa_keygen(2*size - 1, 0, &key) == -1) {
+        printf("Error generating the key\n");
+        rsa_key_clear(&key);
         return -1;
     }
 
     /* Print all values */
-    //gmp_printf("p: %Zd\nq: %Zd\nEuler function: %Zd\nPublic exponent: %Zd\nPrivate exponent: %Zd\n", p, q, euler_f, e, d);
-    gmp_printf("p: %Zd\nq: %Zd\n", p, q);
+    //gmp_printf("p: %Zd\nq: %Zd\nEuler function: %Zd\nPublic exponent: %Zd\nPrivate exponent: %Zd\n", key.p, key.q, key.euler_f, key.e, key.d);
+    gmp_printf("p: %Zd\nq: %Zd\n", key.p, key.q);
+    printf("Keygen time: %lf (p: %lf, q: %lf, primes: %lf, derive: %lf)\n", key.times.total,
+           key.times.p, key.times.q, key.times.primes, key.times.derive);
+
+    if(keys_out != NULL) {
+        if(mpz_file_writer_open(&writer, keys_out, MPZ_FILE_RSA_KEYS, RSA_KEY_FILE_FIELDS) != 0) {
+            rsa_key_clear(&key);
+            return -1;
+        }
+        if(rsa_key_write(&writer, &key) != 0 || mpz_file_writer_close(&writer) != 0) {
+            printf("Error writing the key to %s\n", keys_out);
+            rsa_key_clear(&key);
+            return -1;
+        }
+    }
 
     printf("Starting Vegas attack...\n");
 
-    mpz_t guess_p, guess_q;
-    mpz_init(guess_p);
-    mpz_init(guess_q);
-
-    clock_t start = clock();
-
-    vegas_attack(d, n, euler_f, guess_p, guess_q);
-
-    clock_t end = clock();
-
-    gmp_printf("Guessed p: %Zd\nGuessed q: %Zd\n", guess_p, guess_q);
-
-    if(mpz_cmp(p, guess_p) == 0 && mpz_cmp(q, guess_q) == 0) {
-        printf("Attack successful!\n");
-    } else if(mpz_cmp(p, guess_q) == 0 && mpz_cmp(q, guess_p) == 0) {
+    if(attack_key(&key, 1, &time)) {
         printf("Attack successful!\n");
     } else {
         printf("Attack failed.\n");
     }
 
-    printf("Time: %lf\n", (double)(end - start) / CLOCKS_PER_SEC);
+    printf("Time: %lf\n", time);
     
-    mpz_clear(p);
-    mpz_clear(q);
-    mpz_clear(euler_f);
-    mpz_clear(e);
-    mpz_clear(d);
-    mpz_clear(n);
-    mpz_clear(guess_p);
-    mpz_clear(guess_q);
+    rsa_key_clear(&key);
 
     return 0;
 }
 
-void vegas_attack(mpz_t d, mpz_t n, mpz_t mod, mpz_t p, mpz_t q) {
+int attack_key(rsa_key *key, int verbose, double *time) {
+    mpz_t guess_p, guess_q;
+    int success;
 
-    /* Calculate e (implicit data)*/
-    mpz_t e;
-    mpz_init(e);
-    
-    if( generate_d(d, mod, e) == -1) {
-        printf("Error generating e\n");
-        return;
-    }
+    mpz_init(guess_p);
+    mpz_init(guess_q);
+
+    clock_t start = clock();
+
+    vegas_attack(key->d, key->n, key->euler_f, guess_p, guess_q);
 
-    mpz_t ed, n_1, two, m, aux, pre_aux, w;
-    mpz_init(ed);
-    mpz_init(n_1);
-    mpz_init(m);
-    mpz_init(aux);
-    mpz_init(pre_aux);
-    mpz_init(w);
-
-    mpz_mul(ed, e, d);
-    mpz_init_set_ui(two, 2);
-    mpz_sub_ui(m, ed, 1);
-    mpz_sub_ui(n_1, n, 1);
-
-    int s = 0;
-    while (mpz_even_p(m))
-    {
-        mpz_fdiv_q_2exp(m, m, 1);
-        s++;
+    clock_t end = clock();
+
+    if(verbose) {
+        gmp_printf("Guessed p: %Zd\nGuessed q: %Zd\n", guess_p, guess_q);
     }
 
-    /* Test if number is prime */
-    int found = 0;
-    while(found==0) {
+    success = (mpz_cmp(key->p, guess_p) == 0 && mpz_cmp(key->q, guess_q) == 0) ||
+              (mpz_cmp(key->p, guess_q) == 0 && mpz_cmp(key->q, guess_p) == 0);
 
-        generate_testigue(w, n); // Generate random testigue
-        
-        /* Test if a^m mod number == 1  or -1*/
-        potencia_modular(aux, w, m, n);
+    *time = (double)(end - start) / CLOCKS_PER_SEC;
 
-        if(mpz_cmp_ui(aux, 1) == 0 || mpz_cmp(aux, n_1) == 0) {
-            continue; // can't answer, continue with next round
-        }
+    mpz_clear(guess_p);
+    mpz_clear(guess_q);
 
-        /* For every 2^d*s */
-        for(int ii=0; ii<s; ii++) {
-            mpz_set(pre_aux, aux);
-            mpz_mul_ui(m, m, 2);
-            potencia_modular(aux, w, m, n);
-
-            if(mpz_cmp_ui(aux, 1) == 0) {
-                mpz_sub_ui(pre_aux, pre_aux, 1);
-                euclides_mcd(pre_aux, n, p);
-                found = 1;
-                break; // Found p 
-            }
+    return success;
+}
 
-            if(mpz_cmp(aux, n_1) == 0) {
-                break; // don't answer, might be prime. Continue with next round
-            }
+int attack_key_file(char *keys_in) {
+    mpz_file_reader reader;
+    rsa_key key;
+    int result, keys = 0, successes = 0;
+    double time, total = 0, start;
 
-            /* If last iteration, and algorithm didn't answer yet, is composite */
-            if(ii == s-1) {
-                mpz_sub_ui(pre_aux, pre_aux, 1);
-                euclides_mcd(pre_aux, n, p);
-                found = 1;
-                break; // Found p
-            }
-        }
+    start = get_wall_time();
+    if(mpz_file_reader_open(&reader, keys_in) != 0) {
+        return -1;
     }
 
-    if(found == 0) {
-        printf("Error, couldn't find p\n");
-        return;
-    }
+    rsa_key_init(&key);
 
-    /* Verify the test worked mod%p = 0*/
-    mpz_t mod_p;
-    mpz_init(mod_p);
-    mpz_mod(mod_p, n, p);
+    while((result = rsa_key_read(&reader, &key)) == 1) {
+        keys++;
+        if(attack_key(&key, 0, &time)) {
+            successes++;
+            printf("Key %d (%lu bits): attack successful, time: %lf\n", keys, (unsigned long)mpz_sizeinbase(key.n, 2), time);
+        } else {
+            printf("Key %d (%lu bits): attack failed, time: %lf\n", keys, (unsigned long)mpz_sizeinbase(key.n, 2), time);
+        }
+        total += time;
+    }
 
-    if(mpz_cmp_ui(mod_p, 0) != 0) {
-        printf("Error, the test didn't work\n");
-        return;
+    if(result == -1) {
+        printf("Error reading the key %d of %s\n", keys + 1, keys_in);
     }
 
-    mpz_div(q, n, p);
+    printf("Keys: %d, successful attacks: %d, attack time: %lf, total time: %lf\n", keys, successes, total,
+           get_wall_time() - start);
 
-    mpz_clear(e);
-    mpz_clear(ed);
-    mpz_clear(n_1);
-    mpz_clear(two);
-    mpz_clear(m);
-    mpz_clear(aux);
-    mpz_clear(pre_aux);
-    mpz_clear(w);
-    mpz_clear(mod_p);
+    rsa_key_clear(&key);
+    mpz_file_reader_close(&reader);
 
-    return;
+    return result == -1 ? -1 : 0;
 }
 
-int check_args(int argc, char *argv[], int *size, char **string) {
-    if (argc != 3 && argc != 5) {
+int check_args(int argc, char *argv[], int *size, char **string, char **keys_in, char **keys_out) {
+    if (argc % 2 != 1 || argc < 3) {
         return -1;
     }
 
-    if (strcmp(argv[1], "-s") == 0) {
-        *size = atoi(argv[2]);
-        if (*size < 0) {
-            printf("Size must be greater than 0\n");
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "-s") == 0) {
+            *size = atoi(argv[i+1]);
+            /* rsa_keygen needs a modulus of at least 32 bits */
+            if (*size < 17) {
+                printf("Size must be at least 17 bits\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-k") == 0) {
+            *keys_in = argv[i+1];
+        } else if (strcmp(argv[i], "-w") == 0) {
+            *keys_out = argv[i+1];
+        } else if (strcmp(argv[i], "-o") == 0) {
+            *string = argv[i+1];
+        } else {
             return -1;
         }
-    } else {
-        return -1;
     }
 
-    if (argc == 5) {
-        if (strcmp(argv[3], "-o") == 0) {
-            *string = argv[4];
-        } else {
-            return -1;
-        }
+    /* A key is generated (-s) or read (-k) */
+    if ((*size == 0) == (*keys_in == NULL) || (*keys_in != NULL && *keys_out != NULL)) {
+        return -1;
     }
 
     return 0;
 }
 
 void print_help() {
-    printf("Usage: ./vegas -s <size> [-o <output_file>]\n");
+    printf("Usage: ./vegas -s <size> [-w <key_file>] [-o <output_file>]\n");
+    printf("       ./vegas -k <key_file> [-o <output_file>]\n");
     printf("Options:\n");
-    printf("  -s <size>          Size of the prime number\n");
+    printf("  -s <size>          Size of the prime p (at least 17), q has size-1 bits\n");
+    printf("  -w <key_file>      Write the generated key to a binary file of keys\n");
+    printf("  -k <key_file>      Attack every key of a binary file of keys instead of generating one\n");
     printf("  -o <output_file>   Output file\n");
 }
@@ -0,0 +1,139 @@
+/**
+ * @file bench.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in bench.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "bench.h"
+
+/* Comparison of doubles for qsort */
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+long bench_calibrate(bench_kernel kernel, void *arg) {
+    long inner = 1;
+    double start, elapsed;
+
+    while (1) {
+        start = get_wall_time();
+        for (long i = 0; i < inner; i++) {
+            kernel(arg);
+        }
+        elapsed = get_wall_time() - start;
+
+        if (elapsed >= BENCH_MIN_SAMPLE_TIME || inner >= (1L << 30)) {
+            return inner;
+        }
+
+        /* Jump directly close to the target when the time is measurable */
+        if (elapsed > BENCH_MIN_SAMPLE_TIME / 100) {
+            inner = (long)(inner * BENCH_MIN_SAMPLE_TIME / elapsed) + 1;
+        } else {
+            inner *= 10;
+        }
+    }
+}
+
+void bench_run(bench_kernel kernel, void *arg, int warmup, int repetitions, long inner, double *samples) {
+    double start;
+
+    for (int i = 0; i < warmup; i++) {
+        kernel(arg);
+    }
+
+    for (int r = 0; r < repetitions; r++) {
+        start = get_wall_time();
+        for (long i = 0; i < inner; i++) {
+            kernel(arg);
+        }
+        samples[r] = (get_wall_time() - start) / inner;
+    }
+}
+
+double bench_percentile(const double *sorted, int count, double p) {
+    double pos, frac;
+    int index;
+
+    if (count <= 0) {
+        return 0;
+    }
+
+    pos = p / 100 * (count - 1);
+    index = (int)pos;
+    if (index >= count - 1) {
+        return sorted[count - 1];
+    }
+    frac = pos - index;
+
+    return sorted[index] + frac * (sorted[index + 1] - sorted[index]);
+}
+
+void bench_compute_stats(double *samples, int count, long inner, bench_stats *stats) {
+    double sum = 0, sq = 0;
+
+    memset(stats, 0, sizeof(bench_stats));
+    stats->count = count;
+    stats->inner = inner;
+    if (count <= 0) {
+        return;
+    }
+
+    qsort(samples, count, sizeof(double), compare_doubles);
+
+    for (int i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    stats->mean = sum / count;
+
+    for (int i = 0; i < count; i++) {
+        sq += (samples[i] - stats->mean) * (samples[i] - stats->mean);
+    }
+    stats->stddev = count > 1 ? sqrt(sq / (count - 1)) : 0;
+
+    stats->min = samples[0];
+    stats->max = samples[count - 1];
+    stats->median = bench_percentile(samples, count, 50);
+    stats->p90 = bench_percentile(samples, count, 90);
+    stats->p99 = bench_percentile(samples, count, 99);
+    stats->ops = stats->mean > 0 ? 1 / stats->mean : 0;
+}
+
+void bench_print_header(FILE *out, int format) {
+    if (format == BENCH_FORMAT_CSV) {
+        fprintf(out, "kernel,bits,samples,inner,mean,stddev,min,median,p90,p99,max,ops_per_sec\n");
+    } else if (format == BENCH_FORMAT_JSON) {
+        fprintf(out, "[\n");
+    } else {
+        fprintf(out, "%-28s %6s %8s %12s %12s %12s %12s %14s\n", "Kernel", "Bits", "Samples",
+                "Mean(s)", "Median(s)", "P90(s)", "P99(s)", "Ops/s");
+    }
+}
+
+void bench_print_row(FILE *out, int format, const char *name, int bits, const bench_stats *stats, int first) {
+    if (format == BENCH_FORMAT_CSV) {
+        fprintf(out, "%s,%d,%d,%ld,%.9e,%.9e,%.9e,%.9e,%.9e,%.9e,%.9e,%.3f\n", name, bits, stats->count,
+                stats->inner, stats->mean, stats->stddev, stats->min, stats->median, stats->p90, stats->p99,
+                stats->max, stats->ops);
+    } else if (format == BENCH_FORMAT_JSON) {
+        fprintf(out, "%s  {\"kernel\": \"%s\", \"bits\": %d, \"samples\": %d, \"inner\": %ld, \"mean\": %.9e, "
+                "\"stddev\": %.9e, \"min\": %.9e, \"median\": %.9e, \"p90\": %.9e, \"p99\": %.9e, \"max\": %.9e, "
+                "\"ops_per_sec\": %.3f}", first ? "" : ",\n", name, bits, stats->count, stats->inner, stats->mean,
+                stats->stddev, stats->min, stats->median, stats->p90, stats->p99, stats->max, stats->ops);
+    } else {
+        fprintf(out, "%-28s %6d %8d %12.9f %12.9f %12.9f %12.9f %14.3f\n", name, bits, stats->count,
+                stats->mean, stats->median, stats->p90, stats->p99, stats->ops);
+    }
+}
+
+void bench_print_footer(FILE *out, int format) {
+    if (format == BENCH_FORMAT_JSON) {
+        fprintf(out, "\n]\n");
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file bench.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Functions to measure kernels in process (warm up, repetitions and statistics of the samples)
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "utils.h"
+
+/* Minimum duration (seconds) of a sample, fast kernels are called several times per sample */
+#define BENCH_MIN_SAMPLE_TIME 0.001
+
+#define BENCH_FORMAT_TEXT 0
+#define BENCH_FORMAT_CSV 1
+#define BENCH_FORMAT_JSON 2
+
+/**
+ * @brief Kernel to measure, called with the argument given to bench_run
+ */
+typedef void (*bench_kernel)(void *arg);
+
+/**
+ * @brief Statistics of the samples of a kernel (times in seconds per call)
+ */
+typedef struct {
+    int count;          /* Number of samples */
+    long inner;         /* Calls of the kernel per sample */
+    double mean;
+    double stddev;
+    double min;
+    double median;
+    double p90;
+    double p99;
+    double max;
+    double ops;         /* Calls per second (1 / mean) */
+} bench_stats;
+
+/**
+ * @brief Returns the number of calls of the kernel needed for a sample to last BENCH_MIN_SAMPLE_TIME
+ *
+ * @param kernel kernel to measure
+ * @param arg argument of the kernel
+ *
+ * @return long calls per sample (at least 1)
+ */
+long bench_calibrate(bench_kernel kernel, void *arg);
+
+/**
+ * @brief Runs a kernel warmup times without measuring, and then takes repetitions samples of inner calls each
+ *
+ * @param kernel kernel to measure
+ * @param arg argument of the kernel
+ * @param warmup calls before measuring
+ * @param repetitions number of samples
+ * @param inner calls of the kernel per sample
+ * @param samples (return) array of repetitions times, in seconds per call
+ */
+void bench_run(bench_kernel kernel, void *arg, int warmup, int repetitions, long inner, double *samples);
+
+/**
+ * @brief Returns the percentile p of an array sorted in increasing order (linear interpolation)
+ *
+ * @param sorted sorted samples
+ * @param count number of samples
+ * @param p percentile between 0 and 100
+ *
+ * @return double value of the percentile
+ */
+double bench_percentile(const double *sorted, int count, double p);
+
+/**
+ * @brief Computes the statistics of the samples. The array is sorted
+ *
+ * @param samples samples (seconds per call)
+ * @param count number of samples
+ * @param inner calls of the kernel per sample
+ * @param stats (return) statistics
+ */
+void bench_compute_stats(double *samples, int count, long inner, bench_stats *stats);
+
+/**
+ * @brief Prints the header of the results table (nothing for JSON)
+ *
+ * @param out output file
+ * @param format BENCH_FORMAT_TEXT, BENCH_FORMAT_CSV or BENCH_FORMAT_JSON
+ */
+void bench_print_header(FILE *out, int format);
+
+/**
+ * @brief Prints the statistics of a kernel as a row of the table
+ *
+ * @param out output file
+ * @param format BENCH_FORMAT_TEXT, BENCH_FORMAT_CSV or BENCH_FORMAT_JSON
+ * @param name name of the kernel
+ * @param bits size of the numbers
+ * @param stats statistics of the kernel
+ * @param first 1 if it is the first row (JSON needs to know to place the commas)
+ */
+void bench_print_row(FILE *out, int format, const char *name, int bits, const bench_stats *stats, int first);
+
+/**
+ * @brief Prints the end of the results table (closes the JSON array)
+ *
+ * @param out output file
+ * @param format BENCH_FORMAT_TEXT, BENCH_FORMAT_CSV or BENCH_FORMAT_JSON
+ */
+void bench_print_footer(FILE *out, int format);
+
+#endif
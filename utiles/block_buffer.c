@@ -0,0 +1,199 @@
+/**
+ * @file block_buffer.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in block_buffer.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "block_buffer.h"
+
+/* Capacity for len bytes of data and one block of padding, rounded to the alignment */
+static size_t block_buffer_capacity(size_t len, int block_size) {
+    size_t capacity = len + (size_t)block_size;
+
+    return (capacity + BLOCK_BUFFER_ALIGN - 1) / BLOCK_BUFFER_ALIGN * BLOCK_BUFFER_ALIGN;
+}
+
+/* Takes from the pool the smallest allocation of at least capacity bytes */
+static uint8_t *block_pool_take(block_buffer_pool *pool, size_t *capacity) {
+    uint8_t *data = NULL;
+    int best = -1;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->capacity[i] >= *capacity && (best == -1 || pool->capacity[i] < pool->capacity[best])) {
+            best = i;
+        }
+    }
+    if (best != -1) {
+        data = pool->data[best];
+        *capacity = pool->capacity[best];
+        pool->count--;
+        pool->data[best] = pool->data[pool->count];
+        pool->capacity[best] = pool->capacity[pool->count];
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return data;
+}
+
+int block_buffer_init(block_buffer *buffer, int block_size, block_buffer_pool *pool, size_t capacity) {
+    buffer->len = 0;
+    buffer->block_size = block_size;
+    buffer->data = NULL;
+    buffer->capacity = 0;
+
+    if (block_size < 1 || block_size > 255) {
+        return -1;
+    }
+
+    capacity = block_buffer_capacity(capacity, block_size);
+    if (pool != NULL) {
+        buffer->data = block_pool_take(pool, &capacity);
+    }
+    if (buffer->data == NULL && posix_memalign((void **)&buffer->data, BLOCK_BUFFER_ALIGN, capacity) != 0) {
+        printf("Error en la asignacion de memoria\n");
+        buffer->data = NULL;
+        return -1;
+    }
+    buffer->capacity = capacity;
+
+    return 0;
+}
+
+int block_buffer_reserve(block_buffer *buffer, size_t len) {
+    size_t capacity;
+    uint8_t *data;
+
+    if (len + (size_t)buffer->block_size <= buffer->capacity) {
+        return 0;
+    }
+
+    /* Grows at least to double, so appending in chunks does few copies */
+    capacity = block_buffer_capacity(len, buffer->block_size);
+    if (capacity < 2 * buffer->capacity) {
+        capacity = 2 * buffer->capacity;
+    }
+
+    if (posix_memalign((void **)&data, BLOCK_BUFFER_ALIGN, capacity) != 0) {
+        printf("Error en la asignacion de memoria\n");
+        return -1;
+    }
+    if (buffer->len > 0) {
+        memcpy(data, buffer->data, buffer->len);
+    }
+    free(buffer->data);
+    buffer->data = data;
+    buffer->capacity = capacity;
+
+    return 0;
+}
+
+int block_buffer_append(block_buffer *buffer, const uint8_t *data, size_t len) {
+    if (block_buffer_reserve(buffer, buffer->len + len) != 0) {
+        return -1;
+    }
+
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+
+    return 0;
+}
+
+int block_buffer_read(block_buffer *buffer, const char *path) {
+    stream_reader reader;
+    const uint8_t *chunk;
+    long long n;
+
+    if (stream_reader_open(&reader, path) != 0) {
+        return -1;
+    }
+
+    buffer->len = 0;
+    if (reader.mapped && block_buffer_reserve(buffer, (size_t)reader.size) != 0) {
+        stream_reader_close(&reader);
+        return -1;
+    }
+
+    while ((n = stream_reader_next(&reader, &chunk, 0)) > 0) {
+        if (block_buffer_append(buffer, chunk, (size_t)n) != 0) {
+            stream_reader_close(&reader);
+            return -1;
+        }
+    }
+    stream_reader_close(&reader);
+
+    return n < 0 ? -1 : 0;
+}
+
+int block_buffer_pad(block_buffer *buffer, int padding) {
+    int k = buffer->block_size - (int)(buffer->len % buffer->block_size);
+
+    /* The capacity always has room for one block more than the data */
+    if (padding == PADDING_X) {
+        memset(buffer->data + buffer->len, 'x', k);
+    } else if (padding == PADDING_PKCS7) {
+        memset(buffer->data + buffer->len, k, k);
+    } else {
+        return -1;
+    }
+    buffer->len += k;
+
+    return k;
+}
+
+int block_buffer_unpad(block_buffer *buffer) {
+    int k;
+
+    if (buffer->len == 0 || buffer->len % buffer->block_size != 0) {
+        return -1;
+    }
+
+    k = buffer->data[buffer->len - 1];
+    if (k < 1 || k > buffer->block_size) {
+        return -1;
+    }
+    for (int i = 2; i <= k; i++) {
+        if (buffer->data[buffer->len - i] != k) {
+            return -1;
+        }
+    }
+    buffer->len -= k;
+
+    return k;
+}
+
+void block_buffer_free(block_buffer *buffer, block_buffer_pool *pool) {
+    if (buffer->data != NULL && pool != NULL) {
+        pthread_mutex_lock(&pool->mutex);
+        if (pool->count < BLOCK_POOL_SIZE) {
+            pool->data[pool->count] = buffer->data;
+            pool->capacity[pool->count] = buffer->capacity;
+            pool->count++;
+            buffer->data = NULL;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->len = 0;
+    buffer->capacity = 0;
+}
+
+void block_pool_init(block_buffer_pool *pool) {
+    pool->count = 0;
+    pthread_mutex_init(&pool->mutex, NULL);
+}
+
+void block_pool_clear(block_buffer_pool *pool) {
+    for (int i = 0; i < pool->count; i++) {
+        free(pool->data[i]);
+    }
+    pool->count = 0;
+    pthread_mutex_destroy(&pool->mutex);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file block_buffer.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Buffers for the input of the block ciphers. The memory is aligned to BLOCK_BUFFER_ALIGN bytes and
+ *        always has room for one more block, so the padding (the 'x' of addFilling or PKCS#7) is written in
+ *        place without a realloc. The allocations can be kept in a pool and reused for the next file
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef BLOCK_BUFFER_H
+#define BLOCK_BUFFER_H
+
+#include "utils.h"
+#include "stream_io.h"
+
+/* Alignment of the data (cache line, enough for SIMD loads) */
+#define BLOCK_BUFFER_ALIGN 64
+/* Allocations kept by a pool */
+#define BLOCK_POOL_SIZE 8
+
+/* Padding types */
+#define PADDING_X 0         /* 'x' up to the next multiple of the block, as addFilling */
+#define PADDING_PKCS7 1     /* k bytes of value k, 1 <= k <= block size */
+
+/**
+ * @brief Data of a block cipher
+ */
+typedef struct {
+    uint8_t *data;
+    size_t len;             /* Bytes of data */
+    size_t capacity;        /* Bytes allocated, always >= len + block_size */
+    int block_size;
+} block_buffer;
+
+/**
+ * @brief Allocations released to be reused
+ */
+typedef struct {
+    uint8_t *data[BLOCK_POOL_SIZE];
+    size_t capacity[BLOCK_POOL_SIZE];
+    int count;
+    pthread_mutex_t mutex;
+} block_buffer_pool;
+
+/**
+ * @brief Initializes an empty buffer
+ *
+ * @param buffer buffer
+ * @param block_size block size of the cipher (1 to 255)
+ * @param pool pool to take the memory from (NULL to allocate it)
+ * @param capacity bytes of data expected (the room for the padding is added)
+ *
+ * @return int 0 if the buffer was initialized, -1 otherwise
+ */
+int block_buffer_init(block_buffer *buffer, int block_size, block_buffer_pool *pool, size_t capacity);
+
+/**
+ * @brief Makes sure there is room for len bytes of data plus the padding. The data is kept
+ *
+ * @param buffer buffer
+ * @param len bytes of data
+ *
+ * @return int 0 if there is room, -1 otherwise
+ */
+int block_buffer_reserve(block_buffer *buffer, size_t len);
+
+/**
+ * @brief Appends bytes to the data
+ *
+ * @param buffer buffer
+ * @param data bytes to append
+ * @param len number of bytes
+ *
+ * @return int 0 if the bytes were appended, -1 otherwise
+ */
+int block_buffer_append(block_buffer *buffer, const uint8_t *data, size_t len);
+
+/**
+ * @brief Reads a file into the buffer (replacing its data). The capacity is reserved once from the size of
+ *        the file, including the room for the padding
+ *
+ * @param buffer buffer
+ * @param path name of the file. If it is NULL the standard input is read
+ *
+ * @return int 0 if the file was read, -1 otherwise
+ */
+int block_buffer_read(block_buffer *buffer, const char *path);
+
+/**
+ * @brief Pads the data in place to a multiple of the block size
+ *
+ * @param buffer buffer
+ * @param padding PADDING_X or PADDING_PKCS7
+ *
+ * @return int number of bytes added, -1 if the padding type is not valid
+ */
+int block_buffer_pad(block_buffer *buffer, int padding);
+
+/**
+ * @brief Removes a PKCS#7 padding
+ *
+ * @param buffer buffer
+ *
+ * @return int number of bytes removed, -1 if the padding is not valid
+ */
+int block_buffer_unpad(block_buffer *buffer);
+
+/**
+ * @brief Frees a buffer, or gives its memory to a pool
+ *
+ * @param buffer buffer
+ * @param pool pool to keep the memory (NULL to free it)
+ */
+void block_buffer_free(block_buffer *buffer, block_buffer_pool *pool);
+
+/**
+ * @brief Initializes an empty pool
+ *
+ * @param pool pool
+ */
+void block_pool_init(block_buffer_pool *pool);
+
+/**
+ * @brief Frees the memory kept by a pool
+ *
+ * @param pool pool
+ */
+void block_pool_clear(block_buffer_pool *pool);
+
+#endif
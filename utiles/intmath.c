@@ -0,0 +1,107 @@
+/**
+ * @file intmath.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in intmath.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "intmath.h"
+
+/* Binary gcd of two unsigned numbers. The loop has no branches apart from its condition: the smaller number
+   is kept and the difference (even) is shifted until it is odd */
+static unsigned int gcd_unsigned(unsigned int a, unsigned int b) {
+    unsigned int d;
+    int shift;
+
+    if (a == 0 || b == 0) {
+        return a | b;
+    }
+
+    shift = __builtin_ctz(a | b);
+    a >>= __builtin_ctz(a);
+
+    while (b != 0) {
+        b >>= __builtin_ctz(b);
+        d = b - a;
+        a = a < b ? a : b;
+        b = d > b ? 0u - d : d;
+    }
+
+    return a << shift;
+}
+
+static unsigned int absolute(int a) {
+    return a < 0 ? 0u - (unsigned int)a : (unsigned int)a;
+}
+
+int int_gcd(int a, int b) {
+    return (int)gcd_unsigned(absolute(a), absolute(b));
+}
+
+int int_gcd_list(const int *numbers, int size) {
+    unsigned int result = absolute(numbers[0]);
+
+    for (int i = 1; i < size && result != 1; i++) {
+        result = gcd_unsigned(result, absolute(numbers[i]));
+    }
+
+    return (int)result;
+}
+
+int int_extended_gcd(int a, int b, int *x, int *y) {
+    long long r0 = a, r1 = b, x0 = 1, x1 = 0, y0 = 0, y1 = 1, q, aux;
+
+    while (r1 != 0) {
+        q = r0 / r1;
+        aux = r0 - q * r1; r0 = r1; r1 = aux;
+        aux = x0 - q * x1; x0 = x1; x1 = aux;
+        aux = y0 - q * y1; y0 = y1; y1 = aux;
+    }
+
+    *x = (int)x0;
+    *y = (int)y0;
+
+    return (int)r0;
+}
+
+int int_inverse(int a, int m) {
+    long long r0 = m, r1 = a % m, t0 = 0, t1 = 1, q, aux;
+
+    if (r1 < 0) {
+        r1 += m;
+    }
+
+    /* Only the coefficient of a is needed: t_i * a = r_i (mod m) */
+    while (r1 != 0) {
+        q = r0 / r1;
+        aux = r0 - q * r1; r0 = r1; r1 = aux;
+        aux = t0 - q * t1; t0 = t1; t1 = aux;
+    }
+
+    if (r0 != 1) {
+        return -1;
+    }
+
+    return (int)(t0 < 0 ? t0 + m : t0);
+}
+
+void int_gcd_batch(int *out, const int *a, const int *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (int)gcd_unsigned(absolute(a[i]), absolute(b[i]));
+    }
+}
+
+size_t int_inverse_batch(int *out, const int *a, size_t n, int m) {
+    size_t invertible = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = int_inverse(a[i], m);
+        invertible += out[i] != -1;
+    }
+
+    return invertible;
+}
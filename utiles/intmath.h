@@ -0,0 +1,80 @@
+/**
+ * @file intmath.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Number theory on native integers for the keys of the classic ciphers (determinants of Hill matrices,
+ *        multipliers of affine ciphers): binary gcd with __builtin_ctz, extended Euclides with two coefficients
+ *        (no arrays, no memory), and the same operations over arrays. Negative arguments are taken by their
+ *        absolute value in the gcd and reduced modulo m in the inverse
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef INTMATH_H
+#define INTMATH_H
+
+#include "utils.h"
+
+/**
+ * @brief Greatest common divisor with the binary algorithm: the common powers of 2 are taken out with ctz and
+ *        then the odd numbers are only subtracted and shifted
+ *
+ * @param a first number
+ * @param b second number
+ * @return int gcd(|a|, |b|), 0 if both are 0
+ */
+int int_gcd(int a, int b);
+
+/**
+ * @brief Greatest common divisor of the numbers of an array. It stops as soon as it reaches 1
+ *
+ * @param numbers numbers
+ * @param size number of numbers, greater than 0
+ * @return int gcd of all of them
+ */
+int int_gcd_list(const int *numbers, int size);
+
+/**
+ * @brief Extended Euclides: g = gcd(a, b) and the coefficients x, y with a*x + b*y = g
+ *
+ * @param a first number, 0 or greater
+ * @param b second number, 0 or greater
+ * @param x (return) coefficient of a
+ * @param y (return) coefficient of b
+ * @return int gcd(a, b)
+ */
+int int_extended_gcd(int a, int b, int *x, int *y);
+
+/**
+ * @brief Inverse of a modulo m with the extended Euclides algorithm, keeping only the coefficient of a
+ *
+ * @param a number, it may be negative or greater than m
+ * @param m modulus, greater than 1
+ * @return int inverse in [0, m), -1 if a and m are not coprime
+ */
+int int_inverse(int a, int m);
+
+/**
+ * @brief gcd of n pairs: out[i] = gcd(a[i], b[i])
+ *
+ * @param out (return) gcds, n entries
+ * @param a first numbers
+ * @param b second numbers
+ * @param n number of pairs
+ */
+void int_gcd_batch(int *out, const int *a, const int *b, size_t n);
+
+/**
+ * @brief Inverses of n numbers modulo the same m: out[i] = int_inverse(a[i], m)
+ *
+ * @param out (return) inverses, -1 for the numbers that are not coprime with m
+ * @param a numbers
+ * @param n number of numbers
+ * @param m modulus, greater than 1
+ * @return size_t number of numbers that have an inverse
+ */
+size_t int_inverse_batch(int *out, const int *a, size_t n, int m);
+
+#endif
@@ -0,0 +1,712 @@
+/**
+ * @file montgomery.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in montgomery.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "montgomery.h"
+
+/* Copies src into dst as n limbs, filling with zeros. src must fit in n limbs */
+static void mpz_to_limbs(mp_limb_t *dst, const mpz_t src, mp_size_t n) {
+    mp_size_t size = mpz_size(src);
+
+    if (size > 0) {
+        memcpy(dst, mpz_limbs_read(src), size * sizeof(mp_limb_t));
+    }
+    if (size < n) {
+        memset(dst + size, 0, (n - size) * sizeof(mp_limb_t));
+    }
+}
+
+/* Montgomery reduction r = t*R^-1 mod n of t (2*size limbs, destroyed), for t < n*R */
+static void montgomery_redc(const montgomery_ctx *ctx, mp_limb_t *r, mp_limb_t *t) {
+    mp_size_t n = ctx->size;
+    mp_limb_t cy;
+
+    /* Each step clears the limb t[i], the carry of the step is kept in t[i] and added at the end */
+    for (mp_size_t i = 0; i < n; i++) {
+        t[i] = mpn_addmul_1(t + i, ctx->mod, n, t[i] * ctx->minv);
+    }
+
+    cy = mpn_add_n(r, t + n, t, n);
+
+    /* The result is lower than 2n, at most one subtraction is needed */
+    if (cy != 0 || mpn_cmp(r, ctx->mod, n) >= 0) {
+        mpn_sub_n(r, r, ctx->mod, n);
+    }
+}
+
+int montgomery_init(montgomery_ctx *ctx, const mpz_t mod) {
+    mp_size_t n;
+    mp_limb_t inv;
+    mpz_t aux;
+
+    if (mpz_cmp_ui(mod, 1) <= 0 || mpz_even_p(mod)) {
+        return -1;
+    }
+
+    n = mpz_size(mod);
+    ctx->size = n;
+
+    /* One block for the modulus, R^2 mod n and R mod n */
+    ctx->mod = (mp_limb_t *)malloc(3 * n * sizeof(mp_limb_t));
+    if (ctx->mod == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        return -1;
+    }
+    ctx->r2 = ctx->mod + n;
+    ctx->one = ctx->mod + 2 * n;
+
+    mpz_init_set(ctx->modulus, mod);
+    mpz_to_limbs(ctx->mod, mod, n);
+
+    /* Newton iteration for n^-1 mod 2^GMP_NUMB_BITS, each step doubles the correct bits (3 at start) */
+    inv = ctx->mod[0];
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - ctx->mod[0] * inv;
+    }
+    ctx->minv = -inv;
+
+    mpz_init(aux);
+
+    mpz_setbit(aux, 2 * n * GMP_NUMB_BITS);
+    mpz_mod(aux, aux, mod);
+    mpz_to_limbs(ctx->r2, aux, n);
+
+    mpz_set_ui(aux, 0);
+    mpz_setbit(aux, n * GMP_NUMB_BITS);
+    mpz_mod(aux, aux, mod);
+    mpz_to_limbs(ctx->one, aux, n);
+
+    mpz_clear(aux);
+
+    return 0;
+}
+
+void montgomery_clear(montgomery_ctx *ctx) {
+    free(ctx->mod);
+    mpz_clear(ctx->modulus);
+    ctx->mod = NULL;
+    ctx->r2 = NULL;
+    ctx->one = NULL;
+}
+
+void montgomery_mul(const montgomery_ctx *ctx, mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, mp_limb_t *scratch) {
+    mpn_mul_n(scratch, a, b, ctx->size);
+    montgomery_redc(ctx, r, scratch);
+}
+
+void montgomery_sqr(const montgomery_ctx *ctx, mp_limb_t *r, const mp_limb_t *a, mp_limb_t *scratch) {
+    mpn_sqr(scratch, a, ctx->size);
+    montgomery_redc(ctx, r, scratch);
+}
+
+void montgomery_to(const montgomery_ctx *ctx, mp_limb_t *r, const mpz_t a, mp_limb_t *scratch) {
+    /* a*R = REDC(a * R^2) */
+    mpz_to_limbs(r, a, ctx->size);
+    montgomery_mul(ctx, r, r, ctx->r2, scratch);
+}
+
+void montgomery_from(const montgomery_ctx *ctx, mpz_t r, const mp_limb_t *a, mp_limb_t *scratch) {
+    mp_size_t n = ctx->size;
+    mp_limb_t *rp;
+
+    /* a*R^-1 = REDC(a) */
+    memcpy(scratch, a, n * sizeof(mp_limb_t));
+    memset(scratch + n, 0, n * sizeof(mp_limb_t));
+
+    rp = mpz_limbs_write(r, n);
+    montgomery_redc(ctx, rp, scratch);
+    mpz_limbs_finish(r, n);
+}
+
+int montgomery_window_size(size_t bits) {
+    /* Thresholds where a bigger table starts to save multiplications */
+    static const size_t thresholds[MONTGOMERY_MAX_WINDOW - 1] = {7, 25, 81, 241, 673, 1793, 4609};
+    int window = 1;
+
+    while (window < MONTGOMERY_MAX_WINDOW && bits > thresholds[window - 1]) {
+        window++;
+    }
+
+    return window;
+}
+
+int montgomery_exp_init(montgomery_exp *plan, const mpz_t exp, int window) {
+    long top, low, j;
+    size_t bits;
+    unsigned int pending = 0;
+    unsigned short value;
+
+    if (mpz_sgn(exp) < 0) {
+        return -1;
+    }
+
+    bits = mpz_sgn(exp) == 0 ? 0 : mpz_sizeinbase(exp, 2);
+
+    if (window == 0) {
+        window = montgomery_window_size(bits);
+    }
+    if (window < 1 || window > MONTGOMERY_MAX_WINDOW) {
+        return -1;
+    }
+
+    plan->window = window;
+    plan->count = 0;
+    plan->tail = 0;
+
+    /* In the worst case there is one window per bit */
+    plan->digit = (unsigned short *)malloc((bits + 1) * sizeof(unsigned short));
+    plan->squarings = (unsigned int *)malloc((bits + 1) * sizeof(unsigned int));
+    if (plan->digit == NULL || plan->squarings == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        free(plan->digit);
+        free(plan->squarings);
+        return -1;
+    }
+
+    /* From the most significant bit, take windows that start and end with a 1 */
+    top = (long)bits - 1;
+    while (top >= 0) {
+        if (!mpz_tstbit(exp, top)) {
+            pending++;
+            top--;
+            continue;
+        }
+
+        low = top - window + 1;
+        if (low < 0) {
+            low = 0;
+        }
+        while (!mpz_tstbit(exp, low)) {
+            low++;
+        }
+
+        value = 0;
+        for (j = top; j >= low; j--) {
+            value = (value << 1) | mpz_tstbit(exp, j);
+        }
+
+        pending += top - low + 1;
+        plan->digit[plan->count] = value;
+        plan->squarings[plan->count] = plan->count == 0 ? 0 : pending;
+        plan->count++;
+        pending = 0;
+
+        top = low - 1;
+    }
+
+    plan->tail = pending;
+
+    return 0;
+}
+
+void montgomery_exp_clear(montgomery_exp *plan) {
+    free(plan->digit);
+    free(plan->squarings);
+    plan->digit = NULL;
+    plan->squarings = NULL;
+    plan->count = 0;
+}
+
+mp_size_t montgomery_powm_itch(const montgomery_ctx *ctx, int window) {
+    /* scratch (2n) + accumulator (n) + table of 2^(window-1) odd powers */
+    return (3 + ((mp_size_t)1 << (window - 1))) * ctx->size;
+}
+
+void montgomery_powm(const montgomery_ctx *ctx, const montgomery_exp *plan, mpz_t result, const mpz_t base, mp_limb_t *work) {
+    mp_size_t n = ctx->size;
+    mp_size_t table_size = (mp_size_t)1 << (plan->window - 1);
+    mp_limb_t *scratch = work;
+    mp_limb_t *acc = work + 2 * n;
+    mp_limb_t *table = work + 3 * n;
+    unsigned int s;
+
+    if (plan->count == 0) {
+        mpz_set_ui(result, 1);
+        return;
+    }
+
+    /* table[k] = base^(2k+1) */
+    montgomery_to(ctx, table, base, scratch);
+    if (table_size > 1) {
+        montgomery_sqr(ctx, acc, table, scratch);
+        for (mp_size_t k = 1; k < table_size; k++) {
+            montgomery_mul(ctx, table + k * n, table + (k - 1) * n, acc, scratch);
+        }
+    }
+
+    memcpy(acc, table + (plan->digit[0] >> 1) * n, n * sizeof(mp_limb_t));
+
+    for (int i = 1; i < plan->count; i++) {
+        for (s = 0; s < plan->squarings[i]; s++) {
+            montgomery_sqr(ctx, acc, acc, scratch);
+        }
+        montgomery_mul(ctx, acc, acc, table + (plan->digit[i] >> 1) * n, scratch);
+    }
+
+    for (s = 0; s < plan->tail; s++) {
+        montgomery_sqr(ctx, acc, acc, scratch);
+    }
+
+    montgomery_from(ctx, result, acc, scratch);
+}
+
+void potencia_modular_montgomery(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
+    montgomery_ctx ctx;
+    montgomery_exp plan;
+    mp_limb_t *work;
+    mpz_t base_mod;
+
+    if (montgomery_init(&ctx, mod) == -1) {
+        potencia_modular(result, base, exp, mod);
+        return;
+    }
+
+    if (montgomery_exp_init(&plan, exp, 0) == -1) {
+        montgomery_clear(&ctx);
+        potencia_modular(result, base, exp, mod);
+        return;
+    }
+
+    work = (mp_limb_t *)malloc(montgomery_powm_itch(&ctx, plan.window) * sizeof(mp_limb_t));
+    if (work == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    mpz_init(base_mod);
+    mpz_mod(base_mod, base, mod);
+
+    montgomery_powm(&ctx, &plan, result, base_mod, work);
+
+    mpz_clear(base_mod);
+    free(work);
+    montgomery_exp_clear(&plan);
+    montgomery_clear(&ctx);
+}
+
+/* Returns the bits [pos, pos + w) of a number of size limbs */
+static unsigned int get_limb_bits(const mp_limb_t *limbs, mp_size_t size, size_t pos, int w) {
+    mp_size_t index = pos / GMP_NUMB_BITS;
+    unsigned int shift = pos % GMP_NUMB_BITS;
+    mp_limb_t value;
+
+    if (index >= size) {
+        return 0;
+    }
+
+    value = limbs[index] >> shift;
+    /* The digit continues in the next limb */
+    if (shift + w > GMP_NUMB_BITS && index + 1 < size) {
+        value |= limbs[index + 1] << (GMP_NUMB_BITS - shift);
+    }
+
+    return (unsigned int)(value & (((mp_limb_t)1 << w) - 1));
+}
+
+int montgomery_fixed_base_init(montgomery_fixed_base *fb, const montgomery_ctx *ctx, const mpz_t base, size_t max_bits, int window) {
+    mp_size_t n = ctx->size;
+    mp_size_t entries;
+    mp_limb_t *scratch, *entry;
+
+    if (window == 0) {
+        window = MONTGOMERY_FIXED_BASE_WINDOW;
+    }
+    if (window < 1 || window > MONTGOMERY_MAX_WINDOW || max_bits == 0) {
+        return -1;
+    }
+
+    fb->ctx = ctx;
+    fb->window = window;
+    fb->max_bits = max_bits;
+    fb->digits = (int)((max_bits + window - 1) / window);
+
+    entries = ((mp_size_t)1 << window) - 1;
+    fb->table = (mp_limb_t *)malloc(fb->digits * entries * n * sizeof(mp_limb_t));
+    scratch = (mp_limb_t *)malloc(2 * n * sizeof(mp_limb_t));
+    if (fb->table == NULL || scratch == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        free(fb->table);
+        free(scratch);
+        return -1;
+    }
+
+    /* Row i: g^1, g^2, ..., g^(2^window - 1) with g = base^(2^(i*window)) */
+    montgomery_to(ctx, fb->table, base, scratch);
+
+    for (int i = 0; i < fb->digits; i++) {
+        entry = fb->table + i * entries * n;
+
+        for (mp_size_t j = 1; j < entries; j++) {
+            montgomery_mul(ctx, entry + j * n, entry + (j - 1) * n, entry, scratch);
+        }
+
+        /* g of the next row is g^(2^window) = g^(2^window - 1) * g */
+        if (i + 1 < fb->digits) {
+            montgomery_mul(ctx, entry + entries * n, entry + (entries - 1) * n, entry, scratch);
+        }
+    }
+
+    free(scratch);
+
+    return 0;
+}
+
+void montgomery_fixed_base_clear(montgomery_fixed_base *fb) {
+    free(fb->table);
+    fb->table = NULL;
+    fb->digits = 0;
+}
+
+mp_size_t montgomery_fixed_base_itch(const montgomery_ctx *ctx) {
+    /* scratch (2n) + accumulator (n) */
+    return 3 * ctx->size;
+}
+
+int montgomery_fixed_base_powm(const montgomery_fixed_base *fb, mpz_t result, const mpz_t exp, mp_limb_t *work) {
+    const montgomery_ctx *ctx = fb->ctx;
+    mp_size_t n = ctx->size;
+    mp_size_t entries = ((mp_size_t)1 << fb->window) - 1;
+    mp_size_t exp_size = mpz_size(exp);
+    const mp_limb_t *exp_limbs = mpz_limbs_read(exp);
+    mp_limb_t *scratch = work;
+    mp_limb_t *acc = work + 2 * n;
+    unsigned int digit;
+    int first = 1;
+
+    if (mpz_sgn(exp) < 0 || mpz_sizeinbase(exp, 2) > fb->max_bits) {
+        return -1;
+    }
+
+    /* base^exp = prod base^(digit_i * 2^(i*window)), one multiplication per non zero digit */
+    for (int i = 0; i < fb->digits; i++) {
+        digit = get_limb_bits(exp_limbs, exp_size, (size_t)i * fb->window, fb->window);
+        if (digit == 0) {
+            continue;
+        }
+
+        if (first) {
+            memcpy(acc, fb->table + (i * entries + digit - 1) * n, n * sizeof(mp_limb_t));
+            first = 0;
+        } else {
+            montgomery_mul(ctx, acc, acc, fb->table + (i * entries + digit - 1) * n, scratch);
+        }
+    }
+
+    if (first) {
+        mpz_set_ui(result, 1);
+        return 0;
+    }
+
+    montgomery_from(ctx, result, acc, scratch);
+
+    return 0;
+}
+
+/* Sliding window recoding of exp: digits[pos] is the odd value of the window that ends at bit pos, 0 if none */
+static void sliding_window_digits(const mpz_t exp, int window, unsigned short *digits, size_t bits) {
+    long top, low, j;
+    unsigned short value;
+
+    memset(digits, 0, bits * sizeof(unsigned short));
+
+    top = mpz_sgn(exp) == 0 ? -1 : (long)mpz_sizeinbase(exp, 2) - 1;
+    while (top >= 0) {
+        if (!mpz_tstbit(exp, top)) {
+            top--;
+            continue;
+        }
+
+        low = top - window + 1;
+        if (low < 0) {
+            low = 0;
+        }
+        while (!mpz_tstbit(exp, low)) {
+            low++;
+        }
+
+        value = 0;
+        for (j = top; j >= low; j--) {
+            value = (value << 1) | mpz_tstbit(exp, j);
+        }
+        digits[low] = value;
+
+        top = low - 1;
+    }
+}
+
+mp_size_t montgomery_multi_powm_itch(const montgomery_ctx *ctx, int count, int window) {
+    /* scratch (2n) + accumulator (n) + one table of 2^(window-1) odd powers per base */
+    return (3 + count * ((mp_size_t)1 << (window - 1))) * ctx->size;
+}
+
+int montgomery_multi_powm(const montgomery_ctx *ctx, mpz_t result, mpz_t *bases, mpz_t *exps, int count, int window, mp_limb_t *work) {
+    mp_size_t n = ctx->size;
+    mp_size_t table_size = (mp_size_t)1 << (window - 1);
+    mp_limb_t *scratch = work;
+    mp_limb_t *acc = work + 2 * n;
+    mp_limb_t *table, *tables = work + 3 * n;
+    unsigned short *digits;
+    size_t bits = 0, size;
+    long pos;
+    int started = 0;
+
+    if (count <= 0 || window < 1 || window > MONTGOMERY_MAX_WINDOW) {
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (mpz_sgn(exps[i]) < 0) {
+            return -1;
+        }
+        size = mpz_sgn(exps[i]) == 0 ? 0 : mpz_sizeinbase(exps[i], 2);
+        if (size > bits) {
+            bits = size;
+        }
+    }
+
+    if (bits == 0) {
+        mpz_set_ui(result, 1);
+        return 0;
+    }
+
+    digits = (unsigned short *)malloc(count * bits * sizeof(unsigned short));
+    if (digits == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        return -1;
+    }
+
+    /* Table of odd powers and recoding of every base */
+    for (int i = 0; i < count; i++) {
+        table = tables + i * table_size * n;
+
+        montgomery_to(ctx, table, bases[i], scratch);
+        if (table_size > 1) {
+            montgomery_sqr(ctx, acc, table, scratch);
+            for (mp_size_t k = 1; k < table_size; k++) {
+                montgomery_mul(ctx, table + k * n, table + (k - 1) * n, acc, scratch);
+            }
+        }
+
+        sliding_window_digits(exps[i], window, digits + i * bits, bits);
+    }
+
+    /* One shared square per bit, and one multiplication for each window that ends in that bit */
+    for (pos = (long)bits - 1; pos >= 0; pos--) {
+        if (started) {
+            montgomery_sqr(ctx, acc, acc, scratch);
+        }
+
+        for (int i = 0; i < count; i++) {
+            unsigned short digit = digits[i * bits + pos];
+            if (digit == 0) {
+                continue;
+            }
+
+            table = tables + (i * table_size + (digit >> 1)) * n;
+            if (started) {
+                montgomery_mul(ctx, acc, acc, table, scratch);
+            } else {
+                memcpy(acc, table, n * sizeof(mp_limb_t));
+                started = 1;
+            }
+        }
+    }
+
+    montgomery_from(ctx, result, acc, scratch);
+
+    free(digits);
+
+    return 0;
+}
+
+int potencia_modular_multi(mpz_t result, mpz_t *bases, mpz_t *exps, int count, const mpz_t mod) {
+    montgomery_ctx ctx;
+    mp_limb_t *work;
+    mpz_t *bases_mod, aux;
+    size_t bits = 1;
+    int window, error;
+
+    if (count <= 0 || mpz_cmp_ui(mod, 1) <= 0) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (mpz_sgn(exps[i]) < 0) {
+            return -1;
+        }
+    }
+
+    if (montgomery_init(&ctx, mod) == -1) {
+        /* Even modulus: independent exponentiations */
+        mpz_init(aux);
+        mpz_set_ui(result, 1);
+        for (int i = 0; i < count; i++) {
+            potencia_modular(aux, bases[i], exps[i], mod);
+            mpz_mul(result, result, aux);
+            mpz_mod(result, result, mod);
+        }
+        mpz_clear(aux);
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (mpz_sgn(exps[i]) > 0 && mpz_sizeinbase(exps[i], 2) > bits) {
+            bits = mpz_sizeinbase(exps[i], 2);
+        }
+    }
+
+    /* Each base has its own table, so the window is one bit smaller than for a single base */
+    window = montgomery_window_size(bits) - 1;
+    if (window < 1) {
+        window = 1;
+    }
+
+    bases_mod = (mpz_t *)malloc(count * sizeof(mpz_t));
+    work = (mp_limb_t *)malloc(montgomery_multi_powm_itch(&ctx, count, window) * sizeof(mp_limb_t));
+    if (bases_mod == NULL || work == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < count; i++) {
+        mpz_init(bases_mod[i]);
+        mpz_mod(bases_mod[i], bases[i], mod);
+    }
+
+    error = montgomery_multi_powm(&ctx, result, bases_mod, exps, count, window, work);
+
+    for (int i = 0; i < count; i++) {
+        mpz_clear(bases_mod[i]);
+    }
+    free(bases_mod);
+    free(work);
+    montgomery_clear(&ctx);
+
+    return error;
+}
+
+/* Montgomery reduction without branches on the data: the final subtraction is always computed and
+   selected with a conditional swap */
+static void montgomery_redc_sec(const montgomery_ctx *ctx, mp_limb_t *r, mp_limb_t *t) {
+    mp_size_t n = ctx->size;
+    mp_limb_t cy, borrow;
+
+    for (mp_size_t i = 0; i < n; i++) {
+        t[i] = mpn_addmul_1(t + i, ctx->mod, n, t[i] * ctx->minv);
+    }
+
+    cy = mpn_add_n(r, t + n, t, n);
+
+    /* The low half of t is free, r - n goes there and replaces r if r + cy*R >= n */
+    borrow = mpn_sub_n(t, r, ctx->mod, n);
+    mpn_cnd_swap(cy | (borrow ^ 1), r, t, n);
+}
+
+/* Limbs of the work area of mpn_sec_mul and mpn_sec_sqr for n limb operands */
+static mp_size_t montgomery_sec_itch(mp_size_t n) {
+    mp_size_t itch = mpn_sec_mul_itch(n, n);
+
+    return mpn_sec_sqr_itch(n) > itch ? mpn_sec_sqr_itch(n) : itch;
+}
+
+mp_size_t montgomery_ladder_itch(const montgomery_ctx *ctx) {
+    /* scratch (2n) + R0 (n) + R1 (n) + work area of mpn_sec_mul and mpn_sec_sqr */
+    return 4 * ctx->size + montgomery_sec_itch(ctx->size);
+}
+
+int montgomery_ladder_exp(const montgomery_ctx *ctx, mp_limb_t *e, const mpz_t exp) {
+    if (mpz_sgn(exp) < 0 || (mp_size_t)mpz_size(exp) > ctx->size) {
+        return -1;
+    }
+
+    mpz_to_limbs(e, exp, ctx->size);
+
+    return 0;
+}
+
+void montgomery_ladder_powm_limbs(const montgomery_ctx *ctx, mp_limb_t *r, const mp_limb_t *base, const mp_limb_t *e,
+                                  mp_limb_t *work) {
+    mp_size_t n = ctx->size;
+    mp_limb_t *scratch = work;
+    mp_limb_t *r0 = work + 2 * n;
+    mp_limb_t *r1 = work + 3 * n;
+    mp_limb_t *tp = work + 4 * n;
+    mp_limb_t bit;
+
+    /* R0 = 1, R1 = base (Montgomery form) */
+    memcpy(r0, ctx->one, n * sizeof(mp_limb_t));
+    mpn_sec_mul(scratch, base, n, ctx->r2, n, tp);
+    montgomery_redc_sec(ctx, r1, scratch);
+
+    /* Invariant R1 = R0 * base. Every bit does one product and one square, whatever its value, and the
+       mpn_sec functions never switch to algorithms (Toom) whose branches depend on the operands */
+    for (mp_size_t i = n; i-- > 0; ) {
+        for (int j = GMP_NUMB_BITS - 1; j >= 0; j--) {
+            bit = (e[i] >> j) & 1;
+
+            mpn_cnd_swap(bit, r0, r1, n);
+            mpn_sec_mul(scratch, r0, n, r1, n, tp);
+            montgomery_redc_sec(ctx, r1, scratch);
+            mpn_sec_sqr(scratch, r0, n, tp);
+            montgomery_redc_sec(ctx, r0, scratch);
+            mpn_cnd_swap(bit, r0, r1, n);
+        }
+    }
+
+    /* r = R0 * R^-1 */
+    memcpy(scratch, r0, n * sizeof(mp_limb_t));
+    memset(scratch + n, 0, n * sizeof(mp_limb_t));
+    montgomery_redc_sec(ctx, r, scratch);
+}
+
+void montgomery_ladder_powm(const montgomery_ctx *ctx, mpz_t result, const mpz_t base, const mp_limb_t *e, mp_limb_t *work) {
+    mp_limb_t *rp = mpz_limbs_write(result, ctx->size);
+
+    /* The base is public, it is read into the limbs of the result */
+    mpz_to_limbs(rp, base, ctx->size);
+    montgomery_ladder_powm_limbs(ctx, rp, rp, e, work);
+    mpz_limbs_finish(result, ctx->size);
+}
+
+int potencia_modular_sec(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
+    montgomery_ctx ctx;
+    mp_limb_t *work, *e;
+    mpz_t base_mod;
+
+    if (montgomery_init(&ctx, mod) == -1) {
+        return -1;
+    }
+
+    work = (mp_limb_t *)malloc((montgomery_ladder_itch(&ctx) + ctx.size) * sizeof(mp_limb_t));
+    if (work == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+    e = work + montgomery_ladder_itch(&ctx);
+
+    /* Exponent negative or with more limbs than the modulus */
+    if (montgomery_ladder_exp(&ctx, e, exp) == -1) {
+        free(work);
+        montgomery_clear(&ctx);
+        return -1;
+    }
+
+    mpz_init(base_mod);
+    mpz_mod(base_mod, base, mod);
+    montgomery_ladder_powm(&ctx, result, base_mod, e, work);
+
+    /* The exponent is secret, it is not left in memory */
+    memset(e, 0, ctx.size * sizeof(mp_limb_t));
+
+    mpz_clear(base_mod);
+    free(work);
+    montgomery_clear(&ctx);
+
+    return 0;
+}
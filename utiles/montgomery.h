@@ -0,0 +1,325 @@
+/**
+ * @file montgomery.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Modular exponentiation with Montgomery multiplication over GMP limbs (mpn layer). The context of
+ *        a modulus and the recoding of an exponent are computed once and can be reused for many bases
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include "utils.h"
+
+/* Maximum window size of the sliding window exponentiation */
+#define MONTGOMERY_MAX_WINDOW 8
+
+/**
+ * @brief Montgomery context of an odd modulus n, with R = 2^(size*GMP_NUMB_BITS)
+ */
+typedef struct {
+    mp_size_t size;     /* Limbs of the modulus */
+    mp_limb_t *mod;     /* Modulus n (size limbs) */
+    mp_limb_t minv;     /* -n^-1 mod 2^GMP_NUMB_BITS */
+    mp_limb_t *r2;      /* R^2 mod n (size limbs) */
+    mp_limb_t *one;     /* R mod n, 1 in Montgomery form (size limbs) */
+    mpz_t modulus;      /* Modulus n as mpz */
+} montgomery_ctx;
+
+/**
+ * @brief Sliding window recoding of an exponent. The exponentiation starts with the power of the first
+ *        window, and for every next window squares the accumulator squarings[i] times and multiplies
+ *        by base^digit[i] (digit[i] is always odd). At the end it squares tail more times
+ */
+typedef struct {
+    int window;                 /* Size of the window */
+    int count;                  /* Number of windows */
+    unsigned short *digit;      /* Odd value of each window */
+    unsigned int *squarings;    /* Squarings before each window (the first one is not used) */
+    unsigned int tail;          /* Squarings after the last window */
+} montgomery_exp;
+
+/* Default window of the fixed base tables */
+#define MONTGOMERY_FIXED_BASE_WINDOW 4
+
+/**
+ * @brief Precomputed powers of a fixed base: entry (i, j) is base^(j * 2^(i*window)) in Montgomery form,
+ *        for j between 1 and 2^window - 1. An exponent split in digits of window bits is evaluated with
+ *        one multiplication per non zero digit and no squarings
+ */
+typedef struct {
+    const montgomery_ctx *ctx;  /* Context of the modulus (must outlive the table) */
+    int window;                 /* Bits per digit of the exponent */
+    int digits;                 /* Digits covered by the table */
+    size_t max_bits;            /* Maximum size of the exponents */
+    mp_limb_t *table;           /* digits * (2^window - 1) numbers of ctx->size limbs */
+} montgomery_fixed_base;
+
+/**
+ * @brief Initializes the Montgomery context of a modulus
+ *
+ * @param ctx context to initialize
+ * @param mod odd modulus greater than 1
+ *
+ * @return int 0 if the context was initialized, -1 if the modulus is not valid
+ */
+int montgomery_init(montgomery_ctx *ctx, const mpz_t mod);
+
+/**
+ * @brief Frees a Montgomery context
+ *
+ * @param ctx context to free
+ */
+void montgomery_clear(montgomery_ctx *ctx);
+
+/**
+ * @brief Montgomery product r = a*b*R^-1 mod n. r may be the same array as a or b
+ *
+ * @param ctx context of the modulus
+ * @param r (return) result, size limbs
+ * @param a first factor in Montgomery form, size limbs
+ * @param b second factor in Montgomery form, size limbs
+ * @param scratch work area of 2*size limbs
+ */
+void montgomery_mul(const montgomery_ctx *ctx, mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, mp_limb_t *scratch);
+
+/**
+ * @brief Montgomery square r = a*a*R^-1 mod n. r may be the same array as a
+ *
+ * @param ctx context of the modulus
+ * @param r (return) result, size limbs
+ * @param a number in Montgomery form, size limbs
+ * @param scratch work area of 2*size limbs
+ */
+void montgomery_sqr(const montgomery_ctx *ctx, mp_limb_t *r, const mp_limb_t *a, mp_limb_t *scratch);
+
+/**
+ * @brief Converts a number to Montgomery form, r = a*R mod n
+ *
+ * @param ctx context of the modulus
+ * @param r (return) a in Montgomery form, size limbs
+ * @param a number to convert, 0 <= a < n
+ * @param scratch work area of 2*size limbs
+ */
+void montgomery_to(const montgomery_ctx *ctx, mp_limb_t *r, const mpz_t a, mp_limb_t *scratch);
+
+/**
+ * @brief Converts a number from Montgomery form, r = a*R^-1 mod n
+ *
+ * @param ctx context of the modulus
+ * @param r (return) result
+ * @param a number in Montgomery form, size limbs
+ * @param scratch work area of 2*size limbs
+ */
+void montgomery_from(const montgomery_ctx *ctx, mpz_t r, const mp_limb_t *a, mp_limb_t *scratch);
+
+/**
+ * @brief Returns the window size used for an exponent of the given number of bits
+ *
+ * @param bits size of the exponent
+ *
+ * @return int window size
+ */
+int montgomery_window_size(size_t bits);
+
+/**
+ * @brief Computes the sliding window recoding of an exponent
+ *
+ * @param plan recoding to initialize
+ * @param exp exponent, exp >= 0
+ * @param window size of the window, between 1 and MONTGOMERY_MAX_WINDOW (0 to choose it from the size of exp)
+ *
+ * @return int 0 if the recoding was computed, -1 otherwise
+ */
+int montgomery_exp_init(montgomery_exp *plan, const mpz_t exp, int window);
+
+/**
+ * @brief Frees the recoding of an exponent
+ *
+ * @param plan recoding to free
+ */
+void montgomery_exp_clear(montgomery_exp *plan);
+
+/**
+ * @brief Returns the number of limbs of the work area needed by montgomery_powm
+ *
+ * @param ctx context of the modulus
+ * @param window window size of the recoded exponent
+ *
+ * @return mp_size_t number of limbs
+ */
+mp_size_t montgomery_powm_itch(const montgomery_ctx *ctx, int window);
+
+/**
+ * @brief Modular exponentiation result = base^exp mod n with a precomputed context and exponent. It only
+ *        builds the table of odd powers of base, so the same ctx and plan can be used for many bases
+ *
+ * @param ctx context of the modulus
+ * @param plan recoded exponent
+ * @param result (return) result
+ * @param base base, 0 <= base < n
+ * @param work work area of montgomery_powm_itch(ctx, plan->window) limbs
+ */
+void montgomery_powm(const montgomery_ctx *ctx, const montgomery_exp *plan, mpz_t result, const mpz_t base, mp_limb_t *work);
+
+/**
+ * @brief Precomputes the table of powers of a fixed base for exponents of up to max_bits bits
+ *
+ * @param fb table to initialize
+ * @param ctx context of the modulus
+ * @param base fixed base, 0 <= base < n
+ * @param max_bits maximum size of the exponents that will be used
+ * @param window bits per digit, between 1 and MONTGOMERY_MAX_WINDOW (0 for MONTGOMERY_FIXED_BASE_WINDOW)
+ *
+ * @return int 0 if the table was built, -1 otherwise
+ */
+int montgomery_fixed_base_init(montgomery_fixed_base *fb, const montgomery_ctx *ctx, const mpz_t base, size_t max_bits, int window);
+
+/**
+ * @brief Frees a fixed base table
+ *
+ * @param fb table to free
+ */
+void montgomery_fixed_base_clear(montgomery_fixed_base *fb);
+
+/**
+ * @brief Returns the number of limbs of the work area needed by montgomery_fixed_base_powm
+ *
+ * @param ctx context of the modulus
+ *
+ * @return mp_size_t number of limbs
+ */
+mp_size_t montgomery_fixed_base_itch(const montgomery_ctx *ctx);
+
+/**
+ * @brief Computes result = base^exp mod n with the precomputed table of the base
+ *
+ * @param fb table of the base
+ * @param result (return) result
+ * @param exp exponent, 0 <= exp < 2^max_bits
+ * @param work work area of montgomery_fixed_base_itch(fb->ctx) limbs
+ *
+ * @return int 0 if the result was computed, -1 if the exponent is not covered by the table
+ */
+int montgomery_fixed_base_powm(const montgomery_fixed_base *fb, mpz_t result, const mpz_t exp, mp_limb_t *work);
+
+/**
+ * @brief Returns the number of limbs of the work area needed by montgomery_multi_powm
+ *
+ * @param ctx context of the modulus
+ * @param count number of bases
+ * @param window window size of the exponents
+ *
+ * @return mp_size_t number of limbs
+ */
+mp_size_t montgomery_multi_powm_itch(const montgomery_ctx *ctx, int count, int window);
+
+/**
+ * @brief Simultaneous exponentiation result = prod bases[i]^exps[i] mod n (Shamir / Straus). Every
+ *        exponent is recoded in sliding windows and all of them share the same chain of squarings, so
+ *        the squarings are done once instead of once per base
+ *
+ * @param ctx context of the modulus
+ * @param result (return) result
+ * @param bases array of count bases, 0 <= bases[i] < n
+ * @param exps array of count exponents, exps[i] >= 0
+ * @param count number of bases
+ * @param window window size, between 1 and MONTGOMERY_MAX_WINDOW
+ * @param work work area of montgomery_multi_powm_itch(ctx, count, window) limbs
+ *
+ * @return int 0 if the result was computed, -1 otherwise
+ */
+int montgomery_multi_powm(const montgomery_ctx *ctx, mpz_t result, mpz_t *bases, mpz_t *exps, int count, int window, mp_limb_t *work);
+
+/**
+ * @brief Calculates prod bases[i]^exps[i] mod mod with montgomery_multi_powm, building the context for
+ *        this call. For even moduli it multiplies the results of potencia_modular
+ *
+ * @param result (return) result of the multi exponentiation
+ * @param bases array of count bases
+ * @param exps array of count exponents, exps[i] >= 0
+ * @param count number of bases, greater than 0
+ * @param mod modulus, greater than 1
+ *
+ * @return int 0 if the result was computed, -1 otherwise
+ */
+int potencia_modular_multi(mpz_t result, mpz_t *bases, mpz_t *exps, int count, const mpz_t mod);
+
+/**
+ * @brief Returns the number of limbs of the work area needed by montgomery_ladder_powm
+ *
+ * @param ctx context of the modulus
+ *
+ * @return mp_size_t number of limbs
+ */
+mp_size_t montgomery_ladder_itch(const montgomery_ctx *ctx);
+
+/**
+ * @brief Writes a secret exponent as ctx->size limbs, zero padded, for montgomery_ladder_powm. The copy
+ *        depends on the size of exp, so it is done once per key and not on every exponentiation
+ *
+ * @param ctx context of the modulus
+ * @param e (return) exponent, ctx->size limbs
+ * @param exp exponent, 0 <= exp < 2^(ctx->size*GMP_NUMB_BITS)
+ *
+ * @return int 0 if the exponent was written, -1 if it is negative or does not fit in ctx->size limbs
+ */
+int montgomery_ladder_exp(const montgomery_ctx *ctx, mp_limb_t *e, const mpz_t exp);
+
+/**
+ * @brief Constant time exponentiation r = base^e mod n with a Montgomery ladder, for private exponents.
+ *        Every bit of the ctx->size limbs of e costs one mpn_sec_mul and one mpn_sec_sqr, the registers
+ *        are exchanged with mpn_cnd_swap and the reductions have no branches, so the sequence of
+ *        operations and memory accesses does not depend on the bits or the size of the exponent
+ *
+ * @param ctx context of the modulus
+ * @param r (return) result, ctx->size limbs (it may be base)
+ * @param base base, ctx->size limbs, base < n
+ * @param e exponent written by montgomery_ladder_exp
+ * @param work work area of montgomery_ladder_itch(ctx) limbs
+ */
+void montgomery_ladder_powm_limbs(const montgomery_ctx *ctx, mp_limb_t *r, const mp_limb_t *base, const mp_limb_t *e,
+                                  mp_limb_t *work);
+
+/**
+ * @brief montgomery_ladder_powm_limbs with the base and the result as mpz (they are public)
+ *
+ * @param ctx context of the modulus
+ * @param result (return) result
+ * @param base base, 0 <= base < n
+ * @param e exponent written by montgomery_ladder_exp
+ * @param work work area of montgomery_ladder_itch(ctx) limbs
+ */
+void montgomery_ladder_powm(const montgomery_ctx *ctx, mpz_t result, const mpz_t base, const mp_limb_t *e, mp_limb_t *work);
+
+/**
+ * @brief Calculates base^exp mod mod in constant time with montgomery_ladder_powm, building the context
+ *        for this call. There is no variable time fallback: even moduli and exponents longer than the
+ *        modulus are errors
+ *
+ * @param result (return) result of the modular exponentiation
+ * @param base base of the exponentiation
+ * @param exp secret exponent of the exponentiation
+ * @param mod modulus of the exponentiation
+ *
+ * @return int 0 if the result was computed, -1 if mod is even or not greater than 1, or exp is negative or
+ *         has more limbs than mod
+ */
+int potencia_modular_sec(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod);
+
+/**
+ * @brief Calculates base^exp mod mod with Montgomery multiplication and a sliding window, building the
+ *        context and the recoding for this call. For even moduli it falls back to potencia_modular
+ *
+ * @param result result of the modular exponentiation
+ * @param base base of the exponentiation
+ * @param exp exponent of the exponentiation
+ * @param mod modulus of the exponentiation
+ */
+void potencia_modular_montgomery(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod);
+
+#endif
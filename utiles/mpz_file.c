@@ -0,0 +1,231 @@
+/**
+ * @file mpz_file.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in mpz_file.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "mpz_file.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Offset of the number of records in the header */
+#define RECORDS_OFFSET 16
+
+static void store_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static void store_le64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t load_le32(const uint8_t *p) {
+    uint32_t v = 0;
+
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+
+    return v;
+}
+
+static uint64_t load_le64(const uint8_t *p) {
+    uint64_t v = 0;
+
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+
+    return v;
+}
+
+int mpz_file_writer_open(mpz_file_writer *writer, const char *path, uint32_t kind, uint32_t fields) {
+    uint8_t header[MPZ_FILE_HEADER_SIZE];
+
+    memset(writer, 0, sizeof(mpz_file_writer));
+    if (fields == 0) {
+        return -1;
+    }
+    writer->fields = fields;
+
+    store_le32(header, MPZ_FILE_MAGIC);
+    store_le32(header + 4, MPZ_FILE_VERSION);
+    store_le32(header + 8, kind);
+    store_le32(header + 12, fields);
+    store_le64(header + RECORDS_OFFSET, MPZ_FILE_UNKNOWN_COUNT);
+
+    if (stream_writer_open(&writer->out, path) != 0) {
+        return -1;
+    }
+    /* FIFOs and devices like /dev/stdout on a pipe cannot go back to the header */
+    writer->seekable = writer->out.own && lseek(writer->out.fd, 0, SEEK_CUR) == 0;
+    if (stream_writer_write(&writer->out, header, MPZ_FILE_HEADER_SIZE) != 0) {
+        stream_writer_close(&writer->out);
+        return -1;
+    }
+
+    return 0;
+}
+
+int mpz_file_write(mpz_file_writer *writer, const mpz_t x) {
+    size_t limbs, avail, count;
+    uint8_t *space, *aux;
+    int result;
+
+    if (mpz_sgn(x) < 0) {
+        return -1;
+    }
+    limbs = mpz_sgn(x) == 0 ? 0 : (mpz_sizeinbase(x, 2) + 63) / 64;
+
+    if ((space = stream_writer_space(&writer->out, &avail)) == NULL) {
+        return -1;
+    }
+    if (avail < 8 * (limbs + 1)) {
+        if (stream_writer_flush(&writer->out) != 0 || (space = stream_writer_space(&writer->out, &avail)) == NULL) {
+            return -1;
+        }
+    }
+
+    if (avail >= 8 * (limbs + 1)) {
+        /* Little endian words of little endian bytes, whatever the machine */
+        store_le64(space, limbs);
+        mpz_export(space + 8, &count, -1, 8, -1, 0, x);
+        stream_writer_commit(&writer->out, 8 * (limbs + 1));
+    } else {
+        /* Numbers larger than the buffer of the writer */
+        aux = (uint8_t *)malloc(8 * (limbs + 1));
+        if (aux == NULL) {
+            printf("Error en la asignacion de memoria\n");
+            return -1;
+        }
+        store_le64(aux, limbs);
+        mpz_export(aux + 8, &count, -1, 8, -1, 0, x);
+        result = stream_writer_write(&writer->out, aux, 8 * (limbs + 1));
+        free(aux);
+        if (result != 0) {
+            return -1;
+        }
+    }
+
+    if (++writer->field == writer->fields) {
+        writer->field = 0;
+        writer->records++;
+    }
+
+    return 0;
+}
+
+int mpz_file_writer_close(mpz_file_writer *writer) {
+    uint8_t records[8];
+    int result = writer->field == 0 ? 0 : -1;
+
+    if (stream_writer_flush(&writer->out) != 0) {
+        result = -1;
+    }
+
+    /* Outputs that cannot seek keep MPZ_FILE_UNKNOWN_COUNT, the reader goes until the end */
+    if (writer->seekable) {
+        store_le64(records, writer->records);
+        if (lseek(writer->out.fd, RECORDS_OFFSET, SEEK_SET) != RECORDS_OFFSET ||
+            stream_writer_write(&writer->out, records, 8) != 0 || stream_writer_flush(&writer->out) != 0) {
+            result = -1;
+        }
+    }
+
+    if (stream_writer_close(&writer->out) != 0) {
+        result = -1;
+    }
+
+    return result;
+}
+
+int mpz_file_reader_open(mpz_file_reader *reader, const char *path) {
+    struct stat st;
+    void *map;
+    int fd;
+
+    memset(reader, 0, sizeof(mpz_file_reader));
+
+    /* Only regular files are opened here, a FIFO is opened once by stream_read_all */
+    if (path != NULL && stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        if ((fd = open(path, O_RDONLY)) < 0) {
+            printf("Error al abrir el archivo de entrada\n");
+            return -1;
+        }
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= MPZ_FILE_HEADER_SIZE) {
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+                reader->data = (const uint8_t *)map;
+                reader->len = (size_t)st.st_size;
+                reader->mapped = 1;
+            }
+        }
+        close(fd);
+    }
+
+    if (!reader->mapped && (reader->data = stream_read_all(path, &reader->len)) == NULL) {
+        return -1;
+    }
+
+    if (reader->len < MPZ_FILE_HEADER_SIZE || load_le32(reader->data) != MPZ_FILE_MAGIC ||
+        load_le32(reader->data + 4) != MPZ_FILE_VERSION || load_le32(reader->data + 12) == 0) {
+        printf("Not a valid file of numbers\n");
+        mpz_file_reader_close(reader);
+        return -1;
+    }
+
+    reader->kind = load_le32(reader->data + 8);
+    reader->fields = load_le32(reader->data + 12);
+    reader->records = load_le64(reader->data + RECORDS_OFFSET);
+    reader->pos = MPZ_FILE_HEADER_SIZE;
+
+    return 0;
+}
+
+int mpz_file_read(mpz_file_reader *reader, mpz_t x) {
+    uint64_t limbs;
+    size_t left = reader->len - reader->pos;
+
+    if (left == 0) {
+        /* The end must be the end of a record, and of the records of the header */
+        if (reader->numbers % reader->fields != 0 ||
+            (reader->records != MPZ_FILE_UNKNOWN_COUNT && reader->numbers / reader->fields != reader->records)) {
+            return -1;
+        }
+        return 0;
+    }
+
+    if (left < 8) {
+        return -1;
+    }
+    limbs = load_le64(reader->data + reader->pos);
+    if (limbs > (left - 8) / 8) {
+        return -1;
+    }
+
+    mpz_import(x, (size_t)limbs, -1, 8, -1, 0, reader->data + reader->pos + 8);
+    reader->pos += 8 * ((size_t)limbs + 1);
+    reader->numbers++;
+
+    return 1;
+}
+
+void mpz_file_reader_close(mpz_file_reader *reader) {
+    if (reader->mapped) {
+        munmap((void *)reader->data, reader->len);
+    } else {
+        free((void *)reader->data);
+    }
+    memset(reader, 0, sizeof(mpz_file_reader));
+}
@@ -0,0 +1,121 @@
+/**
+ * @file mpz_file.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Binary files of big numbers (lists of primes, RSA keys), much faster to write and to load than the
+ *        decimal text of gmp_printf. The file is a header of MPZ_FILE_HEADER_SIZE bytes (magic, version, kind,
+ *        numbers per record and number of records) followed by the numbers, each one a 64 bit limb count and
+ *        its 64 bit limbs, least significant first. Everything is little endian and 8 byte aligned, so the
+ *        files are the same on every machine and are read through mmap without copies
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MPZ_FILE_H
+#define MPZ_FILE_H
+
+#include "stream_io.h"
+
+/* "BMPZ" and version of the file format */
+#define MPZ_FILE_MAGIC 0x5A504D42u
+#define MPZ_FILE_VERSION 1
+#define MPZ_FILE_HEADER_SIZE 24
+
+/* Kinds of file */
+#define MPZ_FILE_NUMBERS 0
+#define MPZ_FILE_PRIMES 1
+#define MPZ_FILE_RSA_KEYS 2
+
+/* Number of records of a file whose writer could not go back to the header (a pipe or a FIFO): read until
+   the end */
+#define MPZ_FILE_UNKNOWN_COUNT UINT64_MAX
+
+/**
+ * @brief Output file of numbers
+ */
+typedef struct {
+    stream_writer out;
+    uint32_t fields;        /* Numbers per record */
+    uint32_t field;         /* Numbers written of the current record */
+    uint64_t records;       /* Complete records written */
+    int seekable;           /* 1 if the number of records is written in the header when closing */
+} mpz_file_writer;
+
+/**
+ * @brief Input file of numbers
+ */
+typedef struct {
+    const uint8_t *data;    /* Whole file, mapped or read */
+    size_t len;
+    size_t pos;             /* Offset of the next number */
+    int mapped;             /* 1 if data is a mapping, 0 if it was read with stream_read_all */
+    uint32_t kind;
+    uint32_t fields;
+    uint64_t records;       /* Records in the header (MPZ_FILE_UNKNOWN_COUNT if not known) */
+    uint64_t numbers;       /* Numbers already read */
+} mpz_file_reader;
+
+/**
+ * @brief Creates a file of numbers and writes its header
+ *
+ * @param writer (return) writer
+ * @param path name of the file. If it is NULL the standard output is written. The header only gets the
+ *        number of records of files that can seek, the rest (standard output, FIFOs, /dev/stdout on a
+ *        pipe) keep MPZ_FILE_UNKNOWN_COUNT
+ * @param kind MPZ_FILE_NUMBERS, MPZ_FILE_PRIMES or MPZ_FILE_RSA_KEYS
+ * @param fields numbers per record, greater than 0
+ *
+ * @return int 0 if the file was created, -1 otherwise
+ */
+int mpz_file_writer_open(mpz_file_writer *writer, const char *path, uint32_t kind, uint32_t fields);
+
+/**
+ * @brief Writes a number with mpz_export, straight into the buffer of the writer
+ *
+ * @param writer writer
+ * @param x number, x >= 0
+ *
+ * @return int 0 if the number was written, -1 if it is negative or there was an error
+ */
+int mpz_file_write(mpz_file_writer *writer, const mpz_t x);
+
+/**
+ * @brief Writes the numbers left, sets the number of records of the header (if the file can seek) and
+ *        closes the file
+ *
+ * @param writer writer
+ *
+ * @return int 0 if everything was written and the last record is complete, -1 otherwise
+ */
+int mpz_file_writer_close(mpz_file_writer *writer);
+
+/**
+ * @brief Opens a file of numbers, mapping it in memory (pipes are read whole), and checks its header
+ *
+ * @param reader (return) reader
+ * @param path name of the file. If it is NULL the standard input is read
+ *
+ * @return int 0 if the file was opened and is valid, -1 otherwise
+ */
+int mpz_file_reader_open(mpz_file_reader *reader, const char *path);
+
+/**
+ * @brief Reads the next number with mpz_import, from the mapping
+ *
+ * @param reader reader
+ * @param x (return) number
+ *
+ * @return int 1 if a number was read, 0 at the end of the file, -1 if the file is truncated or not valid
+ */
+int mpz_file_read(mpz_file_reader *reader, mpz_t x);
+
+/**
+ * @brief Unmaps and closes a reader
+ *
+ * @param reader reader
+ */
+void mpz_file_reader_close(mpz_file_reader *reader);
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file permutation.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in permutation.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "permutation.h"
+#include "prng.h"
+
+/* Half of a number of prng_next that was not used yet */
+static __thread uint64_t spare_bits;
+static __thread int spare = 0;
+
+static uint32_t next32() {
+    if (spare) {
+        spare = 0;
+        return (uint32_t)(spare_bits >> 32);
+    }
+    spare_bits = prng_next();
+    spare = 1;
+
+    return (uint32_t)spare_bits;
+}
+
+/* Number in [0, n) with a multiplication instead of a division (Lemire): the high half of r * n, rejecting the
+   low halves that would give some results once more than the others. The division is only done when a low
+   half falls in that zone, which for the sizes of the permutations almost never happens */
+static uint32_t bounded(uint32_t n) {
+    uint64_t m = (uint64_t)next32() * n;
+    uint32_t threshold;
+
+    if ((uint32_t)m < n) {
+        threshold = (0u - n) % n;
+        while ((uint32_t)m < threshold) {
+            m = (uint64_t)next32() * n;
+        }
+    }
+
+    return (uint32_t)(m >> 32);
+}
+
+void permutation_identity(int *permutation, int n) {
+    for (int i = 0; i < n; i++) {
+        permutation[i] = i;
+    }
+}
+
+void permutation_generate(int *permutation, int n) {
+    int j, aux;
+
+    permutation_identity(permutation, n);
+
+    /* The position i takes one of the values still in [i, n-1] */
+    for (int i = n - 1; i > 0; i--) {
+        j = (int)bounded((uint32_t)i + 1);
+        aux = permutation[i];
+        permutation[i] = permutation[j];
+        permutation[j] = aux;
+    }
+}
+
+void permutation_generate_batch(int *permutations, int n, size_t count) {
+    for (size_t c = 0; c < count; c++) {
+        permutation_generate(permutations + c * n, n);
+    }
+}
+
+void permutation_invert(int *permutation, int n) {
+    int previous, current, next;
+
+    /* In the cycle i -> p[i] -> p[p[i]] -> ... every entry gets the one before it. The entries already
+       inverted are stored as ~value (negative) and skipped */
+    for (int i = 0; i < n; i++) {
+        if (permutation[i] < 0) {
+            continue;
+        }
+        previous = i;
+        current = permutation[i];
+        while (current != i) {
+            next = permutation[current];
+            permutation[current] = ~previous;
+            previous = current;
+            current = next;
+        }
+        permutation[i] = ~previous;
+    }
+
+    for (int i = 0; i < n; i++) {
+        permutation[i] = ~permutation[i];
+    }
+}
+
+int permutation_next(int *permutation, int n) {
+    int i = n - 2, j = n - 1, aux;
+
+    /* Last position that can grow, swapped with the smallest larger value after it, and the rest reversed */
+    while (i >= 0 && permutation[i] > permutation[i + 1]) {
+        i--;
+    }
+    if (i >= 0) {
+        while (permutation[j] < permutation[i]) {
+            j--;
+        }
+        aux = permutation[i];
+        permutation[i] = permutation[j];
+        permutation[j] = aux;
+    }
+
+    for (int a = i + 1, b = n - 1; a < b; a++, b--) {
+        aux = permutation[a];
+        permutation[a] = permutation[b];
+        permutation[b] = aux;
+    }
+
+    return i >= 0;
+}
+
+int permutation_is_valid(int *permutation, int n) {
+    int valid = 1, v;
+
+    for (int i = 0; i < n; i++) {
+        if (permutation[i] < 0 || permutation[i] >= n) {
+            return 0;
+        }
+    }
+
+    /* A value seen marks its position with ~, a second time it is already marked */
+    for (int i = 0; i < n && valid; i++) {
+        v = permutation[i] < 0 ? ~permutation[i] : permutation[i];
+        if (permutation[v] < 0) {
+            valid = 0;
+        } else {
+            permutation[v] = ~permutation[v];
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (permutation[i] < 0) {
+            permutation[i] = ~permutation[i];
+        }
+    }
+
+    return valid;
+}
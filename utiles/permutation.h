@@ -0,0 +1,73 @@
+/**
+ * @file permutation.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Random permutations of {0, ..., n-1} for the permutation ciphers: Fisher-Yates with unbiased bounded
+ *        numbers taken from the generator of the thread (prng.h), inversion in place by following the cycles,
+ *        generation of many permutations into one buffer and enumeration in lexicographic order. Nothing is
+ *        allocated, so the functions can be called from several threads with their own buffers
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PERMUTATION_H
+#define PERMUTATION_H
+
+#include "utils.h"
+
+/**
+ * @brief Generates a random permutation with Fisher-Yates. Every permutation has the same probability
+ *
+ * @param permutation (return) permutation, n entries
+ * @param n size of the permutation, greater than 0
+ */
+void permutation_generate(int *permutation, int n);
+
+/**
+ * @brief Generates count random permutations one after the other
+ *
+ * @param permutations (return) permutations, count * n entries
+ * @param n size of each permutation, greater than 0
+ * @param count number of permutations
+ */
+void permutation_generate_batch(int *permutations, int n, size_t count);
+
+/**
+ * @brief Inverts a permutation in place: each cycle is walked once and the visited entries are marked
+ *        with their complement, so no extra memory is used
+ *
+ * @param permutation permutation, (return) its inverse
+ * @param n size of the permutation
+ */
+void permutation_invert(int *permutation, int n);
+
+/**
+ * @brief Sets the identity permutation, the first one of permutation_next
+ *
+ * @param permutation (return) identity, n entries
+ * @param n size of the permutation
+ */
+void permutation_identity(int *permutation, int n);
+
+/**
+ * @brief Changes a permutation into the next one in lexicographic order, to go through all of them
+ *
+ * @param permutation permutation, (return) the next one (the identity after the last one)
+ * @param n size of the permutation
+ * @return int 1 if there was a next permutation, 0 if it was the last one
+ */
+int permutation_next(int *permutation, int n);
+
+/**
+ * @brief Checks that an array is a permutation of {0, ..., n-1}. The entries are marked while checking and
+ *        restored before returning
+ *
+ * @param permutation array
+ * @param n size of the array
+ * @return int 1 if it is a permutation, 0 otherwise
+ */
+int permutation_is_valid(int *permutation, int n);
+
+#endif
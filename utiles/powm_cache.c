@@ -0,0 +1,607 @@
+/**
+ * @file powm_cache.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in powm_cache.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "powm_cache.h"
+
+/* Largest modulus accepted from a file, in limbs */
+#define POWM_CACHE_MAX_LIMBS (1 << 16)
+
+static powm_cache default_cache;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static powm_cache_entry *entry_new() {
+    powm_cache_entry *entry = (powm_cache_entry *)calloc(1, sizeof(powm_cache_entry));
+
+    if (entry == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        return NULL;
+    }
+    mpz_init(entry->exp);
+    mpz_init(entry->p);
+    mpz_init(entry->q);
+    mpz_init(entry->qinv);
+
+    return entry;
+}
+
+static void entry_free(powm_cache_entry *entry) {
+    if (entry->ctx.mod != NULL) {
+        montgomery_clear(&entry->ctx);
+    }
+    if (entry->has_plan) {
+        montgomery_exp_clear(&entry->plan);
+    }
+    mpz_clear(entry->exp);
+    mpz_clear(entry->p);
+    mpz_clear(entry->q);
+    mpz_clear(entry->qinv);
+    free(entry);
+}
+
+/* The functions that follow are called with the mutex of the cache taken */
+
+static powm_cache_entry *cache_find(powm_cache *cache, const mpz_t mod) {
+    for (int i = 0; i < cache->count; i++) {
+        if (mpz_cmp(cache->entries[i]->ctx.modulus, mod) == 0) {
+            return cache->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Puts the entry in the cache in place of the least recently used one that is not in use. If all of
+   them are in use the entry stays out of the cache */
+static void cache_insert(powm_cache *cache, powm_cache_entry *entry) {
+    int victim = -1;
+
+    entry->cached = 1;
+    if (cache->count < cache->capacity) {
+        cache->entries[cache->count++] = entry;
+        return;
+    }
+
+    for (int i = 0; i < cache->count; i++) {
+        if (cache->entries[i]->refs == 0
+            && (victim == -1 || cache->entries[i]->last_use < cache->entries[victim]->last_use)) {
+            victim = i;
+        }
+    }
+
+    if (victim == -1) {
+        entry->cached = 0;
+        return;
+    }
+    entry_free(cache->entries[victim]);
+    cache->entries[victim] = entry;
+}
+
+static void entry_set_plan(powm_cache_entry *entry, const mpz_t exp) {
+    if (entry->has_plan) {
+        montgomery_exp_clear(&entry->plan);
+        entry->has_plan = 0;
+    }
+    if (montgomery_exp_init(&entry->plan, exp, 0) == 0) {
+        mpz_set(entry->exp, exp);
+        entry->has_plan = 1;
+    }
+}
+
+int powm_cache_init(powm_cache *cache, int capacity) {
+    if (capacity < 1) {
+        return -1;
+    }
+
+    cache->entries = (powm_cache_entry **)malloc(capacity * sizeof(powm_cache_entry *));
+    if (cache->entries == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        return -1;
+    }
+    cache->count = 0;
+    cache->capacity = capacity;
+    cache->clock = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    pthread_mutex_init(&cache->mutex, NULL);
+
+    return 0;
+}
+
+void powm_cache_clear(powm_cache *cache) {
+    for (int i = 0; i < cache->count; i++) {
+        entry_free(cache->entries[i]);
+    }
+    free(cache->entries);
+    cache->entries = NULL;
+    cache->count = 0;
+    pthread_mutex_destroy(&cache->mutex);
+}
+
+static void default_cache_init() {
+    if (powm_cache_init(&default_cache, POWM_CACHE_DEFAULT_SIZE) != 0) {
+        exit(1);
+    }
+}
+
+powm_cache *powm_cache_default() {
+    pthread_once(&default_once, default_cache_init);
+
+    return &default_cache;
+}
+
+powm_cache_entry *powm_cache_acquire(powm_cache *cache, const mpz_t mod, const mpz_t exp) {
+    powm_cache_entry *entry;
+
+    if (mpz_cmp_ui(mod, 1) <= 0 || mpz_even_p(mod)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+
+    entry = cache_find(cache, mod);
+    if (entry != NULL) {
+        cache->hits++;
+    } else {
+        cache->misses++;
+        entry = entry_new();
+        if (entry == NULL || montgomery_init(&entry->ctx, mod) != 0) {
+            if (entry != NULL) {
+                entry_free(entry);
+            }
+            pthread_mutex_unlock(&cache->mutex);
+            return NULL;
+        }
+        cache_insert(cache, entry);
+    }
+
+    entry->refs++;
+    entry->last_use = ++cache->clock;
+
+    /* The recoding is only replaced when no other thread can be using it */
+    if (exp != NULL && entry->refs == 1 && !entry->has_factors && mpz_sgn(exp) >= 0
+        && (!entry->has_plan || mpz_cmp(entry->exp, exp) != 0)) {
+        entry_set_plan(entry, exp);
+    }
+
+    pthread_mutex_unlock(&cache->mutex);
+
+    return entry;
+}
+
+void powm_cache_release(powm_cache *cache, powm_cache_entry *entry) {
+    pthread_mutex_lock(&cache->mutex);
+    entry->refs--;
+    if (!entry->cached && entry->refs == 0) {
+        entry_free(entry);
+    }
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+int powm_cache_set_factors(powm_cache *cache, const mpz_t n, const mpz_t p, const mpz_t q) {
+    powm_cache_entry *entry;
+    mpz_t aux;
+    int result = -1;
+
+    mpz_init(aux);
+    mpz_mul(aux, p, q);
+    if (mpz_cmp(aux, n) != 0 || mpz_cmp(p, q) == 0 || mpz_cmp_ui(p, 2) <= 0 || mpz_cmp_ui(q, 2) <= 0) {
+        mpz_clear(aux);
+        return -1;
+    }
+
+    entry = powm_cache_acquire(cache, n, NULL);
+    if (entry == NULL) {
+        mpz_clear(aux);
+        return -1;
+    }
+
+    /* As the plan, the factors are only written when no other thread uses the entry */
+    pthread_mutex_lock(&cache->mutex);
+    if (entry->refs == 1 && mpz_invert(aux, q, p) != 0) {
+        mpz_set(entry->p, p);
+        mpz_set(entry->q, q);
+        mpz_set(entry->qinv, aux);
+        entry->has_factors = 1;
+        result = 0;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    powm_cache_release(cache, entry);
+    mpz_clear(aux);
+
+    return result;
+}
+
+/* out = base^exp mod prime with the exponent reduced modulo prime-1 (Fermat) */
+static void crt_part(powm_cache *cache, mpz_t out, const mpz_t base, const mpz_t exp, const mpz_t prime, mpz_t aux) {
+    mpz_mod(out, base, prime);
+    if (mpz_sgn(out) == 0) {
+        /* The reduction of the exponent is only valid for bases coprime with the prime */
+        mpz_set_ui(out, mpz_sgn(exp) == 0 ? 1 : 0);
+        return;
+    }
+
+    mpz_sub_ui(aux, prime, 1);
+    mpz_mod(aux, exp, aux);
+    powm_cache_powm(cache, out, out, aux, prime);
+}
+
+void powm_cache_powm(powm_cache *cache, mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
+    powm_cache_entry *entry;
+    montgomery_exp temporary;
+    const montgomery_exp *plan;
+    mp_limb_t *work;
+    mpz_t base_mod, mp, mq;
+
+    if (cache == NULL) {
+        cache = powm_cache_default();
+    }
+
+    entry = mpz_sgn(exp) < 0 ? NULL : powm_cache_acquire(cache, mod, exp);
+    if (entry == NULL) {
+        potencia_modular(result, base, exp, mod);
+        return;
+    }
+
+    if (entry->has_factors) {
+        mpz_init(mp);
+        mpz_init(mq);
+        mpz_init(base_mod);
+
+        crt_part(cache, mp, base, exp, entry->p, base_mod);
+        crt_part(cache, mq, base, exp, entry->q, base_mod);
+
+        /* result = mq + q * (qinv * (mp - mq) mod p) */
+        mpz_sub(mp, mp, mq);
+        mpz_mul(mp, mp, entry->qinv);
+        mpz_mod(mp, mp, entry->p);
+        mpz_mul(mp, mp, entry->q);
+        mpz_add(result, mp, mq);
+
+        mpz_clear(mp);
+        mpz_clear(mq);
+        mpz_clear(base_mod);
+        powm_cache_release(cache, entry);
+        return;
+    }
+
+    /* Another thread may have the entry with the recoding of another exponent */
+    if (entry->has_plan && mpz_cmp(entry->exp, exp) == 0) {
+        plan = &entry->plan;
+    } else if (montgomery_exp_init(&temporary, exp, 0) == 0) {
+        plan = &temporary;
+    } else {
+        powm_cache_release(cache, entry);
+        potencia_modular(result, base, exp, mod);
+        return;
+    }
+
+    work = (mp_limb_t *)malloc(montgomery_powm_itch(&entry->ctx, plan->window) * sizeof(mp_limb_t));
+    if (work == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    mpz_init(base_mod);
+    mpz_mod(base_mod, base, mod);
+
+    montgomery_powm(&entry->ctx, plan, result, base_mod, work);
+
+    mpz_clear(base_mod);
+    free(work);
+    if (plan == &temporary) {
+        montgomery_exp_clear(&temporary);
+    }
+    powm_cache_release(cache, entry);
+}
+
+void potencia_modular_cached(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
+    powm_cache_powm(NULL, result, base, exp, mod);
+}
+
+/* Binary file: every field in the byte order of the machine */
+
+static int write_u32(FILE *f, uint32_t value) {
+    return fwrite(&value, sizeof(value), 1, f) == 1 ? 0 : -1;
+}
+
+static int read_u32(FILE *f, uint32_t *value) {
+    return fread(value, sizeof(*value), 1, f) == 1 ? 0 : -1;
+}
+
+static int write_limbs(FILE *f, const mp_limb_t *limbs, size_t n) {
+    return fwrite(limbs, sizeof(mp_limb_t), n, f) == n ? 0 : -1;
+}
+
+static int read_limbs(FILE *f, mp_limb_t *limbs, size_t n) {
+    return fread(limbs, sizeof(mp_limb_t), n, f) == n ? 0 : -1;
+}
+
+/* Number of limbs and the limbs of a non negative number */
+static int write_mpz(FILE *f, const mpz_t x) {
+    size_t n = mpz_size(x);
+
+    if (write_u32(f, (uint32_t)n) != 0) {
+        return -1;
+    }
+
+    return n == 0 ? 0 : write_limbs(f, mpz_limbs_read(x), n);
+}
+
+static int read_mpz(FILE *f, mpz_t x) {
+    uint32_t n;
+    mp_limb_t *limbs;
+
+    if (read_u32(f, &n) != 0 || n > POWM_CACHE_MAX_LIMBS) {
+        return -1;
+    }
+    if (n == 0) {
+        mpz_set_ui(x, 0);
+        return 0;
+    }
+
+    limbs = mpz_limbs_write(x, n);
+    if (read_limbs(f, limbs, n) != 0) {
+        mpz_limbs_finish(x, 0);
+        return -1;
+    }
+    mpz_limbs_finish(x, n);
+
+    return 0;
+}
+
+static int write_entry(FILE *f, const powm_cache_entry *entry) {
+    const montgomery_ctx *ctx = &entry->ctx;
+    size_t n = (size_t)ctx->size;
+
+    if (write_u32(f, (uint32_t)n) != 0 || write_limbs(f, ctx->mod, n) != 0 || write_limbs(f, &ctx->minv, 1) != 0
+        || write_limbs(f, ctx->r2, n) != 0 || write_limbs(f, ctx->one, n) != 0) {
+        return -1;
+    }
+
+    if (write_u32(f, (uint32_t)entry->has_plan) != 0) {
+        return -1;
+    }
+    if (entry->has_plan) {
+        if (write_mpz(f, entry->exp) != 0 || write_u32(f, (uint32_t)entry->plan.window) != 0
+            || write_u32(f, (uint32_t)entry->plan.count) != 0 || write_u32(f, entry->plan.tail) != 0
+            || fwrite(entry->plan.digit, sizeof(unsigned short), entry->plan.count, f) != (size_t)entry->plan.count
+            || fwrite(entry->plan.squarings, sizeof(unsigned int), entry->plan.count, f) != (size_t)entry->plan.count) {
+            return -1;
+        }
+    }
+
+    if (write_u32(f, (uint32_t)entry->has_factors) != 0) {
+        return -1;
+    }
+    if (entry->has_factors) {
+        if (write_mpz(f, entry->p) != 0 || write_mpz(f, entry->q) != 0 || write_mpz(f, entry->qinv) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Reads one entry and checks that it is consistent, without the divisions of montgomery_init */
+static powm_cache_entry *read_entry(FILE *f) {
+    powm_cache_entry *entry = entry_new();
+    montgomery_ctx *ctx;
+    uint32_t n, flag, window, count, tail;
+    size_t bits;
+    mpz_t aux, one;
+    mp_limb_t *scratch;
+    unsigned short *digit;
+    unsigned int *squarings;
+    int valid;
+
+    if (entry == NULL) {
+        return NULL;
+    }
+    ctx = &entry->ctx;
+
+    if (read_u32(f, &n) != 0 || n == 0 || n > POWM_CACHE_MAX_LIMBS) {
+        entry_free(entry);
+        return NULL;
+    }
+
+    ctx->size = (mp_size_t)n;
+    ctx->mod = (mp_limb_t *)malloc(3 * (size_t)n * sizeof(mp_limb_t));
+    if (ctx->mod == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        entry_free(entry);
+        return NULL;
+    }
+    ctx->r2 = ctx->mod + n;
+    ctx->one = ctx->mod + 2 * n;
+    mpz_init(ctx->modulus);
+
+    if (read_limbs(f, ctx->mod, n) != 0 || read_limbs(f, &ctx->minv, 1) != 0 || read_limbs(f, ctx->r2, n) != 0
+        || read_limbs(f, ctx->one, n) != 0) {
+        entry_free(entry);
+        return NULL;
+    }
+
+    /* Odd modulus without leading zeros, minv = -n^-1 and R^2, R reduced */
+    if ((ctx->mod[0] & 1) == 0 || ctx->mod[n - 1] == 0 || (mp_limb_t)(ctx->mod[0] * ctx->minv + 1) != 0
+        || mpn_cmp(ctx->r2, ctx->mod, n) >= 0 || mpn_cmp(ctx->one, ctx->mod, n) >= 0) {
+        entry_free(entry);
+        return NULL;
+    }
+    mpz_import(ctx->modulus, n, -1, sizeof(mp_limb_t), 0, 0, ctx->mod);
+
+    /* Without divisions: REDC(R^2 mod n) must be R mod n, and REDC(R mod n) must be 1 */
+    scratch = (mp_limb_t *)malloc(2 * (size_t)n * sizeof(mp_limb_t));
+    if (scratch == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        entry_free(entry);
+        return NULL;
+    }
+    mpz_init(aux);
+    mpz_init(one);
+    mpz_import(one, n, -1, sizeof(mp_limb_t), 0, 0, ctx->one);
+    montgomery_from(ctx, aux, ctx->r2, scratch);
+    valid = mpz_cmp(aux, one) == 0;
+    if (valid) {
+        montgomery_from(ctx, aux, ctx->one, scratch);
+        valid = mpz_cmp_ui(aux, 1) == 0;
+    }
+    mpz_clear(aux);
+    mpz_clear(one);
+    free(scratch);
+    if (!valid) {
+        entry_free(entry);
+        return NULL;
+    }
+
+    if (read_u32(f, &flag) != 0) {
+        entry_free(entry);
+        return NULL;
+    }
+    if (flag) {
+        if (read_mpz(f, entry->exp) != 0 || read_u32(f, &window) != 0 || read_u32(f, &count) != 0
+            || read_u32(f, &tail) != 0 || window < 1 || window > MONTGOMERY_MAX_WINDOW) {
+            entry_free(entry);
+            return NULL;
+        }
+        bits = mpz_sgn(entry->exp) == 0 ? 0 : mpz_sizeinbase(entry->exp, 2);
+        if (count > bits + 1 || mpz_sgn(entry->exp) < 0) {
+            entry_free(entry);
+            return NULL;
+        }
+
+        /* The recoding is derived again from exp, the stored one must be the same or the file is corrupted */
+        if (montgomery_exp_init(&entry->plan, entry->exp, (int)window) != 0) {
+            entry_free(entry);
+            return NULL;
+        }
+        entry->has_plan = 1;
+
+        digit = (unsigned short *)malloc((count + 1) * sizeof(unsigned short));
+        squarings = (unsigned int *)malloc((count + 1) * sizeof(unsigned int));
+        if (digit == NULL || squarings == NULL) {
+            printf("Error en la asignacion de memoria\n");
+            free(digit);
+            free(squarings);
+            entry_free(entry);
+            return NULL;
+        }
+        valid = fread(digit, sizeof(unsigned short), count, f) == count
+                && fread(squarings, sizeof(unsigned int), count, f) == count
+                && entry->plan.count == (int)count && entry->plan.tail == tail
+                && memcmp(digit, entry->plan.digit, count * sizeof(unsigned short)) == 0
+                && memcmp(squarings, entry->plan.squarings, count * sizeof(unsigned int)) == 0;
+        free(digit);
+        free(squarings);
+        if (!valid) {
+            entry_free(entry);
+            return NULL;
+        }
+    }
+
+    if (read_u32(f, &flag) != 0) {
+        entry_free(entry);
+        return NULL;
+    }
+    if (flag) {
+        if (read_mpz(f, entry->p) != 0 || read_mpz(f, entry->q) != 0 || read_mpz(f, entry->qinv) != 0) {
+            entry_free(entry);
+            return NULL;
+        }
+        mpz_init(aux);
+        mpz_mul(aux, entry->p, entry->q);
+        valid = mpz_cmp(aux, ctx->modulus) == 0 && mpz_cmp_ui(entry->p, 2) > 0 && mpz_cmp_ui(entry->q, 2) > 0;
+        if (valid) {
+            mpz_mul(aux, entry->q, entry->qinv);
+            mpz_mod(aux, aux, entry->p);
+            valid = mpz_cmp_ui(aux, 1) == 0;
+        }
+        mpz_clear(aux);
+        if (!valid) {
+            entry_free(entry);
+            return NULL;
+        }
+        entry->has_factors = 1;
+    }
+
+    return entry;
+}
+
+int powm_cache_save(powm_cache *cache, const char *path) {
+    FILE *f = fopen(path, "wb");
+    int error = 0;
+
+    if (f == NULL) {
+        printf("Error opening %s\n", path);
+        return -1;
+    }
+
+    pthread_mutex_lock(&cache->mutex);
+    error |= write_u32(f, POWM_CACHE_MAGIC) != 0 || write_u32(f, POWM_CACHE_VERSION) != 0
+             || write_u32(f, GMP_NUMB_BITS) != 0 || write_u32(f, (uint32_t)cache->count) != 0;
+    for (int i = 0; i < cache->count && !error; i++) {
+        error |= write_entry(f, cache->entries[i]) != 0;
+    }
+    pthread_mutex_unlock(&cache->mutex);
+
+    if (fclose(f) != 0 || error) {
+        printf("Error writing %s\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int powm_cache_load(powm_cache *cache, const char *path) {
+    FILE *f = fopen(path, "rb");
+    powm_cache_entry *entry;
+    uint32_t magic, version, bits, count;
+    int loaded = 0;
+
+    if (f == NULL) {
+        return -1;
+    }
+
+    if (read_u32(f, &magic) != 0 || read_u32(f, &version) != 0 || read_u32(f, &bits) != 0
+        || read_u32(f, &count) != 0 || magic != POWM_CACHE_MAGIC || version != POWM_CACHE_VERSION
+        || bits != GMP_NUMB_BITS) {
+        printf("%s is not a cache file of this machine\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        entry = read_entry(f);
+        if (entry == NULL) {
+            printf("%s: entry %u is not valid\n", path, i);
+            fclose(f);
+            return -1;
+        }
+
+        pthread_mutex_lock(&cache->mutex);
+        if (cache_find(cache, entry->ctx.modulus) != NULL) {
+            entry_free(entry);
+        } else {
+            entry->last_use = ++cache->clock;
+            cache_insert(cache, entry);
+            if (!entry->cached) {
+                entry_free(entry);
+            } else {
+                loaded++;
+            }
+        }
+        pthread_mutex_unlock(&cache->mutex);
+    }
+
+    fclose(f);
+
+    return loaded;
+}
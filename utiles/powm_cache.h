@@ -0,0 +1,159 @@
+/**
+ * @file powm_cache.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Cache of the precomputations of the modular exponentiation, keyed by modulus: the Montgomery
+ *        context, the recoding of the last exponent used with it and, for moduli n = p*q whose factors are
+ *        known, the CRT parameters. The least recently used modulus is evicted when the cache is full, and
+ *        the whole cache can be written to a binary file and loaded in a later run
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef POWM_CACHE_H
+#define POWM_CACHE_H
+
+#include "montgomery.h"
+
+/* Moduli kept by the default cache */
+#define POWM_CACHE_DEFAULT_SIZE 16
+
+/* "PWMC" and version of the file format */
+#define POWM_CACHE_MAGIC 0x434D5750u
+#define POWM_CACHE_VERSION 1
+
+/**
+ * @brief Precomputations of one modulus
+ */
+typedef struct {
+    montgomery_ctx ctx;         /* Context of the modulus */
+    mpz_t exp;                  /* Exponent recoded in plan */
+    montgomery_exp plan;        /* Recoding of exp (if has_plan) */
+    int has_plan;
+    mpz_t p, q, qinv;           /* Factors of the modulus and q^-1 mod p (if has_factors) */
+    int has_factors;
+    int refs;                   /* Users of the entry, it is not evicted while it is used */
+    int cached;                 /* 0 if the cache was full of used entries, it is freed when released */
+    unsigned long long last_use;
+} powm_cache_entry;
+
+/**
+ * @brief LRU cache of moduli. It can be shared by several threads
+ */
+typedef struct {
+    powm_cache_entry **entries;
+    int count;
+    int capacity;
+    unsigned long long clock;   /* Counter of uses, for the LRU order */
+    long long hits;
+    long long misses;
+    pthread_mutex_t mutex;
+} powm_cache;
+
+/**
+ * @brief Initializes an empty cache
+ *
+ * @param cache cache to initialize
+ * @param capacity number of moduli kept, greater than 0
+ *
+ * @return int 0 if the cache was initialized, -1 otherwise
+ */
+int powm_cache_init(powm_cache *cache, int capacity);
+
+/**
+ * @brief Frees a cache and all its entries. No entry may be in use
+ *
+ * @param cache cache to free
+ */
+void powm_cache_clear(powm_cache *cache);
+
+/**
+ * @brief Returns the cache used by potencia_modular_cached (created on the first call)
+ *
+ * @return powm_cache* default cache of POWM_CACHE_DEFAULT_SIZE moduli
+ */
+powm_cache *powm_cache_default();
+
+/**
+ * @brief Takes the entry of a modulus, building it if it is not in the cache (the least recently used entry
+ *        is evicted). If exp is given and nobody else is using the entry, its recoding is updated to exp
+ *
+ * @param cache cache
+ * @param mod odd modulus greater than 1
+ * @param exp exponent that is going to be used, or NULL
+ *
+ * @return powm_cache_entry* entry, to be given back with powm_cache_release, or NULL if the modulus is not valid
+ */
+powm_cache_entry *powm_cache_acquire(powm_cache *cache, const mpz_t mod, const mpz_t exp);
+
+/**
+ * @brief Gives back an entry taken with powm_cache_acquire
+ *
+ * @param cache cache
+ * @param entry entry
+ */
+void powm_cache_release(powm_cache *cache, powm_cache_entry *entry);
+
+/**
+ * @brief Stores the factors of a modulus n = p*q, so its exponentiations are done with the CRT (the
+ *        contexts of p and q are cached too)
+ *
+ * @param cache cache
+ * @param n modulus
+ * @param p first prime factor
+ * @param q second prime factor, different from p
+ *
+ * @return int 0 if the factors were stored, -1 if p*q is not n or n is not valid
+ */
+int powm_cache_set_factors(powm_cache *cache, const mpz_t n, const mpz_t p, const mpz_t q);
+
+/**
+ * @brief Calculates base^exp mod mod with the precomputations of the cache. Even moduli are computed with
+ *        potencia_modular
+ *
+ * @param cache cache (NULL for the default one)
+ * @param result result of the modular exponentiation
+ * @param base base of the exponentiation
+ * @param exp exponent of the exponentiation, exp >= 0
+ * @param mod modulus of the exponentiation
+ */
+void powm_cache_powm(powm_cache *cache, mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod);
+
+/**
+ * @brief Calculates base^exp mod mod with the default cache, like potencia_modular_montgomery but without
+ *        building the context again for a modulus used recently
+ *
+ * @param result result of the modular exponentiation
+ * @param base base of the exponentiation
+ * @param exp exponent of the exponentiation
+ * @param mod modulus of the exponentiation
+ */
+void potencia_modular_cached(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod);
+
+/**
+ * @brief Writes the entries of the cache to a binary file: a header (magic, version, bits per limb and
+ *        number of entries) and, for each entry, the limbs of the modulus, -n^-1, R^2 and R mod n, the
+ *        exponent and its recoding, and the factors. The numbers are written in the byte order of the machine
+ *
+ * @param cache cache
+ * @param path name of the file
+ *
+ * @return int 0 if the file was written, -1 otherwise
+ */
+int powm_cache_save(powm_cache *cache, const char *path);
+
+/**
+ * @brief Adds to the cache the entries of a file written by powm_cache_save, without computing them again.
+ *        The constants are checked without divisions (REDC(R^2) must be R and REDC(R) must be 1) and the
+ *        recoding must be the one of the stored exponent, so a corrupted file is rejected
+ *
+ * @param cache cache
+ * @param path name of the file
+ *
+ * @return int number of entries loaded, -1 if the file can not be read or is not valid
+ */
+int powm_cache_load(powm_cache *cache, const char *path);
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ * @file prng.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in prng.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "prng.h"
+
+#include <errno.h>
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+#define ROTL64(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+#define ROTL32(x, k) (((x) << (k)) | ((x) >> (32 - (k))))
+
+/* Seed of the streams of the threads and number of streams given */
+static pthread_mutex_t seed_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t base_seed;
+static int base_seeded = 0;
+static uint64_t next_stream = 0;
+
+/* State of xoshiro256** of each thread */
+static __thread uint64_t xoshiro[4];
+static __thread int xoshiro_seeded = 0;
+
+/* ChaCha20 of each thread: key and nonce in the state, unused bytes of the last block */
+static __thread uint32_t chacha_state[16];
+static __thread uint8_t chacha_block[64];
+static __thread int chacha_used = 64;
+static __thread int chacha_keyed = 0;
+
+/* Entropy of the system: getrandom, or /dev/urandom if the kernel does not have it */
+static int system_entropy(void *buffer, size_t len) {
+    uint8_t *p = (uint8_t *)buffer;
+    long r;
+    int fd;
+
+#ifdef __linux__
+    while (len > 0) {
+        r = (long)getrandom(p, len, 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        p += r;
+        len -= (size_t)r;
+    }
+    if (len == 0) {
+        return 0;
+    }
+#endif
+
+    fd = open("/dev/urandom", O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    while (len > 0) {
+        r = read(fd, p, len);
+        if (r <= 0) {
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            close(fd);
+            return -1;
+        }
+        p += r;
+        len -= (size_t)r;
+    }
+    close(fd);
+
+    return 0;
+}
+
+/* splitmix64, expands a seed into the state of xoshiro */
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+static void xoshiro_seed(uint64_t seed, uint64_t stream) {
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+
+    for (int i = 0; i < 4; i++) {
+        xoshiro[i] = splitmix64(&x);
+    }
+    xoshiro_seeded = 1;
+}
+
+/* Seed of the streams, taken from the system if prng_seed was not called. Called with seed_mutex held */
+static uint64_t base_seed_locked() {
+    if (!base_seeded) {
+        if (system_entropy(&base_seed, sizeof(base_seed)) != 0) {
+            base_seed = (uint64_t)time(NULL) ^ (uint64_t)getpid();
+        }
+        base_seeded = 1;
+    }
+
+    return base_seed;
+}
+
+/* First use in a thread: next stream of the seed */
+static void xoshiro_seed_thread() {
+    uint64_t seed, stream;
+
+    pthread_mutex_lock(&seed_mutex);
+    seed = base_seed_locked();
+    stream = next_stream++;
+    pthread_mutex_unlock(&seed_mutex);
+
+    xoshiro_seed(seed, stream);
+}
+
+void prng_seed(uint64_t seed) {
+    pthread_mutex_lock(&seed_mutex);
+    base_seed = seed;
+    base_seeded = 1;
+    next_stream = 1;
+    pthread_mutex_unlock(&seed_mutex);
+
+    xoshiro_seed(seed, 0);
+}
+
+void prng_seed_stream(uint64_t stream) {
+    uint64_t seed;
+
+    pthread_mutex_lock(&seed_mutex);
+    seed = base_seed_locked();
+    pthread_mutex_unlock(&seed_mutex);
+
+    /* The highest bit keeps these streams apart from the ones given in order of first use */
+    xoshiro_seed(seed, stream | (1ULL << 63));
+}
+
+uint64_t prng_next() {
+    uint64_t result, t;
+
+    if (!xoshiro_seeded) {
+        xoshiro_seed_thread();
+    }
+
+    result = ROTL64(xoshiro[1] * 5, 7) * 9;
+    t = xoshiro[1] << 17;
+    xoshiro[2] ^= xoshiro[0];
+    xoshiro[3] ^= xoshiro[1];
+    xoshiro[1] ^= xoshiro[2];
+    xoshiro[0] ^= xoshiro[3];
+    xoshiro[2] ^= t;
+    xoshiro[3] = ROTL64(xoshiro[3], 45);
+
+    return result;
+}
+
+uint64_t prng_range(uint64_t n) {
+    /* 2^64 mod n numbers at the start are rejected, the rest cover every value the same number of times */
+    uint64_t threshold = (0 - n) % n, r;
+
+    do {
+        r = prng_next();
+    } while (r < threshold);
+
+    return r % n;
+}
+
+void prng_fill(void *buffer, size_t len) {
+    uint8_t *p = (uint8_t *)buffer;
+    uint64_t r;
+
+    for (; len >= 8; len -= 8, p += 8) {
+        r = prng_next();
+        memcpy(p, &r, 8);
+    }
+    if (len > 0) {
+        r = prng_next();
+        memcpy(p, &r, len);
+    }
+}
+
+#define QUARTER_ROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8); \
+    c += d; b ^= c; b = ROTL32(b, 7)
+
+/* Next block of the ChaCha20 stream (RFC 8439), the counter is the word 12 (and 13, 64 bit counter) */
+static void chacha_next_block() {
+    uint32_t x[16];
+
+    memcpy(x, chacha_state, sizeof(x));
+    for (int i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        x[i] += chacha_state[i];
+        chacha_block[4 * i] = (uint8_t)x[i];
+        chacha_block[4 * i + 1] = (uint8_t)(x[i] >> 8);
+        chacha_block[4 * i + 2] = (uint8_t)(x[i] >> 16);
+        chacha_block[4 * i + 3] = (uint8_t)(x[i] >> 24);
+    }
+
+    if (++chacha_state[12] == 0) {
+        chacha_state[13]++;
+    }
+    chacha_used = 0;
+}
+
+static int chacha_key_thread() {
+    uint8_t seed[40];
+
+    if (system_entropy(seed, sizeof(seed)) != 0) {
+        return -1;
+    }
+
+    /* "expand 32-byte k", key of 256 bits, counter 0 and nonce of 64 bits */
+    chacha_state[0] = 0x61707865;
+    chacha_state[1] = 0x3320646e;
+    chacha_state[2] = 0x79622d32;
+    chacha_state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) {
+        memcpy(&chacha_state[4 + i], seed + 4 * i, 4);
+    }
+    chacha_state[12] = 0;
+    chacha_state[13] = 0;
+    memcpy(&chacha_state[14], seed + 32, 8);
+
+    memset(seed, 0, sizeof(seed));
+    chacha_used = 64;
+    chacha_keyed = 1;
+
+    return 0;
+}
+
+int prng_secure_fill(void *buffer, size_t len) {
+    uint8_t *p = (uint8_t *)buffer;
+    size_t n;
+
+    if (!chacha_keyed && chacha_key_thread() != 0) {
+        return -1;
+    }
+
+    while (len > 0) {
+        if (chacha_used == 64) {
+            chacha_next_block();
+        }
+        n = 64 - (size_t)chacha_used < len ? 64 - (size_t)chacha_used : len;
+        memcpy(p, chacha_block + chacha_used, n);
+        /* The bytes given are not kept */
+        memset(chacha_block + chacha_used, 0, n);
+        chacha_used += (int)n;
+        p += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+void prng_seed_gmp(gmp_randstate_t state) {
+    uint64_t words[2];
+    mpz_t seed;
+
+    words[0] = prng_next();
+    words[1] = prng_next();
+
+    mpz_init(seed);
+    mpz_import(seed, 2, 1, sizeof(uint64_t), 0, 0, words);
+    gmp_randseed(state, seed);
+    mpz_clear(seed);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file prng.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Random numbers of the project. prng_next is xoshiro256** with one state per thread: fast and
+ *        reproducible with prng_seed (each thread gets its own stream derived from the seed), or seeded from
+ *        the system if prng_seed is never called. prng_secure_fill is a ChaCha20 stream keyed per thread with
+ *        getrandom, for keys and secret values
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PRNG_H
+#define PRNG_H
+
+#include "utils.h"
+
+/**
+ * @brief Seeds the generator: the calling thread restarts its stream, and the threads that draw their first
+ *        number after the call derive their streams from the same seed
+ *
+ * @param seed seed
+ */
+void prng_seed(uint64_t seed);
+
+/**
+ * @brief Restarts the stream of the calling thread as the stream number stream of the seed. The streams given
+ *        to the threads in order of first use depend on which thread draws first; a worker that chooses its
+ *        stream by its index gets the same numbers on every run with the same seed
+ *
+ * @param stream number of the stream (the index of the worker)
+ */
+void prng_seed_stream(uint64_t stream);
+
+/**
+ * @brief Returns the next random number of the thread
+ *
+ * @return uint64_t random number of 64 bits
+ */
+uint64_t prng_next();
+
+/**
+ * @brief Returns a random number in [0, n) with no bias (rejection of the last incomplete interval)
+ *
+ * @param n size of the range, greater than 0
+ *
+ * @return uint64_t random number
+ */
+uint64_t prng_range(uint64_t n);
+
+/**
+ * @brief Fills a buffer with random bytes of prng_next
+ *
+ * @param buffer buffer
+ * @param len bytes to fill
+ */
+void prng_fill(void *buffer, size_t len);
+
+/**
+ * @brief Fills a buffer with cryptographically secure random bytes (ChaCha20 keyed from getrandom)
+ *
+ * @param buffer buffer
+ * @param len bytes to fill
+ *
+ * @return int 0 if the buffer was filled, -1 if the system gave no entropy
+ */
+int prng_secure_fill(void *buffer, size_t len);
+
+/**
+ * @brief Seeds a GMP random state with 128 bits of prng_next, so it follows prng_seed
+ *
+ * @param state state to seed
+ */
+void prng_seed_gmp(gmp_randstate_t state);
+
+#endif
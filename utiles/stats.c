@@ -0,0 +1,97 @@
+/**
+ * @file stats.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in stats.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stats.h"
+
+static const char *counter_names[STATS_NUM_COUNTERS] = {
+    "prime_calls", "prime_candidates", "sieve_calls", "sieve_rejected", "sieve_divisions",
+    "mr_calls", "mr_rounds", "mr_composites", "powm_calls", "powm_squarings", "powm_multiplications",
+    "euclides_calls", "euclides_steps", "vegas_calls", "vegas_witnesses"
+};
+
+static const char *timer_names[STATS_NUM_TIMERS] = {
+    "prime_time", "sieve_time", "mr_time", "vegas_time"
+};
+
+/* Block of the thread, and list of the blocks of every thread (blocks are never freed, so the
+   counters of finished threads are still added) */
+static __thread stats_block *local_block = NULL;
+static stats_block *all_blocks = NULL;
+static pthread_mutex_t blocks_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+stats_block *stats_local() {
+    if (local_block != NULL) {
+        return local_block;
+    }
+
+    local_block = (stats_block *)calloc(1, sizeof(stats_block));
+    if (local_block == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        exit(1);
+    }
+
+    pthread_mutex_lock(&blocks_mutex);
+    local_block->next = all_blocks;
+    all_blocks = local_block;
+    pthread_mutex_unlock(&blocks_mutex);
+
+    return local_block;
+}
+
+void stats_collect(stats_block *total) {
+    memset(total, 0, sizeof(stats_block));
+
+    pthread_mutex_lock(&blocks_mutex);
+    for (stats_block *block = all_blocks; block != NULL; block = block->next) {
+        for (int i = 0; i < STATS_NUM_COUNTERS; i++) {
+            total->counters[i] += block->counters[i];
+        }
+        for (int i = 0; i < STATS_NUM_TIMERS; i++) {
+            total->timers[i] += block->timers[i];
+        }
+    }
+    pthread_mutex_unlock(&blocks_mutex);
+}
+
+/* a / b, or 0 if b is 0 */
+static double ratio(unsigned long long a, unsigned long long b) {
+    return b == 0 ? 0 : (double)a / b;
+}
+
+void stats_print(FILE *out) {
+    stats_block total;
+
+    stats_collect(&total);
+
+    fprintf(out, "Statistics:\n");
+    for (int i = 0; i < STATS_NUM_COUNTERS; i++) {
+        fprintf(out, "  %-22s %llu\n", counter_names[i], total.counters[i]);
+    }
+    for (int i = 0; i < STATS_NUM_TIMERS; i++) {
+        fprintf(out, "  %-22s %lf\n", timer_names[i], total.timers[i]);
+    }
+
+    fprintf(out, "  %-22s %lf\n", "candidates_per_prime",
+            ratio(total.counters[STATS_PRIME_CANDIDATES], total.counters[STATS_PRIME_CALLS]));
+    fprintf(out, "  %-22s %lf\n", "sieve_reject_rate",
+            ratio(total.counters[STATS_SIEVE_REJECTED], total.counters[STATS_SIEVE_CALLS]));
+    fprintf(out, "  %-22s %lf\n", "mr_rounds_per_call",
+            ratio(total.counters[STATS_MR_ROUNDS], total.counters[STATS_MR_CALLS]));
+    fprintf(out, "  %-22s %lf\n", "mults_per_powm",
+            ratio(total.counters[STATS_POWM_SQUARINGS] + total.counters[STATS_POWM_MULTIPLICATIONS],
+                  total.counters[STATS_POWM_CALLS]));
+    fprintf(out, "  %-22s %lf\n", "witnesses_per_vegas",
+            ratio(total.counters[STATS_VEGAS_WITNESSES], total.counters[STATS_VEGAS_CALLS]));
+}
+
+void stats_print_at_exit() {
+    stats_print(stderr);
+}
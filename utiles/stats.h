@@ -0,0 +1,102 @@
+/**
+ * @file stats.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Counters and timers of the number theory kernels (candidates, sieve, Miller-Rabin rounds, modular
+ *        multiplications...). They are only compiled when CRYPTO_STATS is defined (make STATS=1), otherwise
+ *        every macro expands to nothing. Each thread updates its own block, so there are no locks in the
+ *        hot paths, and the blocks of all the threads are added when the statistics are printed
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "utils.h"
+
+/**
+ * @brief Counters of the kernels
+ */
+typedef enum {
+    STATS_PRIME_CALLS,          /* Calls to generate_prime_number */
+    STATS_PRIME_CANDIDATES,     /* Candidates tested by generate_prime_number */
+    STATS_SIEVE_CALLS,          /* Calls to check_divisibility_first_primes */
+    STATS_SIEVE_REJECTED,       /* Candidates with a small factor */
+    STATS_SIEVE_DIVISIONS,      /* Small primes tried by the sieve */
+    STATS_MR_CALLS,             /* Calls to test_miller_rabin */
+    STATS_MR_ROUNDS,            /* Witnesses tested by Miller-Rabin */
+    STATS_MR_COMPOSITES,        /* Numbers found composite by Miller-Rabin */
+    STATS_POWM_CALLS,           /* Calls to potencia_modular */
+    STATS_POWM_SQUARINGS,       /* Modular squarings of potencia_modular */
+    STATS_POWM_MULTIPLICATIONS, /* Modular multiplications of potencia_modular */
+    STATS_EUCLIDES_CALLS,       /* Calls to euclides */
+    STATS_EUCLIDES_STEPS,       /* Divisions of euclides */
+    STATS_VEGAS_CALLS,          /* Calls to vegas_attack */
+    STATS_VEGAS_WITNESSES,      /* Witnesses tried by vegas_attack */
+    STATS_NUM_COUNTERS
+} stats_counter;
+
+/**
+ * @brief Timers of the kernels (seconds)
+ */
+typedef enum {
+    STATS_TIME_PRIME,           /* generate_prime_number */
+    STATS_TIME_SIEVE,           /* check_divisibility_first_primes */
+    STATS_TIME_MR,              /* test_miller_rabin */
+    STATS_TIME_VEGAS,           /* vegas_attack */
+    STATS_NUM_TIMERS
+} stats_timer;
+
+/**
+ * @brief Counters and timers of one thread
+ */
+typedef struct stats_block {
+    unsigned long long counters[STATS_NUM_COUNTERS];
+    double timers[STATS_NUM_TIMERS];
+    struct stats_block *next;   /* Next block of the list of threads */
+} stats_block;
+
+/**
+ * @brief Returns the block of the calling thread, creating and registering it the first time
+ *
+ * @return stats_block* block of the thread
+ */
+stats_block *stats_local();
+
+/**
+ * @brief Adds the blocks of all the threads
+ *
+ * @param total (return) sum of the counters and timers
+ */
+void stats_collect(stats_block *total);
+
+/**
+ * @brief Prints the counters and timers of all the threads, and the ratios used to tune the kernels
+ *
+ * @param out output file
+ */
+void stats_print(FILE *out);
+
+/**
+ * @brief Prints the statistics to stderr, to be registered with atexit (stdout may be parsed by scripts)
+ */
+void stats_print_at_exit();
+
+#ifdef CRYPTO_STATS
+#define STATS_INC(counter) (stats_local()->counters[counter]++)
+#define STATS_ADD(counter, n) (stats_local()->counters[counter] += (n))
+#define STATS_TIMER_START(var) double var = get_wall_time()
+#define STATS_TIMER_STOP(timer, var) (stats_local()->timers[timer] += get_wall_time() - (var))
+#define STATS_PRINT_AT_EXIT() atexit(stats_print_at_exit)
+#else
+#define STATS_INC(counter) ((void)0)
+#define STATS_ADD(counter, n) ((void)0)
+#define STATS_TIMER_START(var) ((void)0)
+#define STATS_TIMER_STOP(timer, var) ((void)0)
+#define STATS_PRINT_AT_EXIT() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ * @file stream_io.c
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief This file contains the implementation of the functions defined in stream_io.h
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "stream_io.h"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Writes len bytes to a file descriptor, repeating the partial writes */
+static int write_all_fd(int fd, const uint8_t *data, size_t len) {
+    ssize_t w;
+
+    while (len > 0) {
+        w = write(fd, data, len);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += w;
+        len -= (size_t)w;
+    }
+
+    return 0;
+}
+
+/* Maps the window that starts at reader->offset */
+static int stream_reader_map(stream_reader *reader) {
+    off_t left = reader->size - reader->offset;
+    void *window;
+
+    reader->window_len = left < STREAM_IO_MAP_WINDOW ? (size_t)left : STREAM_IO_MAP_WINDOW;
+    reader->pos = 0;
+
+    window = mmap(NULL, reader->window_len, PROT_READ, MAP_PRIVATE, reader->fd, reader->offset);
+    if (window == MAP_FAILED) {
+        reader->window = NULL;
+        return -1;
+    }
+    posix_madvise(window, reader->window_len, POSIX_MADV_SEQUENTIAL);
+    reader->window = (uint8_t *)window;
+
+    return 0;
+}
+
+int stream_reader_open(stream_reader *reader, const char *path) {
+    struct stat st;
+
+    memset(reader, 0, sizeof(stream_reader));
+
+    if (path != NULL) {
+        reader->fd = open(path, O_RDONLY);
+        if (reader->fd < 0) {
+            printf("Error al abrir el archivo de entrada\n");
+            return -1;
+        }
+        reader->own = 1;
+    } else {
+        reader->fd = STDIN_FILENO;
+    }
+
+    /* Regular files are mapped, the rest (or if mmap fails) are read with read() */
+    if (fstat(reader->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        reader->size = st.st_size;
+        if (stream_reader_map(reader) == 0) {
+            reader->mapped = 1;
+            return 0;
+        }
+    }
+
+    if (posix_memalign((void **)&reader->buffer, STREAM_IO_ALIGN, STREAM_IO_CHUNK) != 0) {
+        printf("Error en la asignacion de memoria\n");
+        stream_reader_close(reader);
+        return -1;
+    }
+
+    return 0;
+}
+
+long long stream_reader_next(stream_reader *reader, const uint8_t **data, size_t max) {
+    size_t n;
+    ssize_t r;
+
+    if (reader->mapped) {
+        if (reader->pos == reader->window_len) {
+            if (reader->window != NULL) {
+                munmap(reader->window, reader->window_len);
+                reader->window = NULL;
+            }
+            reader->offset += (off_t)reader->window_len;
+            if (reader->offset >= reader->size) {
+                return 0;
+            }
+            if (stream_reader_map(reader) != 0) {
+                return -1;
+            }
+        }
+
+        n = reader->window_len - reader->pos;
+        if (max > 0 && n > max) {
+            n = max;
+        }
+        *data = reader->window + reader->pos;
+        reader->pos += n;
+
+        return (long long)n;
+    }
+
+    n = max > 0 && max < STREAM_IO_CHUNK ? max : STREAM_IO_CHUNK;
+    do {
+        r = read(reader->fd, reader->buffer, n);
+    } while (r < 0 && errno == EINTR);
+
+    *data = reader->buffer;
+
+    return (long long)r;
+}
+
+void stream_reader_close(stream_reader *reader) {
+    if (reader->window != NULL) {
+        munmap(reader->window, reader->window_len);
+    }
+    if (reader->own) {
+        close(reader->fd);
+    }
+    free(reader->buffer);
+    memset(reader, 0, sizeof(stream_reader));
+}
+
+int stream_writer_open(stream_writer *writer, const char *path) {
+    memset(writer, 0, sizeof(stream_writer));
+
+    if (path != NULL) {
+        writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (writer->fd < 0) {
+            printf("Error al abrir el archivo de salida\n");
+            return -1;
+        }
+        writer->own = 1;
+    } else {
+        fflush(stdout);
+        writer->fd = STDOUT_FILENO;
+    }
+
+    if (posix_memalign((void **)&writer->buffer, STREAM_IO_ALIGN, STREAM_IO_CHUNK) != 0) {
+        printf("Error en la asignacion de memoria\n");
+        if (writer->own) {
+            close(writer->fd);
+        }
+        return -1;
+    }
+
+    return 0;
+}
+
+int stream_writer_flush(stream_writer *writer) {
+    if (write_all_fd(writer->fd, writer->buffer, writer->used) != 0) {
+        return -1;
+    }
+    writer->used = 0;
+
+    return 0;
+}
+
+uint8_t *stream_writer_space(stream_writer *writer, size_t *avail) {
+    if (writer->used == STREAM_IO_CHUNK && stream_writer_flush(writer) != 0) {
+        return NULL;
+    }
+
+    *avail = STREAM_IO_CHUNK - writer->used;
+
+    return writer->buffer + writer->used;
+}
+
+void stream_writer_commit(stream_writer *writer, size_t n) {
+    writer->used += n;
+}
+
+int stream_writer_write(stream_writer *writer, const uint8_t *data, size_t len) {
+    uint8_t *space;
+    size_t avail;
+
+    while (len > 0) {
+        space = stream_writer_space(writer, &avail);
+        if (space == NULL) {
+            return -1;
+        }
+        if (avail > len) {
+            avail = len;
+        }
+        memcpy(space, data, avail);
+        stream_writer_commit(writer, avail);
+        data += avail;
+        len -= avail;
+    }
+
+    return 0;
+}
+
+int stream_writer_close(stream_writer *writer) {
+    int result = stream_writer_flush(writer);
+
+    if (writer->own && close(writer->fd) != 0) {
+        result = -1;
+    }
+    free(writer->buffer);
+    memset(writer, 0, sizeof(stream_writer));
+
+    return result;
+}
+
+uint8_t *stream_read_all(const char *path, size_t *len) {
+    stream_reader reader;
+    const uint8_t *chunk;
+    uint8_t *data, *aux;
+    size_t capacity;
+    long long n;
+
+    if (stream_reader_open(&reader, path) != 0) {
+        return NULL;
+    }
+
+    /* The size of a mapped file is known, the rest grow as needed */
+    capacity = reader.mapped ? (size_t)reader.size : STREAM_IO_CHUNK;
+    data = (uint8_t *)malloc(capacity + 1);
+    if (data == NULL) {
+        printf("Error en la asignacion de memoria\n");
+        stream_reader_close(&reader);
+        return NULL;
+    }
+
+    *len = 0;
+    while ((n = stream_reader_next(&reader, &chunk, 0)) > 0) {
+        if (*len + (size_t)n > capacity) {
+            while (*len + (size_t)n > capacity) {
+                capacity *= 2;
+            }
+            aux = (uint8_t *)realloc(data, capacity + 1);
+            if (aux == NULL) {
+                printf("Error en la asignacion de memoria\n");
+                free(data);
+                stream_reader_close(&reader);
+                return NULL;
+            }
+            data = aux;
+        }
+        memcpy(data + *len, chunk, (size_t)n);
+        *len += (size_t)n;
+    }
+    stream_reader_close(&reader);
+
+    if (n < 0) {
+        free(data);
+        return NULL;
+    }
+    data[*len] = '\0';
+
+    return data;
+}
+
+int stream_write_all(const char *path, const uint8_t *data, size_t len) {
+    stream_writer writer;
+    int result;
+
+    if (stream_writer_open(&writer, path) != 0) {
+        return -1;
+    }
+
+    /* Large buffers are written directly, without the copy to the buffer of the writer */
+    if (len >= STREAM_IO_CHUNK) {
+        result = write_all_fd(writer.fd, data, len);
+    } else {
+        result = stream_writer_write(&writer, data, len);
+    }
+
+    return stream_writer_close(&writer) != 0 ? -1 : result;
+}
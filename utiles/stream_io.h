@@ -0,0 +1,161 @@
+/**
+ * @file stream_io.h
+ * @author Nicolas Victorino && Ignacio Nunnez
+ * @brief Chunked file I/O with explicit lengths, so binary data with NUL bytes and files larger than memory
+ *        can be processed. Regular files are read through mmap in windows of STREAM_IO_MAP_WINDOW bytes
+ *        (the chunks point into the mapping, no copy); pipes and terminals are read with read() into an
+ *        aligned buffer. The writer collects the output in an aligned buffer of STREAM_IO_CHUNK bytes and
+ *        can give direct access to it, so a cipher can write its result there
+ * @version 0.1
+ * @date 2024-12-12
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STREAM_IO_H
+#define STREAM_IO_H
+
+#include "utils.h"
+
+/* Size of the buffers of read() and of the writer */
+#define STREAM_IO_CHUNK (1024 * 1024)
+/* Bytes of the file mapped at the same time (multiple of the page size) */
+#define STREAM_IO_MAP_WINDOW (64 * 1024 * 1024)
+/* Alignment of the buffers (cache line, enough for SIMD loads) */
+#define STREAM_IO_ALIGN 64
+
+/**
+ * @brief Input file read in chunks
+ */
+typedef struct {
+    int fd;
+    int own;                /* 1 if the file was opened by the reader */
+    int mapped;             /* 1 if the file is read with mmap */
+    off_t size;             /* Size of the file (mmap only) */
+    off_t offset;           /* Offset of the window in the file */
+    uint8_t *window;        /* Current window (mmap) */
+    size_t window_len;
+    size_t pos;             /* Bytes of the window already returned */
+    uint8_t *buffer;        /* Buffer of read() */
+} stream_reader;
+
+/**
+ * @brief Output file written in chunks
+ */
+typedef struct {
+    int fd;
+    int own;                /* 1 if the file was opened by the writer */
+    uint8_t *buffer;
+    size_t used;
+} stream_writer;
+
+/**
+ * @brief Opens a file for reading
+ *
+ * @param reader (return) reader
+ * @param path name of the file. If it is NULL the standard input is read
+ *
+ * @return int 0 if the file was opened, -1 otherwise
+ */
+int stream_reader_open(stream_reader *reader, const char *path);
+
+/**
+ * @brief Returns the next chunk of the file. The chunk is valid until the next call
+ *
+ * @param reader reader
+ * @param data (return) pointer to the chunk
+ * @param max maximum size of the chunk (0 for no limit)
+ *
+ * @return long long size of the chunk, 0 at the end of the file, -1 if there was an error
+ */
+long long stream_reader_next(stream_reader *reader, const uint8_t **data, size_t max);
+
+/**
+ * @brief Closes a reader
+ *
+ * @param reader reader
+ */
+void stream_reader_close(stream_reader *reader);
+
+/**
+ * @brief Opens (and truncates) a file for writing
+ *
+ * @param writer (return) writer
+ * @param path name of the file. If it is NULL the standard output is written
+ *
+ * @return int 0 if the file was opened, -1 otherwise
+ */
+int stream_writer_open(stream_writer *writer, const char *path);
+
+/**
+ * @brief Gives the free part of the buffer of the writer, flushing it first if it is full. The bytes written
+ *        there are added to the output with stream_writer_commit
+ *
+ * @param writer writer
+ * @param avail (return) free bytes of the buffer
+ *
+ * @return uint8_t* start of the free part, NULL if there was an error
+ */
+uint8_t *stream_writer_space(stream_writer *writer, size_t *avail);
+
+/**
+ * @brief Adds to the output n bytes written in the space given by stream_writer_space
+ *
+ * @param writer writer
+ * @param n number of bytes, at most the avail of stream_writer_space
+ */
+void stream_writer_commit(stream_writer *writer, size_t n);
+
+/**
+ * @brief Writes len bytes
+ *
+ * @param writer writer
+ * @param data bytes to write
+ * @param len number of bytes
+ *
+ * @return int 0 if the bytes were written, -1 otherwise
+ */
+int stream_writer_write(stream_writer *writer, const uint8_t *data, size_t len);
+
+/**
+ * @brief Writes the buffer to the file
+ *
+ * @param writer writer
+ *
+ * @return int 0 if the buffer was written, -1 otherwise
+ */
+int stream_writer_flush(stream_writer *writer);
+
+/**
+ * @brief Flushes and closes a writer
+ *
+ * @param writer writer
+ *
+ * @return int 0 if everything was written, -1 otherwise
+ */
+int stream_writer_close(stream_writer *writer);
+
+/**
+ * @brief Reads a whole file into memory. One byte more is allocated and set to '\0', so text files can be
+ *        used as strings, but the length does not depend on it
+ *
+ * @param path name of the file. If it is NULL the standard input is read
+ * @param len (return) number of bytes read
+ *
+ * @return uint8_t* contents of the file (to free), NULL if there was an error
+ */
+uint8_t *stream_read_all(const char *path, size_t *len);
+
+/**
+ * @brief Writes len bytes to a file
+ *
+ * @param path name of the file. If it is NULL the standard output is written
+ * @param data bytes to write
+ * @param len number of bytes
+ *
+ * @return int 0 if the bytes were written, -1 otherwise
+ */
+int stream_write_all(const char *path, const uint8_t *data, size_t len);
+
+#endif
@@ -8,57 +8,143 @@
 */
 
 #include "utils.h"
+#include "stats.h"
+#include "stream_io.h"
+#include "prng.h"
+#include "permutation.h"
+#include "intmath.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define DEFALUT_TEXT_SIZE 1000
 
-/* Function to preprocess the text to encode*/
-void filtrarTexto(char *texto) {
-    int i = 0;
-    while (texto[i] != '\0') {
-        if (texto[i] >= 'A' && texto[i] <= 'Z') {
-            texto[i] = texto[i] + 32;
-        } else if (texto[i] < 'a' || texto[i] > 'z') {
-            /* Elimino el caracter*/
-            int j = i;
-            while (texto[j] != '\0') {
-                texto[j] = texto[j + 1];
-                j++;
+/* filter_table[c] is the lower case letter of c, or 0 if c is not a letter and has to be removed */
+static uint8_t filter_table[256];
+static pthread_once_t filter_once = PTHREAD_ONCE_INIT;
+
+static void filter_build_table() {
+    for (int c = 0; c < 256; c++) {
+        if (c >= 'a' && c <= 'z') {
+            filter_table[c] = (uint8_t)c;
+        } else if (c >= 'A' && c <= 'Z') {
+            filter_table[c] = (uint8_t)(c + 32);
+        }
+    }
+}
+
+size_t filter_text_chunk(uint8_t *out, const uint8_t *in, size_t len) {
+    size_t i = 0, n = 0;
+    uint8_t c;
+
+    pthread_once(&filter_once, filter_build_table);
+
+#ifdef __SSE2__
+    /* 16 bytes at a time: c | 0x20 is the lower case of a letter, and it is a letter if it is in 'a'..'z'
+       (the bytes >= 0x80 are negative in the signed comparison, so they are never letters) */
+    {
+        const __m128i case_bit = _mm_set1_epi8(0x20);
+        const __m128i before_a = _mm_set1_epi8('a' - 1);
+        const __m128i after_z = _mm_set1_epi8('z' + 1);
+        __m128i v, lower;
+        uint8_t lowered[16];
+        unsigned int mask;
+
+        for (; i + 16 <= len; i += 16) {
+            v = _mm_loadu_si128((const __m128i *)(in + i));
+            lower = _mm_or_si128(v, case_bit);
+            mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                                                                 _mm_cmpgt_epi8(after_z, lower)));
+            if (mask == 0xFFFF) {
+                /* n <= i, so the store never overwrites bytes that have not been read */
+                _mm_storeu_si128((__m128i *)(out + n), lower);
+                n += 16;
+            } else if (mask != 0) {
+                _mm_storeu_si128((__m128i *)lowered, lower);
+                while (mask != 0) {
+                    out[n++] = lowered[__builtin_ctz(mask)];
+                    mask &= mask - 1;
+                }
             }
-            /* Como he eliminado un caracter, tengo que mover el indice para atras*/
-            i--;
         }
-        i++;
     }
+#endif
+
+    for (; i < len; i++) {
+        c = filter_table[in[i]];
+        out[n] = c;
+        n += c != 0;
+    }
+
+    return n;
 }
 
-/* Function to get the input text*/
-char * handleInputText(char *i) {
+/* Function to preprocess the text to encode*/
+void filtrarTexto(char *texto) {
+    size_t len = strlen(texto);
 
-    FILE *filein;
-    char *texto;
+    texto[filter_text_chunk((uint8_t *)texto, (const uint8_t *)texto, len)] = '\0';
+}
 
-    if (i != NULL) {
+long long filter_text_file(char *i, char *o) {
+    stream_reader reader;
+    stream_writer writer;
+    const uint8_t *chunk;
+    uint8_t *space;
+    size_t avail;
+    long long n, total = 0;
 
-        filein = fopen(i, "r");
-        if (filein == NULL) {
-            printf("Error al abrir el archivo de entrada\n");
-            return NULL;
+    if (stream_reader_open(&reader, i) != 0) {
+        return -1;
+    }
+    if (stream_writer_open(&writer, o) != 0) {
+        stream_reader_close(&reader);
+        return -1;
+    }
+
+    /* The output of a chunk is never longer than the chunk, so it is filtered straight into the writer */
+    do {
+        space = stream_writer_space(&writer, &avail);
+        if (space == NULL) {
+            n = -1;
+            break;
+        }
+        n = stream_reader_next(&reader, &chunk, avail);
+        if (n > 0) {
+            stream_writer_commit(&writer, filter_text_chunk(space, chunk, (size_t)n));
+            total += n;
         }
+    } while (n > 0);
 
-        fseek(filein, 0, SEEK_END);
-        long fsize = ftell(filein);
-        fseek(filein, 0, SEEK_SET);
+    stream_reader_close(&reader);
+    if (stream_writer_close(&writer) != 0 || n < 0) {
+        return -1;
+    }
 
-        texto = malloc(fsize + 1);
-        fread(texto, fsize, 1, filein);
-        fclose(filein);
-        texto[fsize] = '\0';
+    return total;
+}
 
+/* Function to get the input text*/
+char * handleInputText(char *i) {
+
+    char *texto;
+    size_t len;
+
+    if (i != NULL) {
+        /* The file is read in chunks (mmap if possible), not with its size from fseek/ftell */
+        texto = (char *)stream_read_all(i, &len);
     } else {
         texto = malloc(DEFALUT_TEXT_SIZE + 1);
+        if (texto == NULL) {
+            printf("Error en la asignacion de memoria\n");
+            return NULL;
+        }
         printf("Introduce el texto a cifrar (máximo %d caracteres): ", DEFALUT_TEXT_SIZE);
-        fgets(texto, DEFALUT_TEXT_SIZE , stdin);
-        texto[strlen(texto) - 1] = '\0';
+        if (fgets(texto, DEFALUT_TEXT_SIZE, stdin) == NULL) {
+            texto[0] = '\0';
+        }
+        texto[strcspn(texto, "\n")] = '\0';
     }
 
     return texto;
@@ -67,19 +153,30 @@ char * handleInputText(char *i) {
 /* Function to handle the output of text*/
 int handleOutputText(char *o, char *texto) {
 
-    FILE *fileout;
-
     if (o != NULL) {
-        fileout = fopen(o, "w");
-        if (fileout == NULL) {
-            printf("Error al abrir el archivo de salida\n");
+        return stream_write_all(o, (const uint8_t *)texto, strlen(texto));
+    }
+
+    printf("%s\n", texto);
+
+    return 0;
+}
+
+/* Function to convert hexadecimal digits to bytes */
+int parse_hex(const char *hex, uint8_t *bytes, int len) {
+    char byte[3] = {0};
+
+    if ((int)strlen(hex) != 2 * len) {
+        return -1;
+    }
+
+    for (int i = 0; i < len; i++) {
+        if (!isxdigit((unsigned char)hex[2 * i]) || !isxdigit((unsigned char)hex[2 * i + 1])) {
             return -1;
         }
-
-        fprintf(fileout, "%s", texto);
-        fclose(fileout);
-    } else {
-        printf("%s\n", texto);
+        byte[0] = hex[2 * i];
+        byte[1] = hex[2 * i + 1];
+        bytes[i] = (uint8_t)strtol(byte, NULL, 16);
     }
 
     return 0;
@@ -95,9 +192,7 @@ char* addFilling(int n, char *texto) {
         exit(1);
     }
 
-    for (int x = len; x < new_len; x++) {
-        texto[x] = 'x';
-    }
+    memset(texto + len, 'x', new_len - len);
     texto[new_len] = '\0';
 
     return texto;
@@ -112,10 +207,11 @@ mpz_t *euclides(mpz_t a, mpz_t b, int * z) {
     }
 
     int i = 0; 
-    mpz_t temp, tempa, tempb;
+    mpz_t tempa, tempb;
     mpz_t *result = NULL;
 
-    mpz_init(temp);
+    STATS_INC(STATS_EUCLIDES_CALLS);
+
     mpz_init(tempb);
     mpz_init(tempa);
 
@@ -130,17 +226,14 @@ mpz_t *euclides(mpz_t a, mpz_t b, int * z) {
 
         if (result == NULL) {
             printf("Error en la asignacion de memoria\n");
-            mpz_clear(temp);
             mpz_clear(tempa);
             mpz_clear(tempb);
             exit(1);
         }
         mpz_init(result[i]);
 
-        mpz_tdiv_q(result[i], a, b);
-        mpz_mod(temp, a, b);
-        mpz_set(a, b);
-        mpz_set(b, temp);
+        euclides_step(result[i], a, b);
+        STATS_INC(STATS_EUCLIDES_STEPS);
 
         i++;
     }
@@ -154,7 +247,6 @@ mpz_t *euclides(mpz_t a, mpz_t b, int * z) {
     mpz_set(a, tempa);
     mpz_set(b, tempb);
 
-    mpz_clear(temp);
     mpz_clear(tempa);
     mpz_clear(tempb);
 
@@ -162,6 +254,53 @@ mpz_t *euclides(mpz_t a, mpz_t b, int * z) {
 
 }
 
+/*One division step of the Euclides algorithm*/
+void euclides_step(mpz_t quotient, mpz_t a, mpz_t b) {
+    /* a = quotient*b + r, then (a, b) = (b, r) */
+    mpz_tdiv_qr(quotient, a, a, b);
+    mpz_swap(a, b);
+}
+
+/*Streaming continued fraction of num/den*/
+void continued_fraction_init(continued_fraction *cf, const mpz_t num, const mpz_t den) {
+    mpz_init_set(cf->a, num);
+    mpz_init_set(cf->b, den);
+    mpz_init(cf->quotient);
+
+    /* h(-1) = 1, h(-2) = 0, k(-1) = 0, k(-2) = 1 */
+    mpz_init_set_ui(cf->h, 1);
+    mpz_init_set_ui(cf->h_prev, 0);
+    mpz_init_set_ui(cf->k, 0);
+    mpz_init_set_ui(cf->k_prev, 1);
+}
+
+int continued_fraction_next(continued_fraction *cf) {
+
+    if (mpz_sgn(cf->b) == 0) {
+        return 0;
+    }
+
+    euclides_step(cf->quotient, cf->a, cf->b);
+
+    /* h(i) = q*h(i-1) + h(i-2), k(i) = q*k(i-1) + k(i-2) */
+    mpz_addmul(cf->h_prev, cf->quotient, cf->h);
+    mpz_swap(cf->h, cf->h_prev);
+    mpz_addmul(cf->k_prev, cf->quotient, cf->k);
+    mpz_swap(cf->k, cf->k_prev);
+
+    return 1;
+}
+
+void continued_fraction_clear(continued_fraction *cf) {
+    mpz_clear(cf->a);
+    mpz_clear(cf->b);
+    mpz_clear(cf->quotient);
+    mpz_clear(cf->h);
+    mpz_clear(cf->h_prev);
+    mpz_clear(cf->k);
+    mpz_clear(cf->k_prev);
+}
+
 /*Function to get the greatest common divisor*/
 void euclides_mcd(mpz_t a, mpz_t b, mpz_t result) {
     int z;
@@ -271,23 +410,26 @@ int extended_euclides_inverse(mpz_t a, mpz_t mod, mpz_t result) {
 
 /*Euclides algorithm with ints*/
 int * euclides2(int det, int m, int *z) {
-    int i = 0, temp;
+    int i = 0, temp, a = det, b = m;
     int *result = NULL;
 
-    result = (int *)malloc(1 * sizeof(int));
+    /* First the number of steps, so the array is allocated once */
+    while (a != 0) {
+        temp = b;
+        b = a;
+        a = temp % a;
+        i++;
+    }
+
+    result = (int *)malloc((i + 1) * sizeof(int));
     if (result == NULL) {
         printf("Error en la asignacion de memoria\n");
         exit(1);
     }
 
+    i = 0;
     while (det != 0)   {
 
-        result = (int *)realloc(result, (i+2) * sizeof(int));
-        if (result == NULL) {
-            printf("Error en la asignacion de memoria\n");
-            exit(1);
-        }
-
         result[i] = m / det;
 
         temp = m;
@@ -308,7 +450,7 @@ int * euclides2(int det, int m, int *z) {
 int *extended_euclides2(int det, int m, int *tam) {
     int i, z;
     
-    int *u,*v;
+    int *v;
 
     int *lista = euclides2(det, m, &z);
 
@@ -318,43 +460,26 @@ int *extended_euclides2(int det, int m, int *tam) {
         return NULL;
     }
 
-    u = (int *)malloc(z * sizeof(int));
-    if (u == NULL) {
-        printf("Error en la asignacion de memoria\n");
-        free(lista);
-        exit(1);
-    }
-
-    v = (int *)malloc(z * sizeof(int));
+    /* Room for the base case even if det is 0 and m is 1 */
+    v = (int *)malloc((z < 2 ? 2 : z) * sizeof(int));
     if (v == NULL) {
         printf("Error en la asignacion de memoria\n");
         free(lista);
-        free(u);
         exit(1);
     }
 
-    // Inicializar u y v
-    for (i=0; i<z; i++) {
-        u[i] = 0;
-        v[i] = 0;
-    }
-
     // Caso base
-    u[0] = 1;
-    u[1] = 0;
     v[0] = 0;
     v[1] = 1;
 
-    // Caso general
+    // Caso general (only the coefficients of det are returned)
     for (i=2; i<z; i++) {
-        u[i] = u[i-2] - lista[i-2]*u[i-1];
         v[i] = v[i-2] - lista[i-2]*v[i-1];
     }
 
     *tam = z;
 
     free(lista);
-    free(u);
 
     return v;
 
@@ -362,28 +487,12 @@ int *extended_euclides2(int det, int m, int *tam) {
 
 /*Function to get the greatest common divisor, only returning that value and not a whole list*/ 
 int simpleMCD(int a, int b) {
-
-    if (a < b) {
-        return simpleMCD(b, a);
-    }
-    while (b != 0) {
-        int t = b;
-        b = a % b;
-        a = t;
-    }
-    return a;
+    return int_gcd(a, b);
 }
 
 /*Function to find the gcd of multiple numbers*/
 int find_gcd_of_list(int* numbers, int size) {
-    int result = numbers[0];
-    for (int i = 1; i < size; i++) {
-        result = simpleMCD(result, numbers[i]);
-        if (result == 1) {
-            return 1;
-        }
-    }
-    return result;
+    return int_gcd_list(numbers, size);
 }
 
 int random_num(int inf, int sup)
@@ -397,54 +506,18 @@ int random_num(int inf, int sup)
       return -1;
     }
 
-    res += rand() % (sup - inf + 1); 
+    /* prng_range has no modulo bias */
+    res += (int)prng_range((uint64_t)((long long)sup - inf + 1));
     return res;
 
 }
 
 void generatePermutation(int n , int *permutation) {
-    int i, sust = 0, ran = 0;
-
-    /*Seed for the random numbers*/
-    srand(time(NULL));
-
-    /*  Introducing values to the array*/
-    for (i = 0; i < n; i++)
-    {
-      permutation[i] = i;
-    }
-
-    /*Permutations*/
-    for (i = 0; i < n; i++) 
-    {
-      sust = permutation[i];
-      ran = random_num(i, n - 1);
-      if (ran == -1)
-      {
-        printf("Error en la generación de números aleatorios\n");
-        exit(1);
-      }
-      permutation[i] = permutation[ran];
-      permutation[ran] = sust;
-    }   
+    permutation_generate(permutation, n);
 }
 
 void invertPermutation(int *k, int size) {
-    int i;
-    int *aux = (int *)calloc(size, sizeof(int));
-    if (aux == NULL) {
-        return;
-    }
-
-    for(i = 0; i < size; i++) {
-        aux[k[i]] = i;
-    }
-
-    for(i = 0; i < size; i++) {
-        k[i] = aux[i];
-    }
-
-    free(aux);
+    permutation_invert(k, size);
 }
 
 void print_histogram(int *frequencies) {
@@ -465,38 +538,100 @@ void generate_histogram_with_gnuplot(const char *script_filename) {
     system(command);
 }
 
+/* Function to get the time of the monotonic clock in seconds */
+double get_wall_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
 /* Function to generate a random 64 bits number */
 uint64_t rand64() {
-    uint64_t r = 0;
-    for (int i = 0; i < 64; i++) {
-        r |= (rand() % 2);
-        r <<= 1;
-    }
-    r >>= 1;
-    
-    return r;
+    return prng_next();
+}
+
+/* Mask of the lowest size bits of a word (size between 0 and 64) */
+static uint64_t bit_comparator_mask(int size) {
+    return size >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << size) - 1;
 }
 
 int bit_comparator_counter(uint32_t num1, uint32_t num2, int size) {
-    
-    int counter = 0;
+    return bit_comparator_counter64(num1, num2, size);
+}
+
+void bit_comparator_position(uint32_t num1, uint32_t num2, int *frequencies, int size) {
+    bit_comparator_position64(num1, num2, frequencies, size);
+}
+
+int bit_comparator_counter64(uint64_t num1, uint64_t num2, int size) {
+    return size - __builtin_popcountll((num1 ^ num2) & bit_comparator_mask(size));
+}
+
+void bit_comparator_position64(uint64_t num1, uint64_t num2, int *frequencies, int size) {
+    uint64_t equal = ~(num1 ^ num2) & bit_comparator_mask(size);
+
+    while (equal != 0) {
+        frequencies[__builtin_ctzll(equal)]++;
+        equal &= equal - 1;
+    }
+}
 
-    for (int j = 0; j < size; j++) {
-        if ( ((num1 >> j) % 2) == ((num2 >> j) % 2) ) {
-            counter++;
+int bit_comparator_counter_batch(const uint64_t *num1, const uint64_t *num2, size_t n, int size, int *counts) {
+    int words = (size + 63) / 64, last = size - 64 * (words - 1), different;
+
+    if (size < 1 || size > BIT_COMPARATOR_MAX_BITS) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++, num1 += words, num2 += words) {
+        different = __builtin_popcountll((num1[words - 1] ^ num2[words - 1]) & bit_comparator_mask(last));
+        for (int w = 0; w < words - 1; w++) {
+            different += __builtin_popcountll(num1[w] ^ num2[w]);
         }
+        counts[i] = size - different;
     }
 
-    return counter;
+    return 0;
 }
 
-void bit_comparator_position(uint32_t num1, uint32_t num2, int *frequencies, int size) {
+int bit_comparator_position_batch(const uint64_t *num1, const uint64_t *num2, size_t n, int size, int *frequencies) {
+    /* planes[w][k] holds the bit k of the 64 counters of the positions of the word w */
+    uint64_t planes[BIT_COMPARATOR_MAX_WORDS][8], x, carry;
+    int words = (size + 63) / 64, pending = 0, bits;
+
+    if (size < 1 || size > BIT_COMPARATOR_MAX_BITS) {
+        return -1;
+    }
 
-    for (int j = 0; j < size; j++) {
-        if ( ((num1 >> j) % 2) == ((num2 >> j) % 2) ) {
-            frequencies[j]++;
+    memset(planes, 0, sizeof(planes));
+
+    for (size_t i = 0; i < n; i++, num1 += words, num2 += words) {
+        /* Adds 1 to the counters of the equal positions, the carry goes up the planes */
+        for (int w = 0; w < words; w++) {
+            x = ~(num1[w] ^ num2[w]);
+            for (int k = 0; x != 0; k++) {
+                carry = planes[w][k] & x;
+                planes[w][k] ^= x;
+                x = carry;
+            }
+        }
+
+        /* Counters of 8 bits: they are spread before they overflow */
+        if (++pending == 255 || i == n - 1) {
+            for (int w = 0; w < words; w++) {
+                bits = w == words - 1 ? size - 64 * w : 64;
+                for (int j = 0; j < bits; j++) {
+                    for (int k = 0; k < 8; k++) {
+                        frequencies[64 * w + j] += (int)((planes[w][k] >> j) & 1) << k;
+                    }
+                }
+            }
+            memset(planes, 0, sizeof(planes));
+            pending = 0;
         }
     }
+
+    return 0;
 }
 
 void potencia_modular(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
@@ -509,15 +644,19 @@ void potencia_modular(mpz_t result, const mpz_t base, const mpz_t exp, const mpz
     mpz_t exp_copy;
     mpz_init_set(exp_copy, exp);  // exp_copy = exp
 
+    STATS_INC(STATS_POWM_CALLS);
+
     while (mpz_cmp_ui(exp_copy, 0) > 0) {
         // Si el bit menos significativo de exp es 1
         if (mpz_odd_p(exp_copy)) {
             mpz_mul(x, x, base_mod);
             mpz_mod(x, x, mod);
+            STATS_INC(STATS_POWM_MULTIPLICATIONS);
         }
         // base_mod = (base_mod * base_mod) % mod
         mpz_mul(base_mod, base_mod, base_mod);
         mpz_mod(base_mod, base_mod, mod);
+        STATS_INC(STATS_POWM_SQUARINGS);
 
         // exp_copy = exp_copy / 2
         mpz_fdiv_q_2exp(exp_copy, exp_copy, 1);
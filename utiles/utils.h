@@ -22,6 +22,7 @@
 #include <gmp.h>
 #include <time.h>
 #include <math.h>
+#include <pthread.h>
 
 /* Constantes para el DES */
 #define BITS_IN_PC1 56
@@ -38,6 +39,9 @@
 #define HISTOGRAM_LOWER_BOUND 40
 #define HISTOGRAM_UPPER_BOUND 90
 
+#define BIT_COMPARATOR_MAX_BITS 128
+#define BIT_COMPARATOR_MAX_WORDS (BIT_COMPARATOR_MAX_BITS / 64)
+
 /* "permutacion" PC1 */
 static const unsigned short PC1[BITS_IN_PC1] = {
 	57, 49, 41, 33, 25, 17, 9,
@@ -203,14 +207,39 @@ static const char INV_MIX_COLUMN_MATRIX[BYTES_PER_WORD][BYTES_PER_WORD][HEX_STRI
 #define DECYPHER 1
 
 /**
- * @brief Filters the text to get it ready to get encoded. Transforms all the upper case letters to lower case and removes all the other symbols
+ * @brief Filters the text to get it ready to get encoded. Transforms all the upper case letters to lower case and removes all the other symbols.
+ *        It is done in place in a single pass with filter_text_chunk
  *
  * @param texto the text that is going to get encoded
  */
 void filtrarTexto(char *texto);
 
 /**
- * @brief Function to handle the input of text
+ * @brief Filters a chunk of text like filtrarTexto, in one pass with a table of 256 entries (and 16 bytes at a
+ *        time with SSE2 when it is available). Each byte is filtered on its own, so a text can be filtered in
+ *        chunks of any size
+ *
+ * @param out (return) filtered text, at most len bytes. It may be the same as in
+ * @param in chunk of text, not terminated by '\0'
+ * @param len length of the chunk
+ *
+ * @return size_t length of the filtered text
+ */
+size_t filter_text_chunk(uint8_t *out, const uint8_t *in, size_t len);
+
+/**
+ * @brief Filters a file of any size like filtrarTexto, in chunks (stream_io.h)
+ *
+ * @param i name of the input file. If it is NULL the standard input is read
+ * @param o name of the output file. If it is NULL the standard output is written
+ *
+ * @return long long number of bytes read, -1 if there was an error
+ */
+long long filter_text_file(char *i, char *o);
+
+/**
+ * @brief Function to handle the input of text. Files are read with stream_read_all (stream_io.h), that also
+ *        gives the length for binary data
  *
  * @param i name of the file to open. If it is null we read the text from standard input
  *
@@ -219,7 +248,7 @@ void filtrarTexto(char *texto);
 char *handleInputText(char *i);
 
 /**
- * @brief Function to handle the output of text
+ * @brief Function to handle the output of text. Binary data must be written with stream_write_all (stream_io.h)
  *
  * @param o name of the file to output the text. If it is null we write the text to the standard output
  *
@@ -228,13 +257,25 @@ char *handleInputText(char *i);
 int handleOutputText(char *o, char *texto);
 
 /**
- * @brief Function to add filling to the text that it is going to be encoded. It adds 'x' to make the length of the text a multiple of n (size of the array)
+ * @brief Function to add filling to the text that it is going to be encoded. It adds 'x' to make the length of the text a multiple of n (size of the array).
+ *        It reallocs the text; block_buffer.h reads the data with room for the padding and writes it in place
  *
  * @param n size of the array with the key
  * @param text contains the text to be encoded
  */
 char *addFilling(int n, char *texto);
 
+/**
+ * @brief Converts a string of hexadecimal digits to bytes
+ *
+ * @param hex string with 2 * len hexadecimal digits
+ * @param bytes (return) bytes
+ * @param len number of bytes expected
+ *
+ * @return int 0 if the string is correct, -1 otherwise
+ */
+int parse_hex(const char *hex, uint8_t *bytes, int len);
+
 /**
  * @brief Calculates the MCD of a and b and all the quotients of the division following the Euclides algorithm.
  *
@@ -245,6 +286,51 @@ char *addFilling(int n, char *texto);
  */
 mpz_t *euclides(mpz_t a, mpz_t b, int *z);
 
+/**
+ * @brief One division step of the Euclides algorithm: a = quotient*b + r, then a = b and b = r.
+ *
+ * @param quotient (return) quotient of a/b
+ * @param a dividend, replaced by b
+ * @param b divisor, replaced by the remainder. Must not be 0
+ */
+void euclides_step(mpz_t quotient, mpz_t a, mpz_t b);
+
+/**
+ * @brief State of the continued fraction expansion of num/den. The quotients are obtained one by one
+ *        with euclides_step, so the convergents h/k can be enumerated without storing the whole list.
+ */
+typedef struct {
+    mpz_t a, b;         /* Pair of the Euclides algorithm */
+    mpz_t quotient;     /* Last quotient */
+    mpz_t h, h_prev;    /* Numerators of the last two convergents */
+    mpz_t k, k_prev;    /* Denominators of the last two convergents */
+} continued_fraction;
+
+/**
+ * @brief Initializes the continued fraction expansion of num/den
+ *
+ * @param cf state to initialize
+ * @param num numerator
+ * @param den denominator
+ */
+void continued_fraction_init(continued_fraction *cf, const mpz_t num, const mpz_t den);
+
+/**
+ * @brief Computes the next convergent of the expansion, that is left in cf->h / cf->k
+ *
+ * @param cf state of the expansion
+ *
+ * @return int 1 if a new convergent was computed, 0 if the expansion is finished
+ */
+int continued_fraction_next(continued_fraction *cf);
+
+/**
+ * @brief Frees the state of a continued fraction expansion
+ *
+ * @param cf state to free
+ */
+void continued_fraction_clear(continued_fraction *cf);
+
 /**
  * @brief Returns the MCD of a and b using the Euclides algorithm.
  * 
@@ -301,7 +387,8 @@ int *euclides2(int det, int m, int *z);
 int *extended_euclides2(int det, int m, int *tam);
 
 /**
- * @brief Simplified Euclides algorithm , it just returns the value of the greatest commin divisor, and not a whole list with the quotients
+ * @brief Simplified Euclides algorithm , it just returns the value of the greatest commin divisor, and not a whole list with the quotients.
+ *        It is the binary gcd of intmath.h (int_gcd)
  *
  * @param a first value
  * @param b secund value
@@ -311,7 +398,7 @@ int *extended_euclides2(int det, int m, int *tam);
 int simpleMCD(int a, int b);
 
 /**
- * @brief finds the gcd of multiple values
+ * @brief finds the gcd of multiple values (int_gcd_list)
  *
  * @param numbers array with all the numbers
  * @param size size of the array
@@ -331,7 +418,7 @@ int find_gcd_of_list(int *numbers, int size);
 int random_num(int inf, int sup);
 
 /**
- * @brief Generate a random permutation with size n, that has the values from 1 to n.
+ * @brief Generate a random permutation with size n, that has the values from 0 to n-1 (permutation_generate)
  *
  * @param n size of the permutation
  * @param permutation array where the permutation is going to be stored
@@ -340,7 +427,7 @@ int random_num(int inf, int sup);
 void generatePermutation(int n, int *permutation);
 
 /**
- * @brief Invert a permutation
+ * @brief Invert a permutation in place, without allocating memory (permutation_invert)
  *
  * @param permutation permutation to be inverted
  * @param n size of the permutation
@@ -361,6 +448,14 @@ void print_histogram(int *frequencies);
  */
 void generate_histogram_with_gnuplot(const char *script_filename);
 
+/**
+ * @brief Returns the time of the monotonic clock in seconds. Unlike clock(), the difference between
+ *        two calls is the elapsed (wall) time even if several threads are running
+ *
+ * @return double time in seconds
+ */
+double get_wall_time();
+
 /**
  * @brief Generate a random 64 bits number
  *
@@ -368,10 +463,73 @@ void generate_histogram_with_gnuplot(const char *script_filename);
  */
 uint64_t rand64();
 
+/**
+ * @brief Counts the bits that are equal in the lowest size bits of two numbers
+ *
+ * @param num1 first number
+ * @param num2 second number
+ * @param size number of bits compared (up to 32)
+ * @return int number of equal bits
+ */
 int bit_comparator_counter(uint32_t num1, uint32_t num2, int size);
 
+/**
+ * @brief Adds 1 to frequencies[j] for every bit j (of the lowest size bits) that is equal in both numbers
+ *
+ * @param num1 first number
+ * @param num2 second number
+ * @param frequencies (return) counter of each position, size entries
+ * @param size number of bits compared (up to 32)
+ */
 void bit_comparator_position(uint32_t num1, uint32_t num2, int *frequencies, int size);
 
+/**
+ * @brief bit_comparator_counter for numbers of up to 64 bits (xor and popcount)
+ *
+ * @param num1 first number
+ * @param num2 second number
+ * @param size number of bits compared (up to 64)
+ * @return int number of equal bits
+ */
+int bit_comparator_counter64(uint64_t num1, uint64_t num2, int size);
+
+/**
+ * @brief bit_comparator_position for numbers of up to 64 bits. Only the equal bits are visited
+ *
+ * @param num1 first number
+ * @param num2 second number
+ * @param frequencies (return) counter of each position, size entries
+ * @param size number of bits compared (up to 64)
+ */
+void bit_comparator_position64(uint64_t num1, uint64_t num2, int *frequencies, int size);
+
+/**
+ * @brief Counts the equal bits of n pairs of numbers of up to BIT_COMPARATOR_MAX_BITS bits. Every number
+ *        takes (size + 63) / 64 words, bit j is the bit j % 64 of the word j / 64
+ *
+ * @param num1 first numbers, n numbers one after the other
+ * @param num2 second numbers, n numbers one after the other
+ * @param n number of pairs
+ * @param size number of bits compared
+ * @param counts (return) number of equal bits of each pair, n entries
+ * @return int 0 if the numbers were compared, -1 if size is not valid
+ */
+int bit_comparator_counter_batch(const uint64_t *num1, const uint64_t *num2, size_t n, int size, int *counts);
+
+/**
+ * @brief Adds to frequencies[j] the number of pairs whose bit j is equal, for n pairs of numbers laid out
+ *        like in bit_comparator_counter_batch. The positions are added with bit sliced counters (one word
+ *        per bit of the counter) and only spread into frequencies every 255 pairs
+ *
+ * @param num1 first numbers, n numbers one after the other
+ * @param num2 second numbers, n numbers one after the other
+ * @param n number of pairs
+ * @param size number of bits compared
+ * @param frequencies (return) counter of each position, size entries
+ * @return int 0 if the numbers were compared, -1 if size is not valid
+ */
+int bit_comparator_position_batch(const uint64_t *num1, const uint64_t *num2, size_t n, int size, int *frequencies);
+
 /**
  * @brief Calculates the modular exponentiation of base^exp mod mod and stores the result in result
  *